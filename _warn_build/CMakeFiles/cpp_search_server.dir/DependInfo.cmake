@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/search-server/main.cpp" "CMakeFiles/cpp_search_server.dir/search-server/main.cpp.o" "gcc" "CMakeFiles/cpp_search_server.dir/search-server/main.cpp.o.d"
+  "/root/repo/search-server/test_example_functions.cpp" "CMakeFiles/cpp_search_server.dir/search-server/test_example_functions.cpp.o" "gcc" "CMakeFiles/cpp_search_server.dir/search-server/test_example_functions.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_warn_build/CMakeFiles/search_server.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
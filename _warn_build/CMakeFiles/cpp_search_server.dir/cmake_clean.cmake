@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpp_search_server.dir/search-server/main.cpp.o"
+  "CMakeFiles/cpp_search_server.dir/search-server/main.cpp.o.d"
+  "CMakeFiles/cpp_search_server.dir/search-server/test_example_functions.cpp.o"
+  "CMakeFiles/cpp_search_server.dir/search-server/test_example_functions.cpp.o.d"
+  "cpp_search_server"
+  "cpp_search_server.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cpp_search_server.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpp_search_server_bench.dir/search-server/benchmark.cpp.o"
+  "CMakeFiles/cpp_search_server_bench.dir/search-server/benchmark.cpp.o.d"
+  "cpp_search_server_bench"
+  "cpp_search_server_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cpp_search_server_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
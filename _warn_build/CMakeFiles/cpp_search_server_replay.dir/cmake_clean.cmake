@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpp_search_server_replay.dir/search-server/replay.cpp.o"
+  "CMakeFiles/cpp_search_server_replay.dir/search-server/replay.cpp.o.d"
+  "cpp_search_server_replay"
+  "cpp_search_server_replay.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cpp_search_server_replay.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,48 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/search-server/compressed_postings.cpp" "CMakeFiles/search_server.dir/search-server/compressed_postings.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/compressed_postings.cpp.o.d"
+  "/root/repo/search-server/concurrent_request_queue.cpp" "CMakeFiles/search_server.dir/search-server/concurrent_request_queue.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/concurrent_request_queue.cpp.o.d"
+  "/root/repo/search-server/corpus_generator.cpp" "CMakeFiles/search_server.dir/search-server/corpus_generator.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/corpus_generator.cpp.o.d"
+  "/root/repo/search-server/document.cpp" "CMakeFiles/search_server.dir/search-server/document.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/document.cpp.o.d"
+  "/root/repo/search-server/document_filter.cpp" "CMakeFiles/search_server.dir/search-server/document_filter.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/document_filter.cpp.o.d"
+  "/root/repo/search-server/duplicate_detector.cpp" "CMakeFiles/search_server.dir/search-server/duplicate_detector.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/duplicate_detector.cpp.o.d"
+  "/root/repo/search-server/fuzzy_search.cpp" "CMakeFiles/search_server.dir/search-server/fuzzy_search.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/fuzzy_search.cpp.o.d"
+  "/root/repo/search-server/histogram.cpp" "CMakeFiles/search_server.dir/search-server/histogram.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/histogram.cpp.o.d"
+  "/root/repo/search-server/metrics.cpp" "CMakeFiles/search_server.dir/search-server/metrics.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/metrics.cpp.o.d"
+  "/root/repo/search-server/positional_index.cpp" "CMakeFiles/search_server.dir/search-server/positional_index.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/positional_index.cpp.o.d"
+  "/root/repo/search-server/posting_list.cpp" "CMakeFiles/search_server.dir/search-server/posting_list.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/posting_list.cpp.o.d"
+  "/root/repo/search-server/process_queries.cpp" "CMakeFiles/search_server.dir/search-server/process_queries.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/process_queries.cpp.o.d"
+  "/root/repo/search-server/quantized_index.cpp" "CMakeFiles/search_server.dir/search-server/quantized_index.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/quantized_index.cpp.o.d"
+  "/root/repo/search-server/query_analytics.cpp" "CMakeFiles/search_server.dir/search-server/query_analytics.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/query_analytics.cpp.o.d"
+  "/root/repo/search-server/query_budget.cpp" "CMakeFiles/search_server.dir/search-server/query_budget.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/query_budget.cpp.o.d"
+  "/root/repo/search-server/query_log.cpp" "CMakeFiles/search_server.dir/search-server/query_log.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/query_log.cpp.o.d"
+  "/root/repo/search-server/query_stats.cpp" "CMakeFiles/search_server.dir/search-server/query_stats.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/query_stats.cpp.o.d"
+  "/root/repo/search-server/query_tree.cpp" "CMakeFiles/search_server.dir/search-server/query_tree.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/query_tree.cpp.o.d"
+  "/root/repo/search-server/read_input_functions.cpp" "CMakeFiles/search_server.dir/search-server/read_input_functions.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/read_input_functions.cpp.o.d"
+  "/root/repo/search-server/remove_duplicates.cpp" "CMakeFiles/search_server.dir/search-server/remove_duplicates.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/remove_duplicates.cpp.o.d"
+  "/root/repo/search-server/request_queue.cpp" "CMakeFiles/search_server.dir/search-server/request_queue.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/request_queue.cpp.o.d"
+  "/root/repo/search-server/roaring_bitmap.cpp" "CMakeFiles/search_server.dir/search-server/roaring_bitmap.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/roaring_bitmap.cpp.o.d"
+  "/root/repo/search-server/scratch_arena.cpp" "CMakeFiles/search_server.dir/search-server/scratch_arena.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/scratch_arena.cpp.o.d"
+  "/root/repo/search-server/search_cursor.cpp" "CMakeFiles/search_server.dir/search-server/search_cursor.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/search_cursor.cpp.o.d"
+  "/root/repo/search-server/search_server.cpp" "CMakeFiles/search_server.dir/search-server/search_server.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/search_server.cpp.o.d"
+  "/root/repo/search-server/simd_kernels.cpp" "CMakeFiles/search_server.dir/search-server/simd_kernels.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/simd_kernels.cpp.o.d"
+  "/root/repo/search-server/string_processing.cpp" "CMakeFiles/search_server.dir/search-server/string_processing.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/string_processing.cpp.o.d"
+  "/root/repo/search-server/term_set_fingerprint.cpp" "CMakeFiles/search_server.dir/search-server/term_set_fingerprint.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/term_set_fingerprint.cpp.o.d"
+  "/root/repo/search-server/top_documents.cpp" "CMakeFiles/search_server.dir/search-server/top_documents.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/top_documents.cpp.o.d"
+  "/root/repo/search-server/tracing.cpp" "CMakeFiles/search_server.dir/search-server/tracing.cpp.o" "gcc" "CMakeFiles/search_server.dir/search-server/tracing.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
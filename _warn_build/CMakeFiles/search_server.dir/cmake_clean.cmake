@@ -0,0 +1,69 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/search_server.dir/search-server/compressed_postings.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/compressed_postings.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/concurrent_request_queue.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/concurrent_request_queue.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/corpus_generator.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/corpus_generator.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/document.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/document.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/document_filter.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/document_filter.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/duplicate_detector.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/duplicate_detector.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/fuzzy_search.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/fuzzy_search.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/histogram.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/histogram.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/metrics.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/metrics.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/positional_index.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/positional_index.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/posting_list.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/posting_list.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/process_queries.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/process_queries.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/quantized_index.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/quantized_index.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/query_analytics.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/query_analytics.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/query_budget.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/query_budget.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/query_log.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/query_log.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/query_stats.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/query_stats.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/query_tree.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/query_tree.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/read_input_functions.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/read_input_functions.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/remove_duplicates.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/remove_duplicates.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/request_queue.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/request_queue.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/roaring_bitmap.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/roaring_bitmap.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/scratch_arena.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/scratch_arena.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/search_cursor.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/search_cursor.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/search_server.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/search_server.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/simd_kernels.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/simd_kernels.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/string_processing.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/string_processing.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/term_set_fingerprint.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/term_set_fingerprint.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/top_documents.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/top_documents.cpp.o.d"
+  "CMakeFiles/search_server.dir/search-server/tracing.cpp.o"
+  "CMakeFiles/search_server.dir/search-server/tracing.cpp.o.d"
+  "libsearch_server.a"
+  "libsearch_server.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/search_server.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,271 @@
+// Микробенчмарки поисковой системы на синтетическом корпусе. Результаты — JSON или CSV в stdout:
+//   cpp_search_server_bench [--sizes 1000,10000] [--queries 1000] [--repetitions 3] [--seed 42] [--format json|csv]
+// Осмысленные числа получаются только в сборке с оптимизацией (-DCMAKE_BUILD_TYPE=Release)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "corpus_generator.h"
+#include "process_queries.h"
+#include "remove_duplicates.h"
+#include "search_server.h"
+
+using namespace std;
+
+namespace {
+
+struct BenchmarkOptions {
+    vector<size_t> corpus_sizes = {1000, 10000, 50000};
+    size_t query_count = 1000;
+    size_t repetitions = 3;
+    uint64_t seed = 42;
+    bool is_csv = false;
+};
+
+struct BenchmarkResult {
+    string name;
+    size_t corpus_size = 0;
+    size_t operations = 0;
+    // Время одной операции в каждом повторе
+    vector<double> ns_per_operation;
+};
+
+struct Corpus {
+    vector<string> stop_words;
+    vector<string> documents;
+    vector<vector<int>> ratings;
+    vector<DocumentStatus> statuses;
+    vector<string> queries;
+};
+
+// Не даёт компилятору выбросить результаты замеряемых вызовов
+size_t checksum = 0;
+
+vector<size_t> ParseSizes(const string &text) {
+    vector<size_t> sizes;
+    istringstream input(text);
+    string size;
+    while (getline(input, size, ',')) {
+        sizes.push_back(stoul(size));
+    }
+    return sizes;
+}
+
+BenchmarkOptions ParseOptions(int argc, char *argv[]) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const string argument = argv[i];
+        if (i + 1 == argc) {
+            throw invalid_argument("Missing value for "s + argument);
+        }
+        const string value = argv[++i];
+        if (argument == "--sizes"s) {
+            options.corpus_sizes = ParseSizes(value);
+        } else if (argument == "--queries"s) {
+            options.query_count = stoul(value);
+        } else if (argument == "--repetitions"s) {
+            options.repetitions = max<size_t>(stoul(value), 1);
+        } else if (argument == "--seed"s) {
+            options.seed = stoull(value);
+        } else if (argument == "--format"s) {
+            options.is_csv = value == "csv"s;
+        } else {
+            throw invalid_argument("Unknown option "s + argument);
+        }
+    }
+    return options;
+}
+
+Corpus GenerateCorpus(size_t corpus_size, const BenchmarkOptions &options) {
+    CorpusOptions corpus_options;
+    corpus_options.seed = options.seed;
+    CorpusGenerator generator(corpus_options);
+    Corpus corpus;
+    corpus.stop_words = generator.GetMostFrequentWords(10);
+    for (size_t i = 0; i < corpus_size; ++i) {
+        corpus.documents.push_back(generator.GenerateDocument());
+        corpus.ratings.push_back(generator.GenerateRatings());
+        corpus.statuses.push_back(generator.GenerateStatus());
+    }
+    for (size_t i = 0; i < options.query_count; ++i) {
+        corpus.queries.push_back(generator.GenerateQuery());
+    }
+    return corpus;
+}
+
+SearchServer BuildServer(const Corpus &corpus) {
+    SearchServer search_server(corpus.stop_words);
+    for (size_t id = 0; id < corpus.documents.size(); ++id) {
+        search_server.AddDocument(static_cast<int>(id), corpus.documents[id], corpus.statuses[id], corpus.ratings[id]);
+    }
+    return search_server;
+}
+
+// prepare выполняется перед каждым повтором вне замера, run возвращает число выполненных операций
+BenchmarkResult Measure(const string &name, size_t corpus_size, size_t repetitions, const function<void()> &prepare,
+                        const function<size_t()> &run) {
+    BenchmarkResult result{name, corpus_size, 0, {}};
+    for (size_t repetition = 0; repetition < repetitions; ++repetition) {
+        prepare();
+        const auto start_time = chrono::steady_clock::now();
+        result.operations = run();
+        const auto duration = chrono::steady_clock::now() - start_time;
+        result.ns_per_operation.push_back(static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(
+                duration).count()) / static_cast<double>(max<size_t>(result.operations, 1)));
+    }
+    return result;
+}
+
+template<typename ExecutionPolicy>
+void AddFindBenchmarks(const string &policy_name, ExecutionPolicy policy, const SearchServer &search_server,
+                       const Corpus &corpus, const BenchmarkOptions &options, vector<BenchmarkResult> &results) {
+    const size_t corpus_size = corpus.documents.size();
+    const auto no_prepare = [] {};
+    results.push_back(Measure("find_top_documents/"s + policy_name + "/default"s, corpus_size, options.repetitions,
+                              no_prepare, [&] {
+                for (const string &query: corpus.queries) {
+                    checksum += search_server.FindTopDocuments(policy, query).size();
+                }
+                return corpus.queries.size();
+            }));
+    results.push_back(Measure("find_top_documents/"s + policy_name + "/status"s, corpus_size, options.repetitions,
+                              no_prepare, [&] {
+                for (const string &query: corpus.queries) {
+                    checksum += search_server.FindTopDocuments(policy, query, DocumentStatus::BANNED).size();
+                }
+                return corpus.queries.size();
+            }));
+    results.push_back(Measure("find_top_documents/"s + policy_name + "/predicate"s, corpus_size, options.repetitions,
+                              no_prepare, [&] {
+                for (const string &query: corpus.queries) {
+                    checksum += search_server.FindTopDocuments(policy, query, [](int document_id, DocumentStatus,
+                                                                                 int rating) {
+                        return document_id % 2 == 0 && rating > 0;
+                    }).size();
+                }
+                return corpus.queries.size();
+            }));
+    results.push_back(Measure("match_document/"s + policy_name, corpus_size, options.repetitions, no_prepare, [&] {
+        for (size_t i = 0; i < corpus.queries.size(); ++i) {
+            const int document_id = static_cast<int>(i * 7919 % corpus_size);
+            checksum += get<0>(search_server.MatchDocument(policy, corpus.queries[i], document_id)).size();
+        }
+        return corpus.queries.size();
+    }));
+}
+
+template<typename ExecutionPolicy>
+void AddRemoveBenchmark(const string &policy_name, ExecutionPolicy policy, const SearchServer &search_server,
+                        const Corpus &corpus, const BenchmarkOptions &options, vector<BenchmarkResult> &results) {
+    const size_t corpus_size = corpus.documents.size();
+    const size_t remove_count = max<size_t>(corpus_size / 10, 1);
+    SearchServer copy = search_server;
+    results.push_back(Measure("remove_document/"s + policy_name, corpus_size, options.repetitions,
+                              [&] { copy = search_server; }, [&] {
+                for (size_t i = 0; i < remove_count; ++i) {
+                    copy.RemoveDocument(policy, static_cast<int>(i * corpus_size / remove_count));
+                }
+                return remove_count;
+            }));
+}
+
+vector<BenchmarkResult> RunBenchmarks(size_t corpus_size, const BenchmarkOptions &options) {
+    vector<BenchmarkResult> results;
+    const Corpus corpus = GenerateCorpus(corpus_size, options);
+    const auto no_prepare = [] {};
+
+    results.push_back(Measure("add_document"s, corpus_size, options.repetitions, no_prepare, [&] {
+        checksum += static_cast<size_t>(BuildServer(corpus).GetDocumentCount());
+        return corpus_size;
+    }));
+    const SearchServer search_server = BuildServer(corpus);
+    AddRemoveBenchmark("seq"s, execution::seq, search_server, corpus, options, results);
+    AddRemoveBenchmark("par"s, execution::par, search_server, corpus, options, results);
+    AddFindBenchmarks("seq"s, execution::seq, search_server, corpus, options, results);
+    AddFindBenchmarks("par"s, execution::par, search_server, corpus, options, results);
+    results.push_back(Measure("process_queries"s, corpus_size, options.repetitions, no_prepare, [&] {
+        checksum += ProcessQueries(search_server, corpus.queries).size();
+        return corpus.queries.size();
+    }));
+
+    SearchServer copy = search_server;
+    results.push_back(Measure("remove_duplicates"s, corpus_size, options.repetitions,
+                              [&] { copy = search_server; }, [&] {
+                // RemoveDuplicates сообщает о каждом дубликате в cout, а там результаты бенчмарков
+                ostringstream discarded;
+                streambuf *const output = cout.rdbuf(discarded.rdbuf());
+                RemoveDuplicates(copy);
+                cout.rdbuf(output);
+                return corpus_size;
+            }));
+    return results;
+}
+
+double GetMedian(vector<double> values) {
+    sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+void PrintCsv(const vector<BenchmarkResult> &results) {
+    cout << "benchmark,corpus_size,operations,repetitions,min_ns_per_op,median_ns_per_op,ops_per_second\n"s;
+    for (const BenchmarkResult &result: results) {
+        const double median = GetMedian(result.ns_per_operation);
+        cout << result.name << ',' << result.corpus_size << ',' << result.operations << ','
+             << result.ns_per_operation.size() << ','
+             << *min_element(result.ns_per_operation.begin(), result.ns_per_operation.end()) << ',' << median << ','
+             << 1e9 / median << '\n';
+    }
+}
+
+void PrintJson(const vector<BenchmarkResult> &results, const BenchmarkOptions &options) {
+#ifdef __OPTIMIZE__
+    const bool is_optimized = true;
+#else
+    const bool is_optimized = false;
+#endif
+    cout << "{\"seed\":"s << options.seed << ",\"optimized\":"s << (is_optimized ? "true"s : "false"s)
+         << ",\"checksum\":"s << checksum << ",\"results\":["s;
+    bool is_first = true;
+    for (const BenchmarkResult &result: results) {
+        const double median = GetMedian(result.ns_per_operation);
+        cout << (is_first ? ""s : ","s) << "\n{\"benchmark\":\""s << result.name
+             << "\",\"corpus_size\":"s << result.corpus_size
+             << ",\"operations\":"s << result.operations
+             << ",\"repetitions\":"s << result.ns_per_operation.size()
+             << ",\"min_ns_per_op\":"s << *min_element(result.ns_per_operation.begin(), result.ns_per_operation.end())
+             << ",\"median_ns_per_op\":"s << median
+             << ",\"ops_per_second\":"s << 1e9 / median << '}';
+        is_first = false;
+    }
+    cout << "\n]}\n"s;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    try {
+        const BenchmarkOptions options = ParseOptions(argc, argv);
+        vector<BenchmarkResult> results;
+        for (const size_t corpus_size: options.corpus_sizes) {
+            auto size_results = RunBenchmarks(corpus_size, options);
+            move(size_results.begin(), size_results.end(), back_inserter(results));
+        }
+        if (options.is_csv) {
+            PrintCsv(results);
+        } else {
+            PrintJson(results, options);
+        }
+    } catch (const exception &error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,368 @@
+#include "compressed_postings.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace bit_packing {
+
+int GetRequiredBits(const uint32_t *values, size_t count) {
+    uint32_t combined = 0;
+    for (size_t i = 0; i < count; ++i) {
+        combined |= values[i];
+    }
+    int bits = 0;
+    while (combined != 0) {
+        ++bits;
+        combined >>= 1;
+    }
+    return bits;
+}
+
+void PackBlock(const uint32_t *values, int bits, std::vector<uint32_t> &out) {
+    const size_t start = out.size();
+    out.resize(start + 4 * static_cast<size_t>(bits), 0);
+    if (bits == 0) {
+        return;
+    }
+    uint32_t *words = out.data() + start;
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        const size_t lane = i % 4;
+        const size_t bit = (i / 4) * bits;
+        const size_t word = bit / 32;
+        const size_t shift = bit % 32;
+        words[word * 4 + lane] |= values[i] << shift;
+        if (shift + bits > 32) {
+            words[(word + 1) * 4 + lane] |= values[i] >> (32 - shift);
+        }
+    }
+}
+
+void UnpackBlock(const uint32_t *in, int bits, uint32_t *values) {
+    if (bits == 0) {
+        std::fill(values, values + BLOCK_SIZE, 0);
+        return;
+    }
+    const uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+#ifdef __SSE2__
+    const __m128i mask_vector = _mm_set1_epi32(static_cast<int>(mask));
+    for (size_t k = 0; k < BLOCK_SIZE / 4; ++k) {
+        const size_t bit = k * bits;
+        const size_t word = bit / 32;
+        const int shift = static_cast<int>(bit % 32);
+        __m128i lanes = _mm_srl_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + word * 4)),
+                                      _mm_cvtsi32_si128(shift));
+        if (shift + bits > 32) {
+            const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + (word + 1) * 4));
+            lanes = _mm_or_si128(lanes, _mm_sll_epi32(next, _mm_cvtsi32_si128(32 - shift)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(values + k * 4), _mm_and_si128(lanes, mask_vector));
+    }
+#else
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        const size_t lane = i % 4;
+        const size_t bit = (i / 4) * bits;
+        const size_t word = bit / 32;
+        const size_t shift = bit % 32;
+        uint32_t value = in[word * 4 + lane] >> shift;
+        if (shift + bits > 32) {
+            value |= in[(word + 1) * 4 + lane] << (32 - shift);
+        }
+        values[i] = value & mask;
+    }
+#endif
+}
+
+uint32_t ExtractValue(const uint32_t *in, int bits, size_t index) {
+    if (bits == 0) {
+        return 0;
+    }
+    const uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+    const size_t lane = index % 4;
+    const size_t bit = (index / 4) * bits;
+    const size_t word = bit / 32;
+    const size_t shift = bit % 32;
+    uint32_t value = in[word * 4 + lane] >> shift;
+    if (shift + bits > 32) {
+        value |= in[(word + 1) * 4 + lane] << (32 - shift);
+    }
+    return value & mask;
+}
+
+}  // namespace bit_packing
+
+CompressedPostingList::CompressedPostingList(const std::map<int, double> &document_freqs) {
+    std::unordered_map<double, uint32_t> term_freq_to_index;
+    for (const auto &[document_id, term_freq]: document_freqs) {
+        const auto [index_it, is_new] = term_freq_to_index.emplace(term_freq,
+                                                                   static_cast<uint32_t>(term_freqs_.size()));
+        if (is_new) {
+            term_freqs_.push_back(term_freq);
+        }
+        AppendIndex(document_id, index_it->second);
+    }
+}
+
+uint32_t CompressedPostingList::GetTermFreqIndex(double term_freq) {
+    // Различных TF у слова немного: это доли 1 / длина документа
+    const auto term_freq_it = std::find(term_freqs_.begin(), term_freqs_.end(), term_freq);
+    if (term_freq_it == term_freqs_.end()) {
+        term_freqs_.push_back(term_freq);
+        return static_cast<uint32_t>(term_freqs_.size() - 1);
+    }
+    return static_cast<uint32_t>(term_freq_it - term_freqs_.begin());
+}
+
+void CompressedPostingList::Append(int document_id, double term_freq) {
+    AppendIndex(document_id, GetTermFreqIndex(term_freq));
+}
+
+void CompressedPostingList::Add(int document_id, double term_freq) {
+    if (document_id > GetLastDocument()) {
+        Append(document_id, term_freq);
+        return;
+    }
+    const uint32_t term_freq_index = GetTermFreqIndex(term_freq);
+    if (!blocks_.empty() && document_id <= blocks_.back().last_document) {
+        inserted_documents_.emplace(document_id, term_freq_index);
+        CompactIfNeeded();
+        return;
+    }
+    const auto position = std::lower_bound(tail_documents_.begin(), tail_documents_.end(), document_id)
+                          - tail_documents_.begin();
+    tail_documents_.insert(tail_documents_.begin() + position, document_id);
+    tail_term_freq_indices_.insert(tail_term_freq_indices_.begin() + position, term_freq_index);
+    if (tail_documents_.size() == bit_packing::BLOCK_SIZE) {
+        FlushTail();
+    }
+}
+
+void CompressedPostingList::Remove(int document_id) {
+    if (inserted_documents_.erase(document_id) > 0) {
+        return;
+    }
+    if (blocks_.empty() || document_id > blocks_.back().last_document) {
+        const auto position = std::lower_bound(tail_documents_.begin(), tail_documents_.end(), document_id)
+                              - tail_documents_.begin();
+        tail_documents_.erase(tail_documents_.begin() + position);
+        tail_term_freq_indices_.erase(tail_term_freq_indices_.begin() + position);
+        return;
+    }
+    removed_documents_.insert(std::lower_bound(removed_documents_.begin(), removed_documents_.end(), document_id),
+                              document_id);
+    CompactIfNeeded();
+}
+
+void CompressedPostingList::CompactIfNeeded() {
+    // Перепаковка стоит O(длины списка), а до неё накапливается не меньше восьмой части длины изменений
+    const size_t pending_changes = removed_documents_.size() + inserted_documents_.size();
+    if (pending_changes < std::max(bit_packing::BLOCK_SIZE, GetSize() / 8)) {
+        return;
+    }
+    CompressedPostingList compacted;
+    for (auto posting = GetIterator(); posting.GetDocument() != END; posting.Next()) {
+        compacted.Append(posting.GetDocument(), posting.GetTermFreq());
+    }
+    *this = std::move(compacted);
+}
+
+std::optional<double> CompressedPostingList::FindTermFreq(int document_id) const {
+    if (const auto inserted_it = inserted_documents_.find(document_id); inserted_it != inserted_documents_.end()) {
+        return term_freqs_[inserted_it->second];
+    }
+    if (blocks_.empty() || document_id > blocks_.back().last_document) {
+        const auto document_it = std::lower_bound(tail_documents_.begin(), tail_documents_.end(), document_id);
+        if (document_it == tail_documents_.end() || *document_it != document_id) {
+            return std::nullopt;
+        }
+        return term_freqs_[tail_term_freq_indices_[document_it - tail_documents_.begin()]];
+    }
+    if (std::binary_search(removed_documents_.begin(), removed_documents_.end(), document_id)) {
+        return std::nullopt;
+    }
+    const size_t block = std::partition_point(blocks_.begin(), blocks_.end(), [document_id](const BlockInfo &info) {
+        return info.last_document < document_id;
+    }) - blocks_.begin();
+    const BlockInfo &info = blocks_[block];
+    const uint32_t *data = packed_.data() + info.offset;
+    std::array<uint32_t, bit_packing::BLOCK_SIZE> documents;
+    bit_packing::UnpackBlock(data, info.document_bits, documents.data());
+    uint32_t document = block == 0 ? 0 : static_cast<uint32_t>(blocks_[block - 1].last_document);
+    for (uint32_t &delta: documents) {
+        document += delta;
+        delta = document;
+    }
+    const auto document_it = std::lower_bound(documents.begin(), documents.end(), static_cast<uint32_t>(document_id));
+    if (*document_it != static_cast<uint32_t>(document_id)) {
+        return std::nullopt;
+    }
+    return term_freqs_[bit_packing::ExtractValue(data + 4 * info.document_bits, info.term_freq_bits,
+                                                 document_it - documents.begin())];
+}
+
+void CompressedPostingList::AppendIndex(int document_id, uint32_t term_freq_index) {
+    tail_documents_.push_back(document_id);
+    tail_term_freq_indices_.push_back(term_freq_index);
+    if (tail_documents_.size() == bit_packing::BLOCK_SIZE) {
+        FlushTail();
+    }
+}
+
+void CompressedPostingList::FlushTail() {
+    std::array<uint32_t, bit_packing::BLOCK_SIZE> deltas{};
+    int previous_document = blocks_.empty() ? 0 : blocks_.back().last_document;
+    for (size_t i = 0; i < tail_documents_.size(); ++i) {
+        deltas[i] = static_cast<uint32_t>(tail_documents_[i] - previous_document);
+        previous_document = tail_documents_[i];
+    }
+    BlockInfo block{};
+    block.last_document = tail_documents_.back();
+    block.offset = static_cast<uint32_t>(packed_.size());
+    block.document_bits = static_cast<uint8_t>(bit_packing::GetRequiredBits(deltas.data(), deltas.size()));
+    block.term_freq_bits = static_cast<uint8_t>(bit_packing::GetRequiredBits(tail_term_freq_indices_.data(),
+                                                                             tail_term_freq_indices_.size()));
+    bit_packing::PackBlock(deltas.data(), block.document_bits, packed_);
+    bit_packing::PackBlock(tail_term_freq_indices_.data(), block.term_freq_bits, packed_);
+    blocks_.push_back(block);
+    tail_documents_.clear();
+    tail_term_freq_indices_.clear();
+}
+
+int CompressedPostingList::GetLastDocument() const {
+    if (!tail_documents_.empty()) {
+        return tail_documents_.back();
+    }
+    return blocks_.empty() ? -1 : blocks_.back().last_document;
+}
+
+size_t CompressedPostingList::GetSize() const {
+    return blocks_.size() * bit_packing::BLOCK_SIZE + tail_documents_.size() + inserted_documents_.size()
+           - removed_documents_.size();
+}
+
+size_t CompressedPostingList::GetMemoryUsage() const {
+    // Узел дерева: три указателя и цвет помимо значения
+    constexpr size_t inserted_node_size = 4 * sizeof(void *) + sizeof(std::pair<const int, uint32_t>);
+    return sizeof(*this) + blocks_.capacity() * sizeof(BlockInfo) + packed_.capacity() * sizeof(uint32_t)
+           + term_freqs_.capacity() * sizeof(double) + tail_documents_.capacity() * sizeof(int)
+           + tail_term_freq_indices_.capacity() * sizeof(uint32_t) + removed_documents_.capacity() * sizeof(int)
+           + inserted_documents_.size() * inserted_node_size;
+}
+
+CompressedPostingList::Iterator CompressedPostingList::GetIterator() const {
+    return Iterator(*this);
+}
+
+CompressedPostingList::Iterator::Iterator(const CompressedPostingList &list)
+        : list_(&list), removed_it_(list.removed_documents_.begin()), inserted_it_(list.inserted_documents_.begin()) {
+    LoadBlock(0);
+    SkipRemoved();
+}
+
+void CompressedPostingList::Iterator::LoadBlock(size_t block) {
+    block_ = block;
+    position_ = 0;
+    if (block_ == list_->blocks_.size()) {
+        block_size_ = list_->tail_documents_.size();
+        std::copy(list_->tail_documents_.begin(), list_->tail_documents_.end(), documents_.begin());
+        std::copy(list_->tail_term_freq_indices_.begin(), list_->tail_term_freq_indices_.end(),
+                  term_freq_indices_.begin());
+        return;
+    }
+    if (block_ > list_->blocks_.size()) {
+        block_size_ = 0;
+        return;
+    }
+    const BlockInfo &info = list_->blocks_[block_];
+    const uint32_t *data = list_->packed_.data() + info.offset;
+    bit_packing::UnpackBlock(data, info.document_bits, documents_.data());
+    bit_packing::UnpackBlock(data + 4 * info.document_bits, info.term_freq_bits, term_freq_indices_.data());
+    uint32_t document = block_ == 0 ? 0 : static_cast<uint32_t>(list_->blocks_[block_ - 1].last_document);
+    for (uint32_t &delta: documents_) {
+        document += delta;
+        delta = document;
+    }
+    block_size_ = bit_packing::BLOCK_SIZE;
+}
+
+int CompressedPostingList::Iterator::GetPackedDocument() const {
+    return position_ < block_size_ ? static_cast<int>(documents_[position_]) : END;
+}
+
+bool CompressedPostingList::Iterator::IsAtInserted() const {
+    // Вставленный документ не совпадает с действующим документом блоков: прежний отмечен удалённым
+    return inserted_it_ != list_->inserted_documents_.end() && inserted_it_->first < GetPackedDocument();
+}
+
+int CompressedPostingList::Iterator::GetDocument() const {
+    return IsAtInserted() ? inserted_it_->first : GetPackedDocument();
+}
+
+double CompressedPostingList::Iterator::GetTermFreq() const {
+    if (IsAtInserted()) {
+        return list_->term_freqs_[inserted_it_->second];
+    }
+    return list_->term_freqs_[term_freq_indices_[position_]];
+}
+
+void CompressedPostingList::Iterator::Next() {
+    if (IsAtInserted()) {
+        ++inserted_it_;
+        return;
+    }
+    NextPacked();
+    SkipRemoved();
+}
+
+void CompressedPostingList::Iterator::Advance(int target) {
+    AdvancePacked(target);
+    SkipRemoved();
+    const auto &inserted = list_->inserted_documents_;
+    if (inserted_it_ != inserted.end() && inserted_it_->first < target) {
+        inserted_it_ = inserted.lower_bound(target);
+    }
+}
+
+void CompressedPostingList::Iterator::SkipRemoved() {
+    const auto &removed = list_->removed_documents_;
+    for (int document = GetPackedDocument(); document != END && removed_it_ != removed.end();
+         document = GetPackedDocument()) {
+        if (*removed_it_ < document) {
+            removed_it_ = std::lower_bound(removed_it_, removed.end(), document);
+        }
+        if (removed_it_ == removed.end() || *removed_it_ != document) {
+            return;
+        }
+        NextPacked();
+    }
+}
+
+void CompressedPostingList::Iterator::NextPacked() {
+    if (++position_ == block_size_ && block_ < list_->blocks_.size()) {
+        LoadBlock(block_ + 1);
+    }
+}
+
+void CompressedPostingList::Iterator::AdvancePacked(int target) {
+    if (GetPackedDocument() >= target) {
+        return;
+    }
+    const auto &blocks = list_->blocks_;
+    if (block_ < blocks.size() && blocks[block_].last_document < target) {
+        // Первый блок, где может оказаться target; если такого нет — хвост
+        const auto block_it = std::partition_point(blocks.begin() + block_ + 1, blocks.end(),
+                                                   [target](const BlockInfo &info) {
+                                                       return info.last_document < target;
+                                                   });
+        LoadBlock(block_it - blocks.begin());
+    }
+    const auto begin = documents_.begin() + position_;
+    const auto end = documents_.begin() + block_size_;
+    position_ = std::lower_bound(begin, end, static_cast<uint32_t>(target)) - documents_.begin();
+    if (position_ == block_size_ && block_ < blocks.size()) {
+        LoadBlock(block_ + 1);
+    }
+}
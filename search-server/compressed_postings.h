@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <vector>
+
+// Упаковка блока из 128 чисел по bits бит в раскладке SIMD-BP128: число i попадает в дорожку i % 4,
+// так что распаковка обрабатывает по четыре числа одной командой SSE
+namespace bit_packing {
+
+constexpr size_t BLOCK_SIZE = 128;
+
+int GetRequiredBits(const uint32_t *values, size_t count);
+
+// Дописывает в out 4 * bits слов
+void PackBlock(const uint32_t *values, int bits, std::vector<uint32_t> &out);
+
+void UnpackBlock(const uint32_t *in, int bits, uint32_t *values);
+
+// Число номер index блока без распаковки остальных
+uint32_t ExtractValue(const uint32_t *in, int bits, size_t index);
+
+}  // namespace bit_packing
+
+// Сжатый список документов слова. Номера документов хранятся разностями, упакованными блоками
+// по 128 с общей для блока шириной, TF — номером в словаре различных значений TF слова, тоже
+// упакованным. Для каждого блока хранится последний документ, по нему Advance пропускает блоки
+// без распаковки. Последние документы, ещё не набравшие блок, хранятся как есть.
+// Удаления из упакованных блоков и вставки между ними копятся рядом с блоками и вливаются в них
+// перепаковкой всего списка, когда их наберётся заметная доля, так что изменение стоит O(1) в среднем
+class CompressedPostingList {
+public:
+    static constexpr int END = std::numeric_limits<int>::max();
+
+    CompressedPostingList() = default;
+
+    explicit CompressedPostingList(const std::map<int, double> &document_freqs);
+
+    // Документ должен быть больше всех имеющихся
+    void Append(int document_id, double term_freq);
+
+    // Документа ещё не должно быть в списке
+    void Add(int document_id, double term_freq);
+
+    // Документ должен быть в списке. Из упакованного блока он не вырезается, а отмечается удалённым
+    void Remove(int document_id);
+
+    // Распаковывает лишь номера документов одного блока, найденного по последним документам блоков.
+    // Для документов по возрастанию дешевле Iterator::Advance
+    std::optional<double> FindTermFreq(int document_id) const;
+
+    // Наибольший документ, хранящийся в блоках или хвосте, включая отмеченные удалёнными.
+    // Для пустого списка возвращает -1
+    int GetLastDocument() const;
+
+    size_t GetSize() const;
+
+    size_t GetMemoryUsage() const;
+
+    class Iterator {
+    public:
+        explicit Iterator(const CompressedPostingList &list);
+
+        // После последнего документа возвращает END
+        int GetDocument() const;
+
+        double GetTermFreq() const;
+
+        void Next();
+
+        // Переходит к первому документу не меньше target
+        void Advance(int target);
+
+    private:
+        // Номер blocks_.size() означает неупакованный хвост
+        void LoadBlock(size_t block);
+
+        // Документ блоков и хвоста без учёта вставленных
+        int GetPackedDocument() const;
+
+        void NextPacked();
+
+        void AdvancePacked(int target);
+
+        // Пропускает отмеченные удалёнными
+        void SkipRemoved();
+
+        bool IsAtInserted() const;
+
+        const CompressedPostingList *list_;
+        size_t block_ = 0;
+        size_t position_ = 0;
+        size_t block_size_ = 0;
+        std::array<uint32_t, bit_packing::BLOCK_SIZE> documents_{};
+        std::array<uint32_t, bit_packing::BLOCK_SIZE> term_freq_indices_{};
+        std::vector<int>::const_iterator removed_it_;
+        std::map<int, uint32_t>::const_iterator inserted_it_;
+    };
+
+    Iterator GetIterator() const;
+
+private:
+    struct BlockInfo {
+        int last_document;
+        uint32_t offset;
+        uint8_t document_bits;
+        uint8_t term_freq_bits;
+    };
+
+    uint32_t GetTermFreqIndex(double term_freq);
+
+    void AppendIndex(int document_id, uint32_t term_freq_index);
+
+    void FlushTail();
+
+    void CompactIfNeeded();
+
+    std::vector<BlockInfo> blocks_;
+    std::vector<uint32_t> packed_;
+    std::vector<double> term_freqs_;
+    std::vector<int> tail_documents_;
+    std::vector<uint32_t> tail_term_freq_indices_;
+    // Отмеченные удалёнными документы блоков, по возрастанию
+    std::vector<int> removed_documents_;
+    // Вставленные в диапазон блоков документы с номерами их TF
+    std::map<int, uint32_t> inserted_documents_;
+};
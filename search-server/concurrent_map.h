@@ -2,13 +2,15 @@
 #include <string>
 #include <mutex>
 
+#include "tracing.h"
+
 template<typename Key, typename Value>
 class ConcurrentMap {
 public:
     static_assert(std::is_integral_v<Key>, "ConcurrentMap supports only integer keys");
 
     struct Access {
-        std::lock_guard<std::mutex> guard;
+        std::unique_lock<std::mutex> guard;
         Value &ref_to_value;
     };
 
@@ -16,7 +18,13 @@ public:
 
     Access operator[](const Key &key) {
         auto &selected_map = concurrent_maps_.at(static_cast<uint64_t>(key) % bucket_count_);
-        return {std::lock_guard<std::mutex>(selected_map.mutex), selected_map.map[key]};
+        std::unique_lock<std::mutex> guard(selected_map.mutex, std::try_to_lock);
+        // В трассу попадает только ожидание занятого бакета
+        if (!guard.owns_lock()) {
+            TRACE_SCOPE("ConcurrentMap lock wait");
+            guard.lock();
+        }
+        return {std::move(guard), selected_map.map[key]};
     }
 
     std::map<Key, Value> BuildOrdinaryMap() {
@@ -0,0 +1,78 @@
+#include "concurrent_request_queue.h"
+
+#include <algorithm>
+
+ConcurrentRequestQueue::ConcurrentRequestQueue(const SearchServer &search_server, size_t capacity)
+        : search_server_(search_server),
+          start_(Clock::now()),
+          slots_(std::max<size_t>(capacity, 1)) {
+}
+
+std::vector<Document> ConcurrentRequestQueue::AddFindRequest(std::string_view raw_query, DocumentStatus status) {
+    return AddFindRequest(raw_query, DocumentStatusPredicate{status});
+}
+
+std::vector<Document> ConcurrentRequestQueue::AddFindRequest(std::string_view raw_query) {
+    return AddFindRequest(raw_query, DocumentStatus::ACTUAL);
+}
+
+void ConcurrentRequestQueue::EnableAnalytics(QueryAnalytics &analytics) {
+    analytics_ = &analytics;
+}
+
+void ConcurrentRequestQueue::RecordRequest(size_t result_count, Clock::time_point time) {
+    const uint64_t slot = next_slot_.fetch_add(1, std::memory_order_relaxed) % slots_.size();
+    const uint64_t request = Pack(ToTicks(time), result_count);
+    // Вытесненный запрос и новый учитываются обменом, поэтому счётчик точен и при гонке потоков за слот
+    const uint64_t evicted_request = slots_[slot].exchange(request, std::memory_order_relaxed);
+    const bool was_empty = evicted_request != 0 && ((evicted_request >> 1) & MAX_RESULT_COUNT) == 0;
+    const int delta = (result_count == 0 ? 1 : 0) - (was_empty ? 1 : 0);
+    if (delta != 0) {
+        no_result_requests_.fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+int ConcurrentRequestQueue::GetNoResultRequests() const {
+    return no_result_requests_.load(std::memory_order_relaxed);
+}
+
+RequestStatistics ConcurrentRequestQueue::GetStatistics(Clock::duration window, Clock::time_point now) const {
+    const uint64_t now_ticks = ToTicks(now);
+    const uint64_t window_ticks = std::chrono::duration_cast<std::chrono::milliseconds>(window).count();
+    RequestStatistics statistics;
+    for (const auto &slot: slots_) {
+        const uint64_t request = slot.load(std::memory_order_relaxed);
+        if (request == 0) {
+            continue;
+        }
+        const uint64_t time = request >> (RESULT_COUNT_BITS + 1);
+        if (time > now_ticks || now_ticks - time > window_ticks) {
+            continue;
+        }
+        ++statistics.requests;
+        if (((request >> 1) & MAX_RESULT_COUNT) == 0) {
+            ++statistics.no_result_requests;
+        }
+    }
+    return statistics;
+}
+
+uint64_t ConcurrentRequestQueue::GetTotalRequests() const {
+    return next_slot_.load(std::memory_order_relaxed);
+}
+
+size_t ConcurrentRequestQueue::GetCapacity() const {
+    return slots_.size();
+}
+
+uint64_t ConcurrentRequestQueue::Pack(uint64_t time, size_t result_count) {
+    const uint64_t saturated_count = std::min<uint64_t>(result_count, MAX_RESULT_COUNT);
+    return (time << (RESULT_COUNT_BITS + 1)) | (saturated_count << 1) | 1u;
+}
+
+uint64_t ConcurrentRequestQueue::ToTicks(Clock::time_point time) const {
+    if (time <= start_) {
+        return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time - start_).count();
+}
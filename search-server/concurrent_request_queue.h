@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "query_analytics.h"
+#include "search_server.h"
+
+struct RequestStatistics {
+    uint64_t requests = 0;
+    uint64_t no_result_requests = 0;
+};
+
+// Статистика последних запросов, которую можно пополнять из нескольких потоков без блокировок. В отличие
+// от RequestQueue, не хранит ни текст запроса, ни выдачу: запрос занимает одно 64-битное слово кольцевого
+// буфера, выделенного при создании, со временем запроса и числом найденных документов
+class ConcurrentRequestQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DEFAULT_CAPACITY = 1440;
+
+    // Буфер хранит ровно capacity последних запросов
+    explicit ConcurrentRequestQueue(const SearchServer &search_server, size_t capacity = DEFAULT_CAPACITY);
+
+    template<typename DocumentPredicate>
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate);
+
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentStatus status);
+
+    std::vector<Document> AddFindRequest(std::string_view raw_query);
+
+    // Запросы через AddFindRequest будут замеряться и записываться в analytics
+    void EnableAnalytics(QueryAnalytics &analytics);
+
+    // Учитывает запрос, выполненный в обход очереди
+    void RecordRequest(size_t result_count, Clock::time_point time = Clock::now());
+
+    // Число запросов без результатов среди последних capacity запросов
+    int GetNoResultRequests() const;
+
+    // Запросы за последние window от now, если они ещё не вытеснены из буфера. Обходит весь буфер
+    RequestStatistics GetStatistics(Clock::duration window, Clock::time_point now = Clock::now()) const;
+
+    uint64_t GetTotalRequests() const;
+
+    size_t GetCapacity() const;
+
+private:
+    // Запрос упакован в слово: время в миллисекундах от создания очереди, число результатов и признак записи
+    static constexpr int RESULT_COUNT_BITS = 20;
+    static constexpr uint64_t MAX_RESULT_COUNT = (uint64_t{1} << RESULT_COUNT_BITS) - 1;
+
+    static uint64_t Pack(uint64_t time, size_t result_count);
+
+    uint64_t ToTicks(Clock::time_point time) const;
+
+    const SearchServer &search_server_;
+    QueryAnalytics *analytics_ = nullptr;
+    const Clock::time_point start_;
+    std::vector<std::atomic<uint64_t>> slots_;
+    // Счётчики на разных кэш-линиях, чтобы потоки не мешали друг другу
+    alignas(64) std::atomic<uint64_t> next_slot_{0};
+    alignas(64) std::atomic<int> no_result_requests_{0};
+};
+
+template<typename DocumentPredicate>
+std::vector<Document> ConcurrentRequestQueue::AddFindRequest(std::string_view raw_query,
+                                                             DocumentPredicate document_predicate) {
+    const Clock::time_point start_time = Clock::now();
+    std::vector<Document> result = search_server_.FindTopDocuments(raw_query, document_predicate);
+    const Clock::time_point end_time = Clock::now();
+    RecordRequest(result.size(), end_time);
+    if (analytics_ != nullptr) {
+        analytics_->RecordQuery(raw_query, result.size(), end_time - start_time, end_time);
+    }
+    return result;
+}
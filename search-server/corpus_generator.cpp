@@ -0,0 +1,108 @@
+#include "corpus_generator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Различные буквенные слова: ранг в системе счисления по основанию 26
+std::string MakeWord(size_t rank) {
+    std::string word;
+    do {
+        word.push_back(static_cast<char>('a' + rank % 26));
+        rank /= 26;
+    } while (rank > 0);
+    return word;
+}
+
+}  // namespace
+
+CorpusGenerator::CorpusGenerator(const CorpusOptions &options)
+        : options_(options),
+          random_(options.seed) {
+    const size_t vocabulary_size = std::max<size_t>(options_.vocabulary_size, 1);
+    words_.reserve(vocabulary_size);
+    cumulative_weights_.reserve(vocabulary_size);
+    double total_weight = 0.0;
+    for (size_t rank = 0; rank < vocabulary_size; ++rank) {
+        words_.push_back(MakeWord(rank));
+        total_weight += 1.0 / std::pow(static_cast<double>(rank + 1), options_.zipf_exponent);
+        cumulative_weights_.push_back(total_weight);
+    }
+    for (double &weight: cumulative_weights_) {
+        weight /= total_weight;
+    }
+}
+
+std::string CorpusGenerator::GenerateDocument() {
+    const size_t word_count = GenerateInRange(options_.min_document_words, options_.max_document_words);
+    std::string document;
+    for (size_t i = 0; i < word_count; ++i) {
+        if (i > 0) {
+            document.push_back(' ');
+        }
+        document += words_[GenerateWordRank()];
+    }
+    return document;
+}
+
+std::string CorpusGenerator::GenerateQuery() {
+    const size_t word_count = GenerateInRange(options_.min_query_words, options_.max_query_words);
+    std::string query;
+    for (size_t i = 0; i < word_count; ++i) {
+        if (i > 0) {
+            query.push_back(' ');
+        }
+        // Первое слово всегда плюс-слово, иначе запрос может остаться без плюс-слов
+        if (i > 0 && GenerateUniform() < options_.minus_word_probability) {
+            query.push_back('-');
+        }
+        query += words_[GenerateWordRank()];
+    }
+    return query;
+}
+
+std::vector<int> CorpusGenerator::GenerateRatings() {
+    std::vector<int> ratings(GenerateInRange(1, 5));
+    for (int &rating: ratings) {
+        rating = static_cast<int>(GenerateInRange(0, 20)) - 10;
+    }
+    return ratings;
+}
+
+DocumentStatus CorpusGenerator::GenerateStatus() {
+    // Большинство документов актуальны
+    const double value = GenerateUniform();
+    if (value < 0.85) {
+        return DocumentStatus::ACTUAL;
+    }
+    if (value < 0.9) {
+        return DocumentStatus::IRRELEVANT;
+    }
+    return value < 0.95 ? DocumentStatus::BANNED : DocumentStatus::REMOVED;
+}
+
+std::vector<std::string> CorpusGenerator::GetMostFrequentWords(size_t count) const {
+    return {words_.begin(), words_.begin() + std::min(count, words_.size())};
+}
+
+const std::string &CorpusGenerator::GetWord(size_t rank) const {
+    return words_.at(rank);
+}
+
+size_t CorpusGenerator::GenerateWordRank() {
+    const double value = GenerateUniform();
+    const auto rank_it = std::upper_bound(cumulative_weights_.begin(), cumulative_weights_.end(), value);
+    return std::min<size_t>(rank_it - cumulative_weights_.begin(), words_.size() - 1);
+}
+
+double CorpusGenerator::GenerateUniform() {
+    return static_cast<double>(random_() >> 11) * 0x1.0p-53;
+}
+
+size_t CorpusGenerator::GenerateInRange(size_t min_value, size_t max_value) {
+    if (max_value <= min_value) {
+        return min_value;
+    }
+    return min_value + static_cast<size_t>(random_() % (max_value - min_value + 1));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "document.h"
+
+struct CorpusOptions {
+    size_t vocabulary_size = 20000;
+    // Частота слова ранга r пропорциональна 1 / r^zipf_exponent
+    double zipf_exponent = 1.0;
+    size_t min_document_words = 8;
+    size_t max_document_words = 64;
+    size_t min_query_words = 1;
+    size_t max_query_words = 4;
+    double minus_word_probability = 0.1;
+    uint64_t seed = 42;
+};
+
+// Детерминированный генератор документов и запросов с распределением слов по закону Ципфа, как в
+// естественном языке: при одном seed и одних настройках последовательность одинакова на любой машине
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(const CorpusOptions &options = {});
+
+    std::string GenerateDocument();
+
+    // Слова запроса выбираются по тому же распределению, минус-слова — с вероятностью minus_word_probability
+    std::string GenerateQuery();
+
+    std::vector<int> GenerateRatings();
+
+    DocumentStatus GenerateStatus();
+
+    // Самые частые слова, годятся в стоп-слова
+    std::vector<std::string> GetMostFrequentWords(size_t count) const;
+
+    // Слово ранга rank, 0 — самое частое
+    const std::string &GetWord(size_t rank) const;
+
+    size_t GenerateWordRank();
+
+private:
+    // Равномерно на [0, 1), не зависит от реализации std::uniform_real_distribution
+    double GenerateUniform();
+
+    size_t GenerateInRange(size_t min_value, size_t max_value);
+
+    const CorpusOptions options_;
+    std::mt19937_64 random_;
+    std::vector<std::string> words_;
+    std::vector<double> cumulative_weights_;
+};
@@ -1,5 +1,7 @@
 #include "document.h"
 
+#include <cmath>
+
 std::ostream &operator<<(std::ostream &out, const Document &document) {
     using namespace std;
     out << "{ "s
@@ -9,3 +11,9 @@ std::ostream &operator<<(std::ostream &out, const Document &document) {
     return out;
 }
 
+bool IsRankedHigher(const Document &lhs, const Document &rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
+        return lhs.rating > rhs.rating;
+    }
+    return lhs.relevance > rhs.relevance;
+}
@@ -5,6 +5,8 @@
 #include <vector>
 #include <stdexcept>
 
+const double EPSILON = 1e-6;
+
 enum class DocumentStatus {
     ACTUAL,
     IRRELEVANT,
@@ -24,4 +26,7 @@ struct Document {
     int rating = 0;
 };
 
-std::ostream &operator<<(std::ostream &out, const Document &document);
\ No newline at end of file
+std::ostream &operator<<(std::ostream &out, const Document &document);
+
+// Порядок выдачи: по убыванию релевантности, при равной релевантности — по убыванию рейтинга
+bool IsRankedHigher(const Document &lhs, const Document &rhs);
@@ -0,0 +1,89 @@
+#include "document_filter.h"
+
+#include <algorithm>
+
+DocumentFilter &DocumentFilter::AddStatus(DocumentStatus status) {
+    if (status_mask_ == ALL_STATUSES) {
+        status_mask_ = 0;
+    }
+    status_mask_ |= GetStatusMask(status);
+    return *this;
+}
+
+DocumentFilter &DocumentFilter::SetRatingRange(int min_rating, int max_rating) {
+    min_rating_ = min_rating;
+    max_rating_ = max_rating;
+    return *this;
+}
+
+DocumentFilter &DocumentFilter::SetDocumentIdRange(int min_document_id, int max_document_id) {
+    min_document_id_ = std::max(min_document_id, 0);
+    max_document_id_ = max_document_id;
+    return *this;
+}
+
+bool DocumentFilter::operator()(int document_id, DocumentStatus status, int rating) const {
+    return (status_mask_ & GetStatusMask(status)) != 0
+           && min_rating_ <= rating && rating <= max_rating_
+           && min_document_id_ <= document_id && document_id <= max_document_id_;
+}
+
+bool DocumentFilter::AllowsStatusMask(uint32_t status_mask) const {
+    return (status_mask_ & status_mask) != 0;
+}
+
+bool DocumentFilter::OverlapsRatingRange(int min_rating, int max_rating) const {
+    return min_rating <= max_rating_ && min_rating_ <= max_rating;
+}
+
+int DocumentFilter::GetMinDocumentId() const {
+    return min_document_id_;
+}
+
+int DocumentFilter::GetMaxDocumentId() const {
+    return max_document_id_;
+}
+
+uint32_t DocumentFilter::GetStatusMask(DocumentStatus status) {
+    return 1u << static_cast<int>(status);
+}
+
+void DocumentBlockIndex::AddDocument(int document_id, DocumentStatus status, int rating) {
+    const auto [block_it, is_new] = blocks_.emplace(GetBlock(document_id),
+                                                    BlockSummary{rating, rating, 0, 0});
+    BlockSummary &summary = block_it->second;
+    summary.min_rating = std::min(summary.min_rating, rating);
+    summary.max_rating = std::max(summary.max_rating, rating);
+    summary.status_mask |= DocumentFilter::GetStatusMask(status);
+    ++summary.document_count;
+}
+
+void DocumentBlockIndex::RemoveDocument(int document_id) {
+    const auto block_it = blocks_.find(GetBlock(document_id));
+    if (block_it != blocks_.end() && --block_it->second.document_count == 0) {
+        blocks_.erase(block_it);
+    }
+}
+
+bool DocumentBlockIndex::MayContainMatches(int block, const DocumentFilter &filter) const {
+    const auto block_it = blocks_.find(block);
+    if (block_it == blocks_.end()) {
+        return false;
+    }
+    const BlockSummary &summary = block_it->second;
+    return filter.AllowsStatusMask(summary.status_mask)
+           && filter.OverlapsRatingRange(summary.min_rating, summary.max_rating);
+}
+
+int DocumentBlockIndex::GetBlock(int document_id) {
+    return document_id >> BLOCK_SHIFT;
+}
+
+int DocumentBlockIndex::GetNextBlockStart(int block) {
+    const int64_t next_block_start = (static_cast<int64_t>(block) + 1) << BLOCK_SHIFT;
+    return next_block_start > std::numeric_limits<int>::max() ? -1 : static_cast<int>(next_block_start);
+}
+
+void DocumentBlockIndex::Clear() {
+    blocks_.clear();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+#include "document.h"
+
+// Отбор документов по набору статусов, диапазону рейтинга и диапазону id. В отличие от произвольного
+// предиката, его можно проверить сразу для целого блока документов. Сам фильтр тоже предикат
+// и подходит везде, где ожидается DocumentPredicate
+class DocumentFilter {
+public:
+    // Пропускает документы с любым статусом
+    DocumentFilter() = default;
+
+    // Первый вызов оставляет только указанный статус, последующие добавляют статусы к набору
+    DocumentFilter &AddStatus(DocumentStatus status);
+
+    // Границы включаются
+    DocumentFilter &SetRatingRange(int min_rating, int max_rating);
+
+    DocumentFilter &SetDocumentIdRange(int min_document_id, int max_document_id);
+
+    bool operator()(int document_id, DocumentStatus status, int rating) const;
+
+    bool AllowsStatusMask(uint32_t status_mask) const;
+
+    bool OverlapsRatingRange(int min_rating, int max_rating) const;
+
+    int GetMinDocumentId() const;
+
+    int GetMaxDocumentId() const;
+
+    static uint32_t GetStatusMask(DocumentStatus status);
+
+private:
+    static constexpr uint32_t ALL_STATUSES = ~0u;
+
+    uint32_t status_mask_ = ALL_STATUSES;
+    int min_rating_ = std::numeric_limits<int>::min();
+    int max_rating_ = std::numeric_limits<int>::max();
+    int min_document_id_ = 0;
+    int max_document_id_ = std::numeric_limits<int>::max();
+};
+
+// Сводка по блокам из 128 соседних id: диапазон рейтингов и набор статусов документов блока.
+// При удалении сводка не сужается, а лишь остаётся с запасом, поэтому пропуск блока всегда безопасен
+class DocumentBlockIndex {
+public:
+    static constexpr int BLOCK_SHIFT = 7;
+
+    void AddDocument(int document_id, DocumentStatus status, int rating);
+
+    void RemoveDocument(int document_id);
+
+    // false, если ни один документ блока не может пройти фильтр
+    bool MayContainMatches(int block, const DocumentFilter &filter) const;
+
+    static int GetBlock(int document_id);
+
+    // Первый id следующего блока, для последнего блока — -1
+    static int GetNextBlockStart(int block);
+
+    void Clear();
+
+private:
+    struct BlockSummary {
+        int min_rating;
+        int max_rating;
+        uint32_t status_mask;
+        int document_count;
+    };
+
+    std::unordered_map<int, BlockSummary> blocks_;
+};
@@ -0,0 +1,200 @@
+#include "duplicate_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+struct BandKey {
+    uint64_t key;
+    // Номер документа в порядке возрастания id
+    uint32_t document_index;
+
+    bool operator<(const BandKey &other) const {
+        return key < other.key || (key == other.key && document_index < other.document_index);
+    }
+};
+
+// Хеш полосы band: комбинация rows_per_band значений MinHash, каждое со своей хеш-функцией
+uint64_t ComputeBandKey(const std::map<std::string_view, double> &word_freqs, int band, int rows_per_band) {
+    uint64_t band_key = MixBits(band);
+    for (int row = 0; row < rows_per_band; ++row) {
+        const uint64_t seed = MixBits(static_cast<uint64_t>(band) * rows_per_band + row + 1);
+        uint64_t min_hash = std::numeric_limits<uint64_t>::max();
+        for (const auto &[word, _]: word_freqs) {
+            min_hash = std::min(min_hash, HashWord(word, seed));
+        }
+        band_key = MixBits(band_key ^ min_hash);
+    }
+    return band_key;
+}
+
+}  // namespace
+
+double ComputeJaccardSimilarity(const std::map<std::string_view, double> &lhs,
+                                const std::map<std::string_view, double> &rhs) {
+    size_t common_words = 0;
+    for (auto lhs_it = lhs.begin(), rhs_it = rhs.begin(); lhs_it != lhs.end() && rhs_it != rhs.end();) {
+        if (lhs_it->first < rhs_it->first) {
+            ++lhs_it;
+        } else if (rhs_it->first < lhs_it->first) {
+            ++rhs_it;
+        } else {
+            ++common_words;
+            ++lhs_it;
+            ++rhs_it;
+        }
+    }
+    const size_t all_words = lhs.size() + rhs.size() - common_words;
+    return all_words == 0 ? 1.0 : static_cast<double>(common_words) / all_words;
+}
+
+DuplicateDetector::DuplicateDetector(double min_similarity)
+        : DuplicateDetector(min_similarity, SIGNATURE_SIZE, 1) {
+    // Пары со сходством s попадают в одну полосу с вероятностью 1 - (1 - s^r)^b, и перелом этой кривой
+    // приходится на (1 / b)^(1 / r). Выбирается самое длинное r, при котором перелом не выше порога
+    for (int rows_per_band = 1; rows_per_band <= SIGNATURE_SIZE; rows_per_band *= 2) {
+        const int bands = SIGNATURE_SIZE / rows_per_band;
+        if (std::pow(1.0 / bands, 1.0 / rows_per_band) <= min_similarity_) {
+            bands_ = bands;
+            rows_per_band_ = rows_per_band;
+        }
+    }
+}
+
+DuplicateDetector::DuplicateDetector(double min_similarity, int bands, int rows_per_band)
+        : min_similarity_(min_similarity), bands_(bands), rows_per_band_(rows_per_band) {
+    using namespace std::string_literals;
+
+    if (!(min_similarity > 0.0 && min_similarity <= 1.0)) {
+        throw std::invalid_argument("Similarity threshold must be in (0, 1]"s);
+    }
+    if (bands <= 0 || rows_per_band <= 0) {
+        throw std::invalid_argument("LSH bands and rows must be positive"s);
+    }
+}
+
+std::vector<std::vector<int>> DuplicateDetector::FindDuplicateGroups(const SearchServer &search_server) const {
+    const std::vector<int> document_ids(search_server.begin(), search_server.end());
+    const auto get_index = [&document_ids](const int &document_id) {
+        return static_cast<uint32_t>(&document_id - document_ids.data());
+    };
+    // Для каждого документа — самый ранний документ, на который он похож; сходство не транзитивно,
+    // поэтому документ считается дубликатом, только если сам похож на какой-то более ранний
+    std::vector<uint32_t> originals(document_ids.size());
+    for (uint32_t index = 0; index < originals.size(); ++index) {
+        originals[index] = index;
+    }
+
+    std::vector<std::pair<TermSetFingerprint, uint32_t>> fingerprints(document_ids.size());
+    std::transform(std::execution::par, document_ids.begin(), document_ids.end(), fingerprints.begin(),
+                   [&search_server, &get_index](const int &document_id) {
+                       return std::pair{ComputeTermSetFingerprint(search_server.GetWordFrequencies(document_id)),
+                                        get_index(document_id)};
+                   });
+    std::sort(std::execution::par, fingerprints.begin(), fingerprints.end());
+    for (size_t first = 0; first < fingerprints.size();) {
+        size_t last = first + 1;
+        for (; last < fingerprints.size() && fingerprints[last].first == fingerprints[first].first; ++last) {
+            originals[fingerprints[last].second] = fingerprints[first].second;
+        }
+        first = last;
+    }
+    fingerprints.clear();
+    fingerprints.shrink_to_fit();
+
+    if (min_similarity_ < 1.0) {
+        std::vector<BandKey> band_keys(document_ids.size());
+        std::vector<std::pair<uint32_t, uint32_t>> candidates;
+        candidates.reserve(CANDIDATE_CHUNK_SIZE + MAX_BUCKET_COMPARISONS);
+        std::vector<char> is_similar;
+        // Проверяет накопленные пары и опустошает порцию
+        const auto check_candidates = [&]() {
+            is_similar.resize(candidates.size());
+            std::transform(std::execution::par, candidates.begin(), candidates.end(), is_similar.begin(),
+                           [this, &search_server, &document_ids](const std::pair<uint32_t, uint32_t> &candidate) {
+                               return ComputeJaccardSimilarity(
+                                       search_server.GetWordFrequencies(document_ids[candidate.first]),
+                                       search_server.GetWordFrequencies(document_ids[candidate.second]))
+                                      >= min_similarity_;
+                           });
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                if (is_similar[i]) {
+                    originals[candidates[i].second] = std::min(originals[candidates[i].second], candidates[i].first);
+                }
+            }
+            candidates.clear();
+        };
+        for (int band = 0; band < bands_; ++band) {
+            std::transform(std::execution::par, document_ids.begin(), document_ids.end(), band_keys.begin(),
+                           [this, band, &search_server, &get_index](const int &document_id) {
+                               return BandKey{ComputeBandKey(search_server.GetWordFrequencies(document_id), band,
+                                                             rows_per_band_), get_index(document_id)};
+                           });
+            std::sort(std::execution::par, band_keys.begin(), band_keys.end());
+
+            // Документ корзины сравнивается с первыми MAX_BUCKET_COMPARISONS документами корзины, кроме тех,
+            // что уже не могут дать более ранний оригинал. Корзина упорядочена по id, поэтому это самые ранние
+            for (size_t first = 0; first < band_keys.size();) {
+                size_t last = first + 1;
+                while (last < band_keys.size() && band_keys[last].key == band_keys[first].key) {
+                    ++last;
+                }
+                for (size_t later = first + 1; later < last; ++later) {
+                    const uint32_t candidate = band_keys[later].document_index;
+                    const size_t earlier_end = std::min(later, first + MAX_BUCKET_COMPARISONS);
+                    for (size_t earlier = first; earlier < earlier_end; ++earlier) {
+                        const uint32_t original = band_keys[earlier].document_index;
+                        if (original >= originals[candidate]) {
+                            break;
+                        }
+                        candidates.emplace_back(original, candidate);
+                    }
+                    if (candidates.size() >= CANDIDATE_CHUNK_SIZE) {
+                        check_candidates();
+                    }
+                }
+                first = last;
+            }
+            check_candidates();
+        }
+    }
+
+    std::vector<std::vector<int>> result;
+    std::vector<int> original_to_group(document_ids.size(), -1);
+    for (uint32_t index = 0; index < document_ids.size(); ++index) {
+        const uint32_t original = originals[index];
+        if (original == index) {
+            continue;
+        }
+        if (original_to_group[original] < 0) {
+            original_to_group[original] = static_cast<int>(result.size());
+            result.push_back({document_ids[original]});
+        }
+        result[original_to_group[original]].push_back(document_ids[index]);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<int> DuplicateDetector::FindDuplicates(const SearchServer &search_server) const {
+    std::vector<int> duplicates;
+    for (const auto &group: FindDuplicateGroups(search_server)) {
+        duplicates.insert(duplicates.end(), group.begin() + 1, group.end());
+    }
+    std::sort(duplicates.begin(), duplicates.end());
+    return duplicates;
+}
+
+int DuplicateDetector::GetBandCount() const {
+    return bands_;
+}
+
+int DuplicateDetector::GetRowsPerBand() const {
+    return rows_per_band_;
+}
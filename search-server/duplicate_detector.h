@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <string_view>
+#include <vector>
+
+#include "search_server.h"
+#include "term_set_fingerprint.h"
+
+// Доля общих слов двух документов (коэффициент Жаккара), для двух пустых документов — 1
+double ComputeJaccardSimilarity(const std::map<std::string_view, double> &lhs,
+                                const std::map<std::string_view, double> &rhs);
+
+// Поиск дубликатов среди документов сервера. Точные дубликаты (одинаковый набор слов) находятся сортировкой
+// отпечатков, почти дубликаты — по MinHash с разбиением сигнатуры на полосы (LSH): документы, совпавшие
+// хотя бы в одной полосе, сравниваются точно. Сигнатуры не хранятся, полосы обрабатываются по очереди,
+// поэтому памяти нужно O(число документов) независимо от их длины. Сигнатуры считаются параллельно
+class DuplicateDetector {
+public:
+    static constexpr int SIGNATURE_SIZE = 128;
+    // Документ корзины LSH сравнивается не более чем с этим числом самых ранних документов той же корзины,
+    // так что частое слово или короткие документы не дают квадратичного числа пар
+    static constexpr size_t MAX_BUCKET_COMPARISONS = 64;
+    // Пары-кандидаты проверяются порциями такого размера, поэтому память на них не зависит от числа документов
+    static constexpr size_t CANDIDATE_CHUNK_SIZE = 1 << 16;
+
+    // min_similarity — порог коэффициента Жаккара; 1 означает поиск только точных дубликатов.
+    // Число строк в полосе подбирается так, чтобы пары с таким сходством почти наверняка попали в одну полосу
+    explicit DuplicateDetector(double min_similarity = 1.0);
+
+    DuplicateDetector(double min_similarity, int bands, int rows_per_band);
+
+    // Группы по возрастанию id: первым идёт оригинал, за ним документы, для которых он самый ранний похожий.
+    // Сходство не транзитивно: оригинал одной группы сам может быть дубликатом в другой.
+    // Документы без дубликатов не попадают ни в одну группу
+    std::vector<std::vector<int>> FindDuplicateGroups(const SearchServer &search_server) const;
+
+    // Документы, похожие хотя бы на один документ с меньшим id, по возрастанию id
+    std::vector<int> FindDuplicates(const SearchServer &search_server) const;
+
+    int GetBandCount() const;
+
+    int GetRowsPerBand() const;
+
+private:
+    double min_similarity_;
+    int bands_;
+    int rows_per_band_;
+};
@@ -0,0 +1,134 @@
+#include "fuzzy_search.h"
+
+#include <algorithm>
+
+LevenshteinAutomaton::LevenshteinAutomaton(std::string_view word, int max_distance)
+        : word_(word),
+          max_distance_(static_cast<uint8_t>(max_distance)) {
+}
+
+LevenshteinAutomaton::State LevenshteinAutomaton::Start() const {
+    State state(word_.size() + 1);
+    for (size_t i = 0; i < state.size(); ++i) {
+        state[i] = static_cast<uint8_t>(std::min<size_t>(i, max_distance_ + 1));
+    }
+    return state;
+}
+
+void LevenshteinAutomaton::Step(const State &state, char c, State &next) const {
+    const uint8_t limit = max_distance_ + 1;
+    next.resize(state.size());
+    next[0] = std::min<uint8_t>(state[0] + 1, limit);
+    for (size_t i = 1; i < state.size(); ++i) {
+        const uint8_t replace_cost = state[i - 1] + (word_[i - 1] == c ? 0 : 1);
+        const uint8_t insert_cost = state[i] + 1;
+        const uint8_t delete_cost = next[i - 1] + 1;
+        next[i] = std::min({replace_cost, insert_cost, delete_cost, limit});
+    }
+}
+
+bool LevenshteinAutomaton::CanMatch(const State &state) const {
+    return *std::min_element(state.begin(), state.end()) <= max_distance_;
+}
+
+int LevenshteinAutomaton::GetDistance(const State &state) const {
+    return state.back();
+}
+
+int LevenshteinAutomaton::GetDistance(std::string_view candidate) const {
+    const size_t length_difference = candidate.size() > word_.size() ? candidate.size() - word_.size()
+                                                                      : word_.size() - candidate.size();
+    if (length_difference > max_distance_) {
+        return max_distance_ + 1;
+    }
+    State state = Start();
+    State next;
+    for (const char c: candidate) {
+        Step(state, c, next);
+        if (!CanMatch(next)) {
+            return max_distance_ + 1;
+        }
+        state.swap(next);
+    }
+    return GetDistance(state);
+}
+
+int LevenshteinAutomaton::GetMaxDistance() const {
+    return max_distance_;
+}
+
+std::vector<uint32_t> TrigramIndex::GetTrigrams(std::string_view word) {
+    // Граница слова кодируется нулём: в словах индекса управляющих символов нет
+    std::vector<uint32_t> trigrams;
+    trigrams.reserve(word.size());
+    uint32_t window = 0;
+    for (size_t i = 0; i <= word.size(); ++i) {
+        const uint32_t c = i < word.size() ? static_cast<unsigned char>(word[i]) : 0;
+        window = ((window << 8) | c) & 0xFFFFFF;
+        if (i >= 1) {
+            trigrams.push_back(window);
+        }
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+void TrigramIndex::AddWord(std::string_view word) {
+    for (const uint32_t trigram: GetTrigrams(word)) {
+        trigram_to_words_[trigram].push_back(word);
+    }
+}
+
+void TrigramIndex::RemoveWord(std::string_view word) {
+    for (const uint32_t trigram: GetTrigrams(word)) {
+        const auto trigram_it = trigram_to_words_.find(trigram);
+        if (trigram_it == trigram_to_words_.end()) {
+            continue;
+        }
+        auto &words = trigram_it->second;
+        const auto word_it = std::find(words.begin(), words.end(), word);
+        if (word_it != words.end()) {
+            *word_it = words.back();
+            words.pop_back();
+        }
+        if (words.empty()) {
+            trigram_to_words_.erase(trigram_it);
+        }
+    }
+}
+
+std::optional<std::vector<std::string_view>> TrigramIndex::FindCandidates(std::string_view word,
+                                                                          int max_distance) const {
+    const std::vector<uint32_t> trigrams = GetTrigrams(word);
+    const size_t lost_trigrams = 3 * static_cast<size_t>(max_distance);
+    if (trigrams.size() <= lost_trigrams) {
+        return std::nullopt;
+    }
+
+    std::vector<const std::vector<std::string_view> *> lists;
+    lists.reserve(trigrams.size());
+    static const std::vector<std::string_view> empty_list;
+    for (const uint32_t trigram: trigrams) {
+        const auto trigram_it = trigram_to_words_.find(trigram);
+        lists.push_back(trigram_it == trigram_to_words_.end() ? &empty_list : &trigram_it->second);
+    }
+    // Подходящее слово содержит не меньше k - 3d триграмм запроса, значит, встречается хотя бы
+    // в одном из любых 3d + 1 списков. Берутся самые короткие
+    const size_t list_count = lost_trigrams + 1;
+    std::partial_sort(lists.begin(), lists.begin() + list_count, lists.end(), [](const auto *lhs, const auto *rhs) {
+        return lhs->size() < rhs->size();
+    });
+
+    std::vector<std::string_view> candidates;
+    for (size_t i = 0; i < list_count; ++i) {
+        candidates.insert(candidates.end(), lists[i]->begin(), lists[i]->end());
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+void TrigramIndex::Clear() {
+    trigram_to_words_.clear();
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Автомат Левенштейна: принимает слова на расстоянии редактирования не больше max_distance от word.
+// Состояние — строка таблицы динамического программирования со значениями, ограниченными
+// max_distance + 1, шаг стоит O(|word|). Расстояние считается по байтам
+class LevenshteinAutomaton {
+public:
+    using State = std::vector<uint8_t>;
+
+    LevenshteinAutomaton(std::string_view word, int max_distance);
+
+    State Start() const;
+
+    // Переход по символу c, результат записывается в next
+    void Step(const State &state, char c, State &next) const;
+
+    // Из состояния ещё достижимо принимающее
+    bool CanMatch(const State &state) const;
+
+    // Расстояние от прочитанного слова до word, или max_distance + 1, если оно больше max_distance
+    int GetDistance(const State &state) const;
+
+    int GetDistance(std::string_view candidate) const;
+
+    int GetMaxDistance() const;
+
+private:
+    std::string word_;
+    uint8_t max_distance_;
+};
+
+// Обходит слова упорядоченного словаря (ключи map), принимаемые автоматом. Слова с общим началом
+// делят вычисленные состояния, а все слова с тупиковым началом пропускаются одним lower_bound
+template <typename WordMap, typename Callback>
+void ForEachFuzzyMatch(const LevenshteinAutomaton &automaton, const WordMap &dictionary, Callback callback) {
+    std::vector<LevenshteinAutomaton::State> states(1, automaton.Start());
+    std::string_view previous_word;
+    size_t computed_depth = 0;
+
+    auto word_it = dictionary.begin();
+    while (word_it != dictionary.end()) {
+        const std::string_view word = word_it->first;
+        size_t depth = 0;
+        while (depth < computed_depth && depth < word.size() && word[depth] == previous_word[depth]) {
+            ++depth;
+        }
+        bool is_dead = false;
+        while (depth < word.size()) {
+            if (states.size() == depth + 1) {
+                states.emplace_back();
+            }
+            automaton.Step(states[depth], word[depth], states[depth + 1]);
+            ++depth;
+            if (!automaton.CanMatch(states[depth])) {
+                is_dead = true;
+                break;
+            }
+        }
+        previous_word = word;
+        computed_depth = depth;
+
+        if (!is_dead) {
+            const int distance = automaton.GetDistance(states[depth]);
+            if (distance <= automaton.GetMaxDistance()) {
+                callback(*word_it, distance);
+            }
+            ++word_it;
+            continue;
+        }
+        // Следующее слово, не начинающееся с тупикового префикса
+        std::string next_prefix(word.substr(0, depth));
+        while (!next_prefix.empty() && static_cast<unsigned char>(next_prefix.back()) == 0xFF) {
+            next_prefix.pop_back();
+        }
+        if (next_prefix.empty()) {
+            break;
+        }
+        ++next_prefix.back();
+        word_it = dictionary.lower_bound(next_prefix);
+    }
+}
+
+// Триграммы слов словаря для отбора кандидатов нечёткого поиска. Слово дополняется границей
+// с обеих сторон, поэтому слово длины n даёт n триграмм. Одна правка разрушает не больше трёх
+// триграмм, так что слово на расстоянии d содержит не меньше k - 3d из k триграмм запроса
+class TrigramIndex {
+public:
+    // Индекс ссылается на переданные строки, они должны жить не меньше индекса
+    void AddWord(std::string_view word);
+
+    void RemoveWord(std::string_view word);
+
+    // Слова, которые могут оказаться на расстоянии не больше max_distance от word, без повторов.
+    // Если триграммы не позволяют ничего отсеять (короткое слово), возвращает std::nullopt
+    std::optional<std::vector<std::string_view>> FindCandidates(std::string_view word, int max_distance) const;
+
+    void Clear();
+
+private:
+    // Различные триграммы слова
+    static std::vector<uint32_t> GetTrigrams(std::string_view word);
+
+    std::unordered_map<uint32_t, std::vector<std::string_view>> trigram_to_words_;
+};
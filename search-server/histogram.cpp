@@ -0,0 +1,115 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace histogram_buckets {
+
+size_t GetBucket(uint64_t value) {
+    if (value < 2 * SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+    const int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    const size_t bucket = static_cast<size_t>(shift) * SUB_BUCKET_COUNT + static_cast<size_t>(value >> shift);
+    return std::min(bucket, BUCKET_COUNT - 1);
+}
+
+uint64_t GetBucketUpperBound(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKET_COUNT) {
+        return bucket;
+    }
+    const int shift = static_cast<int>(bucket / SUB_BUCKET_COUNT) - 1;
+    const uint64_t sub_bucket = bucket % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+}  // namespace histogram_buckets
+
+HistogramSnapshot::HistogramSnapshot()
+        : bucket_counts_(histogram_buckets::BUCKET_COUNT, 0) {
+}
+
+void HistogramSnapshot::AddToBucket(size_t bucket, uint64_t count) {
+    bucket_counts_[bucket] += count;
+    total_count_ += count;
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot &other) {
+    for (size_t bucket = 0; bucket < bucket_counts_.size(); ++bucket) {
+        bucket_counts_[bucket] += other.bucket_counts_[bucket];
+    }
+    total_count_ += other.total_count_;
+    sum_ += other.sum_;
+}
+
+uint64_t HistogramSnapshot::GetTotalCount() const {
+    return total_count_;
+}
+
+uint64_t HistogramSnapshot::GetSum() const {
+    return sum_;
+}
+
+void HistogramSnapshot::SetSum(uint64_t sum) {
+    sum_ = sum;
+}
+
+uint64_t HistogramSnapshot::GetValueAtPercentile(double percentile) const {
+    if (total_count_ == 0) {
+        return 0;
+    }
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t rank = std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total_count_))));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < bucket_counts_.size(); ++bucket) {
+        seen += bucket_counts_[bucket];
+        if (seen >= rank) {
+            return histogram_buckets::GetBucketUpperBound(bucket);
+        }
+    }
+    return GetMaxValue();
+}
+
+uint64_t HistogramSnapshot::GetMaxValue() const {
+    for (size_t bucket = bucket_counts_.size(); bucket > 0; --bucket) {
+        if (bucket_counts_[bucket - 1] != 0) {
+            return histogram_buckets::GetBucketUpperBound(bucket - 1);
+        }
+    }
+    return 0;
+}
+
+const std::vector<uint64_t> &HistogramSnapshot::GetBucketCounts() const {
+    return bucket_counts_;
+}
+
+void AtomicHistogram::Record(uint64_t value) {
+    bucket_counts_[histogram_buckets::GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+void AtomicHistogram::RecordExclusive(uint64_t value) {
+    auto &count = bucket_counts_[histogram_buckets::GetBucket(value)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void AtomicHistogram::Clear() {
+    for (auto &count: bucket_counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+}
+
+HistogramSnapshot AtomicHistogram::GetSnapshot() const {
+    HistogramSnapshot snapshot;
+    for (size_t bucket = 0; bucket < bucket_counts_.size(); ++bucket) {
+        const uint64_t count = bucket_counts_[bucket].load(std::memory_order_relaxed);
+        if (count != 0) {
+            snapshot.AddToBucket(bucket, count);
+        }
+    }
+    snapshot.SetSum(sum_.load(std::memory_order_relaxed));
+    return snapshot;
+}
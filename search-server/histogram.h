@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Лог-линейная разбивка значений в духе HdrHistogram: значения до 32 различаются точно, дальше каждая
+// степень двойки делится на 16 корзин, так что относительная ошибка не больше 1/16. Значения от 2^40
+// (для наносекунд — около 18 минут) попадают в последнюю корзину
+namespace histogram_buckets {
+
+constexpr int SUB_BUCKET_BITS = 4;
+constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+constexpr int MAX_VALUE_BITS = 40;
+constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+size_t GetBucket(uint64_t value);
+
+// Наибольшее значение, попадающее в корзину
+uint64_t GetBucketUpperBound(size_t bucket);
+
+}  // namespace histogram_buckets
+
+// Копия гистограммы, с которой можно спокойно работать: складывать и считать перцентили
+class HistogramSnapshot {
+public:
+    HistogramSnapshot();
+
+    void AddToBucket(size_t bucket, uint64_t count);
+
+    void Merge(const HistogramSnapshot &other);
+
+    uint64_t GetTotalCount() const;
+
+    uint64_t GetSum() const;
+
+    void SetSum(uint64_t sum);
+
+    // Верхняя граница корзины, в которую попало значение с заданным перцентилем (0..100). Для пустой — 0
+    uint64_t GetValueAtPercentile(double percentile) const;
+
+    uint64_t GetMaxValue() const;
+
+    const std::vector<uint64_t> &GetBucketCounts() const;
+
+private:
+    std::vector<uint64_t> bucket_counts_;
+    uint64_t total_count_ = 0;
+    uint64_t sum_ = 0;
+};
+
+// Гистограмма, которую пополняют из нескольких потоков без блокировок: запись — один fetch_add в корзину
+// и один в сумму. Снимок, сделанный во время записи, может не учесть последние значения
+class AtomicHistogram {
+public:
+    AtomicHistogram() = default;
+
+    AtomicHistogram(const AtomicHistogram &) = delete;
+
+    AtomicHistogram &operator=(const AtomicHistogram &) = delete;
+
+    void Record(uint64_t value);
+
+    // Для гистограммы, которую пишет единственный поток: обходится без атомарного сложения
+    void RecordExclusive(uint64_t value);
+
+    void Clear();
+
+    HistogramSnapshot GetSnapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, histogram_buckets::BUCKET_COUNT> bucket_counts_{};
+    std::atomic<uint64_t> sum_{0};
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <set>
+#include <tuple>
+
+// Вклад документа в релевантность по слову: IDF у всех документов слова общий,
+// поэтому порядок по TF совпадает с порядком по TF-IDF
+struct Impact {
+    double term_freq;
+    int rating;
+    int document_id;
+};
+
+// Порядок выдачи: по убыванию TF, затем по убыванию рейтинга, затем по id
+struct HigherImpact {
+    bool operator()(const Impact &lhs, const Impact &rhs) const {
+        return std::tie(rhs.term_freq, rhs.rating, lhs.document_id)
+               < std::tie(lhs.term_freq, lhs.rating, rhs.document_id);
+    }
+};
+
+using ImpactList = std::set<Impact, HigherImpact>;
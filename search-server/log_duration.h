@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <iostream>
+#include <string>
 
 #define PROFILE_CONCAT_INTERNAL(X, Y) X##Y
 #define PROFILE_CONCAT(X, Y) PROFILE_CONCAT_INTERNAL(X, Y)
@@ -34,7 +35,7 @@ public:
     }
 
 private:
-    const std::string_view label_;
+    const std::string label_;
     std::ostream &out_ = std::cerr;
     const Clock::time_point start_time_ = Clock::now();
 };
\ No newline at end of file
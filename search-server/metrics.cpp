@@ -0,0 +1,181 @@
+#include "metrics.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+
+constexpr std::array<std::string_view, METRIC_STAGE_COUNT> STAGE_NAMES = {
+        "query_parse", "query_lookup", "query_score", "query_sort", "query_total", "add_document",
+        "remove_document",
+};
+
+constexpr std::array<std::string_view, METRIC_COUNTER_COUNT> COUNTER_NAMES = {
+        "queries", "partial_queries", "added_documents", "removed_documents",
+};
+
+// Границы гистограмм Prometheus: от 2^10 нс (~1 мкс) до 2^36 нс (~69 с), совпадают с границами корзин
+constexpr int MIN_PROMETHEUS_BUCKET_BITS = 10;
+constexpr int MAX_PROMETHEUS_BUCKET_BITS = 36;
+constexpr int PROMETHEUS_BUCKET_STEP_BITS = 2;
+
+constexpr double NANOSECONDS_PER_SECOND = 1e9;
+
+}  // namespace
+
+std::string_view GetMetricStageName(MetricStage stage) {
+    return STAGE_NAMES[static_cast<size_t>(stage)];
+}
+
+std::string_view GetMetricCounterName(MetricCounter counter) {
+    return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
+
+const HistogramSnapshot &MetricsSnapshot::GetStageDurations(MetricStage stage) const {
+    return stage_durations_ns[static_cast<size_t>(stage)];
+}
+
+uint64_t MetricsSnapshot::GetCounter(MetricCounter counter) const {
+    return counters[static_cast<size_t>(counter)];
+}
+
+MetricsRegistry &MetricsRegistry::Instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void MetricsRegistry::RecordDuration(MetricStage stage, uint64_t nanoseconds) {
+    ForCurrentThread().stage_durations_ns[static_cast<size_t>(stage)].RecordExclusive(nanoseconds);
+}
+
+void MetricsRegistry::AddToCounter(MetricCounter counter, uint64_t value) {
+    auto &count = ForCurrentThread().counters[static_cast<size_t>(counter)];
+    count.store(count.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+MetricsSnapshot MetricsRegistry::GetSnapshot() const {
+    MetricsSnapshot snapshot;
+    std::lock_guard guard(mutex_);
+    for (const auto &thread_metrics: thread_metrics_) {
+        for (size_t stage = 0; stage < METRIC_STAGE_COUNT; ++stage) {
+            snapshot.stage_durations_ns[stage].Merge(thread_metrics->stage_durations_ns[stage].GetSnapshot());
+        }
+        for (size_t counter = 0; counter < METRIC_COUNTER_COUNT; ++counter) {
+            snapshot.counters[counter] += thread_metrics->counters[counter].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+MetricsRegistry::ThreadMetrics &MetricsRegistry::ForCurrentThread() {
+    thread_local ThreadMetrics *thread_metrics = [this] {
+        std::lock_guard guard(mutex_);
+        return thread_metrics_.emplace_back(std::make_unique<ThreadMetrics>()).get();
+    }();
+    return *thread_metrics;
+}
+
+MetricsStopwatch::MetricsStopwatch(MetricStage total_stage)
+        : total_stage_(total_stage) {
+}
+
+MetricsStopwatch::~MetricsStopwatch() {
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time_);
+    MetricsRegistry::Instance().RecordDuration(total_stage_, duration.count());
+}
+
+void MetricsStopwatch::Lap(MetricStage stage) {
+    const Clock::time_point now = Clock::now();
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now - lap_start_time_);
+    MetricsRegistry::Instance().RecordDuration(stage, duration.count());
+    lap_start_time_ = now;
+}
+
+void WritePrometheusText(std::ostream &output, const MetricsSnapshot &snapshot) {
+    const auto precision = output.precision(9);
+    output << "# HELP search_server_stage_duration_seconds Duration of search server stages.\n"
+           << "# TYPE search_server_stage_duration_seconds histogram\n";
+    for (size_t stage = 0; stage < METRIC_STAGE_COUNT; ++stage) {
+        const HistogramSnapshot &durations = snapshot.stage_durations_ns[stage];
+        const std::string labels = "stage=\"" + std::string(STAGE_NAMES[stage]) + "\"";
+        const auto &bucket_counts = durations.GetBucketCounts();
+        size_t bucket = 0;
+        uint64_t cumulative_count = 0;
+        for (int bits = MIN_PROMETHEUS_BUCKET_BITS; bits <= MAX_PROMETHEUS_BUCKET_BITS;
+             bits += PROMETHEUS_BUCKET_STEP_BITS) {
+            const uint64_t bound = uint64_t{1} << bits;
+            for (; bucket < bucket_counts.size() && histogram_buckets::GetBucketUpperBound(bucket) < bound; ++bucket) {
+                cumulative_count += bucket_counts[bucket];
+            }
+            output << "search_server_stage_duration_seconds_bucket{" << labels << ",le=\""
+                   << static_cast<double>(bound) / NANOSECONDS_PER_SECOND << "\"} " << cumulative_count << '\n';
+        }
+        output << "search_server_stage_duration_seconds_bucket{" << labels << ",le=\"+Inf\"} "
+               << durations.GetTotalCount() << '\n'
+               << "search_server_stage_duration_seconds_sum{" << labels << "} "
+               << static_cast<double>(durations.GetSum()) / NANOSECONDS_PER_SECOND << '\n'
+               << "search_server_stage_duration_seconds_count{" << labels << "} " << durations.GetTotalCount()
+               << '\n';
+    }
+    for (size_t counter = 0; counter < METRIC_COUNTER_COUNT; ++counter) {
+        const std::string name = "search_server_" + std::string(COUNTER_NAMES[counter]) + "_total";
+        output << "# TYPE " << name << " counter\n" << name << ' ' << snapshot.counters[counter] << '\n';
+    }
+    output.precision(precision);
+}
+
+void WriteJson(std::ostream &output, const MetricsSnapshot &snapshot) {
+    output << "{\"stages\":{";
+    for (size_t stage = 0; stage < METRIC_STAGE_COUNT; ++stage) {
+        const HistogramSnapshot &durations = snapshot.stage_durations_ns[stage];
+        output << (stage == 0 ? "" : ",") << '"' << STAGE_NAMES[stage] << "\":{"
+               << "\"count\":" << durations.GetTotalCount()
+               << ",\"sum_ns\":" << durations.GetSum()
+               << ",\"max_ns\":" << durations.GetMaxValue()
+               << ",\"p50_ns\":" << durations.GetValueAtPercentile(50.0)
+               << ",\"p90_ns\":" << durations.GetValueAtPercentile(90.0)
+               << ",\"p99_ns\":" << durations.GetValueAtPercentile(99.0)
+               << ",\"p999_ns\":" << durations.GetValueAtPercentile(99.9) << '}';
+    }
+    output << "},\"counters\":{";
+    for (size_t counter = 0; counter < METRIC_COUNTER_COUNT; ++counter) {
+        output << (counter == 0 ? "" : ",") << '"' << COUNTER_NAMES[counter] << "\":" << snapshot.counters[counter];
+    }
+    output << "}}\n";
+}
+
+MetricsFileExporter::MetricsFileExporter(std::string path, MetricsFormat format, std::chrono::milliseconds period)
+        : path_(std::move(path)),
+          format_(format),
+          period_(period) {
+    thread_ = std::thread([this] {
+        std::unique_lock lock(mutex_);
+        while (!stop_requested_.wait_for(lock, period_, [this] { return is_stopping_; })) {
+            WriteNow();
+        }
+    });
+}
+
+MetricsFileExporter::~MetricsFileExporter() {
+    {
+        std::lock_guard guard(mutex_);
+        is_stopping_ = true;
+    }
+    stop_requested_.notify_one();
+    thread_.join();
+    WriteNow();
+}
+
+void MetricsFileExporter::WriteNow() const {
+    const std::string temporary_path = path_ + ".tmp";
+    {
+        std::ofstream output(temporary_path);
+        if (format_ == MetricsFormat::JSON) {
+            WriteJson(output, MetricsRegistry::Instance().GetSnapshot());
+        } else {
+            WritePrometheusText(output, MetricsRegistry::Instance().GetSnapshot());
+        }
+    }
+    std::rename(temporary_path.c_str(), path_.c_str());
+}
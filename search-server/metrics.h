@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "histogram.h"
+#include "log_duration.h"
+
+// Этапы, длительность которых собирается в наносекундах
+enum class MetricStage {
+    QUERY_PARSE,
+    QUERY_LOOKUP,
+    // Отбор документов предикатом идёт в том же проходе по словам, что и подсчёт релевантности
+    QUERY_SCORE,
+    QUERY_SORT,
+    QUERY_TOTAL,
+    ADD_DOCUMENT,
+    REMOVE_DOCUMENT,
+};
+
+enum class MetricCounter {
+    QUERIES,
+    // Запросы, оборванные по бюджету
+    PARTIAL_QUERIES,
+    ADDED_DOCUMENTS,
+    REMOVED_DOCUMENTS,
+};
+
+constexpr size_t METRIC_STAGE_COUNT = static_cast<size_t>(MetricStage::REMOVE_DOCUMENT) + 1;
+constexpr size_t METRIC_COUNTER_COUNT = static_cast<size_t>(MetricCounter::REMOVED_DOCUMENTS) + 1;
+
+std::string_view GetMetricStageName(MetricStage stage);
+
+std::string_view GetMetricCounterName(MetricCounter counter);
+
+struct MetricsSnapshot {
+    std::array<HistogramSnapshot, METRIC_STAGE_COUNT> stage_durations_ns;
+    std::array<uint64_t, METRIC_COUNTER_COUNT> counters{};
+
+    const HistogramSnapshot &GetStageDurations(MetricStage stage) const;
+
+    uint64_t GetCounter(MetricCounter counter) const;
+};
+
+// Метрики процесса. У каждого потока свой блок счётчиков и гистограмм, который пишет только он сам,
+// поэтому запись не требует ни блокировок, ни атомарных операций чтения-изменения-записи. Блоки
+// завершившихся потоков сохраняются, снимок складывает все блоки
+class MetricsRegistry {
+public:
+    static MetricsRegistry &Instance();
+
+    void RecordDuration(MetricStage stage, uint64_t nanoseconds);
+
+    void AddToCounter(MetricCounter counter, uint64_t value);
+
+    MetricsSnapshot GetSnapshot() const;
+
+private:
+    struct ThreadMetrics {
+        std::array<AtomicHistogram, METRIC_STAGE_COUNT> stage_durations_ns;
+        std::array<std::atomic<uint64_t>, METRIC_COUNTER_COUNT> counters{};
+    };
+
+    MetricsRegistry() = default;
+
+    ThreadMetrics &ForCurrentThread();
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadMetrics>> thread_metrics_;
+};
+
+// Замер нескольких этапов подряд: Lap записывает время с предыдущей отметки, а деструктор — общее время
+class MetricsStopwatch {
+public:
+    using Clock = LogDuration::Clock;
+
+    explicit MetricsStopwatch(MetricStage total_stage);
+
+    MetricsStopwatch(const MetricsStopwatch &) = delete;
+
+    MetricsStopwatch &operator=(const MetricsStopwatch &) = delete;
+
+    ~MetricsStopwatch();
+
+    void Lap(MetricStage stage);
+
+private:
+    const MetricStage total_stage_;
+    const Clock::time_point start_time_ = Clock::now();
+    Clock::time_point lap_start_time_ = start_time_;
+};
+
+// Формат text exposition Prometheus: гистограммы в секундах с границами-степенями двойки наносекунд
+void WritePrometheusText(std::ostream &output, const MetricsSnapshot &snapshot);
+
+// Для каждого этапа — число замеров, сумма, максимум и перцентили в наносекундах
+void WriteJson(std::ostream &output, const MetricsSnapshot &snapshot);
+
+enum class MetricsFormat {
+    PROMETHEUS_TEXT,
+    JSON,
+};
+
+// Раз в period записывает снимок MetricsRegistry в файл, последний раз — при разрушении. Файл
+// заменяется целиком через переименование, так что читатель не увидит его недописанным
+class MetricsFileExporter {
+public:
+    MetricsFileExporter(std::string path, MetricsFormat format, std::chrono::milliseconds period);
+
+    MetricsFileExporter(const MetricsFileExporter &) = delete;
+
+    MetricsFileExporter &operator=(const MetricsFileExporter &) = delete;
+
+    ~MetricsFileExporter();
+
+    void WriteNow() const;
+
+private:
+    const std::string path_;
+    const MetricsFormat format_;
+    const std::chrono::milliseconds period_;
+    std::mutex mutex_;
+    std::condition_variable stop_requested_;
+    bool is_stopping_ = false;
+    std::thread thread_;
+};
+
+// Без SEARCH_SERVER_METRICS замеры в горячем коде не компилируются вовсе
+#ifdef SEARCH_SERVER_METRICS
+#define METRICS_STOPWATCH(name, total_stage) MetricsStopwatch name(total_stage)
+#define METRICS_LAP(name, stage) (name).Lap(stage)
+#define METRICS_SCOPED_TIMER(stage) MetricsStopwatch PROFILE_CONCAT(metrics_timer_, __LINE__)(stage)
+#define METRICS_ADD(counter, value) MetricsRegistry::Instance().AddToCounter(counter, value)
+#else
+#define METRICS_STOPWATCH(name, total_stage) static_cast<void>(0)
+#define METRICS_LAP(name, stage) static_cast<void>(0)
+#define METRICS_SCOPED_TIMER(stage) static_cast<void>(0)
+#define METRICS_ADD(counter, value) static_cast<void>(0)
+#endif
@@ -0,0 +1,115 @@
+#include "positional_index.h"
+
+#include <algorithm>
+
+#include "varint.h"
+
+namespace {
+
+std::vector<uint32_t> DecodePositions(const std::vector<uint8_t> &encoded) {
+    std::vector<uint32_t> positions;
+    const uint8_t *data = encoded.data();
+    const uint8_t *end = data + encoded.size();
+    uint32_t position = 0;
+    while (data != end) {
+        position += ReadVarint(data);
+        positions.push_back(position);
+    }
+    return positions;
+}
+
+}  // namespace
+
+void PositionalIndex::AddDocument(int document_id, const std::vector<std::string_view> &words) {
+    std::map<std::string_view, uint32_t> last_positions;
+    for (uint32_t position = 0; position < words.size(); ++position) {
+        auto &encoded = word_to_document_positions_[words[position]][document_id];
+        const auto [last_it, is_first] = last_positions.emplace(words[position], position);
+        AppendVarint(is_first ? position : position - last_it->second, encoded);
+        last_it->second = position;
+    }
+}
+
+void PositionalIndex::RemoveDocument(int document_id, const std::map<std::string_view, double> &document_word_freqs) {
+    for (const auto &[word, _]: document_word_freqs) {
+        RemoveWord(document_id, word);
+    }
+}
+
+void PositionalIndex::RemoveWord(int document_id, std::string_view word) {
+    const auto word_it = word_to_document_positions_.find(word);
+    if (word_it == word_to_document_positions_.end()) {
+        return;
+    }
+    word_it->second.erase(document_id);
+    if (word_it->second.empty()) {
+        word_to_document_positions_.erase(word_it);
+    }
+}
+
+std::vector<uint32_t> PositionalIndex::GetPositions(std::string_view word, int document_id) const {
+    const auto word_it = word_to_document_positions_.find(word);
+    if (word_it == word_to_document_positions_.end()) {
+        return {};
+    }
+    const auto document_it = word_it->second.find(document_id);
+    if (document_it == word_it->second.end()) {
+        return {};
+    }
+    return DecodePositions(document_it->second);
+}
+
+bool PositionalIndex::ContainsPhrase(int document_id, const std::vector<std::string_view> &phrase, int slop) const {
+    if (phrase.empty()) {
+        return true;
+    }
+    std::vector<std::vector<uint32_t>> word_positions;
+    word_positions.reserve(phrase.size());
+    for (const std::string_view word: phrase) {
+        word_positions.push_back(GetPositions(word, document_id));
+        if (word_positions.back().empty()) {
+            return false;
+        }
+    }
+
+    const uint32_t max_span = static_cast<uint32_t>(phrase.size() - 1 + slop);
+    std::vector<size_t> cursors(phrase.size(), 0);
+    // Для каждой позиции первого слова жадно берутся ближайшие следующие позиции остальных слов:
+    // так получается наименьший возможный охват фразы с этого места. Курсоры только растут
+    for (const uint32_t first_position: word_positions.front()) {
+        uint32_t previous_position = first_position;
+        bool is_complete = true;
+        for (size_t i = 1; i < phrase.size(); ++i) {
+            const auto &positions = word_positions[i];
+            while (cursors[i] < positions.size() && positions[cursors[i]] <= previous_position) {
+                ++cursors[i];
+            }
+            if (cursors[i] == positions.size()) {
+                return false;
+            }
+            previous_position = positions[cursors[i]];
+            if (previous_position - first_position > max_span) {
+                is_complete = false;
+                break;
+            }
+        }
+        if (is_complete) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t PositionalIndex::GetMemoryUsage() const {
+    size_t memory = 0;
+    for (const auto &[word, document_positions]: word_to_document_positions_) {
+        for (const auto &[document_id, encoded]: document_positions) {
+            memory += encoded.capacity() + sizeof(document_id) + sizeof(encoded);
+        }
+    }
+    return memory;
+}
+
+void PositionalIndex::Clear() {
+    word_to_document_positions_.clear();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string_view>
+#include <vector>
+
+// Позиции слов в документах. Позиция — номер слова среди слов документа без стоп-слов.
+// Позиции одного слова в документе хранятся разностями от предыдущей в кодировке varint
+class PositionalIndex {
+public:
+    // Ключи индекса ссылаются на переданные строки, они должны жить не меньше индекса
+    void AddDocument(int document_id, const std::vector<std::string_view> &words);
+
+    // document_word_freqs — слова удаляемого документа
+    void RemoveDocument(int document_id, const std::map<std::string_view, double> &document_word_freqs);
+
+    std::vector<uint32_t> GetPositions(std::string_view word, int document_id) const;
+
+    // Слова фразы идут в документе в заданном порядке, и между первым и последним словом
+    // не больше slop лишних слов. При slop == 0 слова должны стоять подряд
+    bool ContainsPhrase(int document_id, const std::vector<std::string_view> &phrase, int slop) const;
+
+    size_t GetMemoryUsage() const;
+
+    void Clear();
+
+private:
+    void RemoveWord(int document_id, std::string_view word);
+
+    std::map<std::string_view, std::map<int, std::vector<uint8_t>>> word_to_document_positions_;
+};
@@ -0,0 +1,186 @@
+#include "posting_list.h"
+
+#include <algorithm>
+
+PostingList::PostingList(const PostingList &other)
+        : document_freqs_(other.document_freqs_),
+          compressed_postings_(other.compressed_postings_
+                               ? std::make_unique<CompressedPostingList>(*other.compressed_postings_) : nullptr),
+          quantized_postings_(other.quantized_postings_
+                              ? std::make_unique<QuantizedPostingList>(*other.quantized_postings_) : nullptr) {
+}
+
+PostingList &PostingList::operator=(const PostingList &other) {
+    if (this != &other) {
+        *this = PostingList(other);
+    }
+    return *this;
+}
+
+void PostingList::Add(int document_id, double term_freq) {
+    if (compressed_postings_) {
+        compressed_postings_->Add(document_id, term_freq);
+    } else {
+        document_freqs_.emplace(document_id, term_freq);
+    }
+}
+
+void PostingList::AddQuantized(int document_id, uint32_t slot, double term_freq) {
+    quantized_postings_->Add(document_id, slot, term_freq);
+}
+
+void PostingList::Remove(int document_id) {
+    if (quantized_postings_) {
+        quantized_postings_->Remove(document_id);
+    } else if (compressed_postings_) {
+        compressed_postings_->Remove(document_id);
+    } else {
+        document_freqs_.erase(document_id);
+    }
+}
+
+bool PostingList::Contains(int document_id) const {
+    if (quantized_postings_ || compressed_postings_) {
+        return FindTermFreq(document_id).has_value();
+    }
+    return document_freqs_.count(document_id) > 0;
+}
+
+std::optional<double> PostingList::FindTermFreq(int document_id) const {
+    if (quantized_postings_) {
+        return quantized_postings_->FindTermFreq(document_id);
+    }
+    if (compressed_postings_) {
+        return compressed_postings_->FindTermFreq(document_id);
+    }
+    const auto document_it = document_freqs_.find(document_id);
+    if (document_it == document_freqs_.end()) {
+        return std::nullopt;
+    }
+    return document_it->second;
+}
+
+size_t PostingList::GetSize() const {
+    if (quantized_postings_) {
+        return quantized_postings_->GetSize();
+    }
+    return compressed_postings_ ? compressed_postings_->GetSize() : document_freqs_.size();
+}
+
+bool PostingList::IsEmpty() const {
+    return GetSize() == 0;
+}
+
+void PostingList::Compress() {
+    if (compressed_postings_ || quantized_postings_) {
+        return;
+    }
+    compressed_postings_ = std::make_unique<CompressedPostingList>(document_freqs_);
+    document_freqs_.clear();
+}
+
+bool PostingList::IsCompressed() const {
+    return compressed_postings_ != nullptr;
+}
+
+void PostingList::Quantize(const QuantizedIndex &index) {
+    if (quantized_postings_) {
+        return;
+    }
+    double max_term_freq = 0.0;
+    ForEach([&max_term_freq](int, double term_freq) {
+        max_term_freq = std::max(max_term_freq, term_freq);
+        return true;
+    });
+    auto quantized_postings = std::make_unique<QuantizedPostingList>(max_term_freq);
+    ForEach([&index, &quantized_postings](int document_id, double term_freq) {
+        quantized_postings->Add(document_id, index.GetSlot(document_id), term_freq);
+        return true;
+    });
+    quantized_postings_ = std::move(quantized_postings);
+    document_freqs_.clear();
+    compressed_postings_.reset();
+}
+
+const QuantizedPostingList *PostingList::GetQuantized() const {
+    return quantized_postings_.get();
+}
+
+size_t PostingList::GetMemoryUsage() const {
+    if (quantized_postings_) {
+        return sizeof(*this) + quantized_postings_->GetMemoryUsage();
+    }
+    if (compressed_postings_) {
+        return sizeof(*this) + compressed_postings_->GetMemoryUsage();
+    }
+    // Узел дерева: три указателя и цвет помимо значения
+    constexpr size_t node_size = 4 * sizeof(void *) + sizeof(std::pair<const int, double>);
+    return sizeof(*this) + document_freqs_.size() * node_size;
+}
+
+PostingList::Iterator PostingList::GetIterator() const {
+    if (quantized_postings_) {
+        return Iterator(*quantized_postings_);
+    }
+    return compressed_postings_ ? Iterator(*compressed_postings_) : Iterator(document_freqs_);
+}
+
+PostingList::Iterator::Iterator(const std::map<int, double> &document_freqs)
+        : document_freqs_(&document_freqs), position_(document_freqs.begin()) {
+}
+
+PostingList::Iterator::Iterator(const CompressedPostingList &compressed_postings)
+        : compressed_position_(compressed_postings.GetIterator()) {
+}
+
+PostingList::Iterator::Iterator(const QuantizedPostingList &quantized_postings)
+        : quantized_position_(quantized_postings.GetIterator()) {
+}
+
+int PostingList::Iterator::GetDocument() const {
+    if (quantized_position_) {
+        return quantized_position_->GetDocument();
+    }
+    if (compressed_position_) {
+        return compressed_position_->GetDocument();
+    }
+    return position_ == document_freqs_->end() ? END : position_->first;
+}
+
+double PostingList::Iterator::GetTermFreq() const {
+    if (quantized_position_) {
+        return quantized_position_->GetTermFreq();
+    }
+    return compressed_position_ ? compressed_position_->GetTermFreq() : position_->second;
+}
+
+void PostingList::Iterator::Next() {
+    if (quantized_position_) {
+        quantized_position_->Next();
+    } else if (compressed_position_) {
+        compressed_position_->Next();
+    } else {
+        ++position_;
+    }
+}
+
+void PostingList::Iterator::Advance(int target) {
+    if (quantized_position_) {
+        quantized_position_->Advance(target);
+        return;
+    }
+    if (compressed_position_) {
+        compressed_position_->Advance(target);
+        return;
+    }
+    // Близкий документ дешевле найти несколькими шагами, чем спуском от корня дерева
+    for (int step = 0; step < 4; ++step) {
+        if (position_ == document_freqs_->end() || position_->first >= target) {
+            return;
+        }
+        ++position_;
+    }
+    if (position_ != document_freqs_->end() && position_->first < target) {
+        position_ = document_freqs_->lower_bound(target);
+    }
+}
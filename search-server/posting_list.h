@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+
+#include "compressed_postings.h"
+#include "quantized_index.h"
+
+// Документы слова с их TF по возрастанию id. По умолчанию хранятся в std::map, после Compress —
+// только в CompressedPostingList, после Quantize — только в QuantizedPostingList, где рядом с точными TF
+// лежат квантованные вклады. Поэтому другое представление действительно уменьшает занимаемую индексом память
+class PostingList {
+public:
+    static constexpr int END = CompressedPostingList::END;
+
+    PostingList() = default;
+
+    PostingList(const PostingList &other);
+
+    PostingList(PostingList &&other) = default;
+
+    PostingList &operator=(const PostingList &other);
+
+    PostingList &operator=(PostingList &&other) = default;
+
+    // Документа ещё не должно быть в списке. В квантованный список документы добавляются через AddQuantized
+    void Add(int document_id, double term_freq);
+
+    // slot — слот документа в QuantizedIndex, по которому квантованный список накапливает релевантность
+    void AddQuantized(int document_id, uint32_t slot, double term_freq);
+
+    // Документ должен быть в списке
+    void Remove(int document_id);
+
+    bool Contains(int document_id) const;
+
+    std::optional<double> FindTermFreq(int document_id) const;
+
+    size_t GetSize() const;
+
+    bool IsEmpty() const;
+
+    // Переносит документы в сжатый список. Квантованный список не меняется
+    void Compress();
+
+    bool IsCompressed() const;
+
+    // Переносит документы в квантованный список, слоты документов берутся из index
+    void Quantize(const QuantizedIndex &index);
+
+    // nullptr, если список не квантован
+    const QuantizedPostingList *GetQuantized() const;
+
+    size_t GetMemoryUsage() const;
+
+    // Передаёт callback документы и TF по возрастанию id. Обход прекращается, если callback вернул false
+    template<typename Callback>
+    void ForEach(Callback callback) const;
+
+    class Iterator {
+    public:
+        // После последнего документа возвращает END
+        int GetDocument() const;
+
+        double GetTermFreq() const;
+
+        void Next();
+
+        // Переходит к первому документу не меньше target
+        void Advance(int target);
+
+    private:
+        friend class PostingList;
+
+        explicit Iterator(const std::map<int, double> &document_freqs);
+
+        explicit Iterator(const CompressedPostingList &compressed_postings);
+
+        explicit Iterator(const QuantizedPostingList &quantized_postings);
+
+        const std::map<int, double> *document_freqs_ = nullptr;
+        std::map<int, double>::const_iterator position_;
+        std::optional<CompressedPostingList::Iterator> compressed_position_;
+        std::optional<QuantizedPostingList::Iterator> quantized_position_;
+    };
+
+    Iterator GetIterator() const;
+
+private:
+    std::map<int, double> document_freqs_;
+    std::unique_ptr<CompressedPostingList> compressed_postings_;
+    std::unique_ptr<QuantizedPostingList> quantized_postings_;
+};
+
+template<typename Callback>
+void PostingList::ForEach(Callback callback) const {
+    if (quantized_postings_) {
+        for (auto posting = quantized_postings_->GetIterator(); posting.GetDocument() != END; posting.Next()) {
+            if (!callback(posting.GetDocument(), posting.GetTermFreq())) {
+                return;
+            }
+        }
+        return;
+    }
+    if (compressed_postings_) {
+        for (auto posting = compressed_postings_->GetIterator(); posting.GetDocument() != END; posting.Next()) {
+            if (!callback(posting.GetDocument(), posting.GetTermFreq())) {
+                return;
+            }
+        }
+        return;
+    }
+    for (const auto &[document_id, term_freq]: document_freqs_) {
+        if (!callback(document_id, term_freq)) {
+            return;
+        }
+    }
+}
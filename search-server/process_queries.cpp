@@ -3,13 +3,17 @@
 std::vector<std::vector<Document>> ProcessQueries(
         const SearchServer &search_server,
         const std::vector<std::string> &queries) {
+    TRACE_SCOPE("ProcessQueries");
 
     std::vector<std::vector<Document>> res(queries.size());
     std::transform(
             std::execution::par,
             queries.begin(), queries.end(),
             res.begin(),
-            [&search_server](const auto query) { return search_server.FindTopDocuments(query); }
+            [&search_server](const auto query) {
+                TRACE_SCOPE("ProcessQueries query");
+                return search_server.FindTopDocuments(query);
+            }
     );
     return res;
 }
@@ -0,0 +1,216 @@
+#include "quantized_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd_kernels.h"
+
+QuantizedPostingList::QuantizedPostingList(double max_term_freq)
+        : scale_(std::min(1.0, 2.0 * max_term_freq) / MAX_IMPACT) {
+}
+
+uint16_t QuantizedPostingList::Quantize(double term_freq, double scale) {
+    // Документ слова не должен получить нулевой вклад и выпасть из выдачи
+    const double impact = std::round(term_freq / scale);
+    return static_cast<uint16_t>(std::clamp(impact, 1.0, static_cast<double>(MAX_IMPACT)));
+}
+
+void QuantizedPostingList::Add(int document_id, uint32_t slot, double term_freq) {
+    if (term_freq > scale_ * MAX_IMPACT) {
+        Rescale(term_freq);
+    }
+    const uint16_t impact = Quantize(term_freq, scale_);
+    if (documents_.empty() || document_id > documents_.back()) {
+        documents_.push_back(document_id);
+        slots_.push_back(slot);
+        impacts_.push_back(impact);
+        term_freqs_.push_back(term_freq);
+        return;
+    }
+    const size_t position = std::lower_bound(documents_.begin(), documents_.end(), document_id) - documents_.begin();
+    if (documents_[position] == document_id) {
+        // Документ снова добавлен до перепаковки и занимает своё прежнее место
+        slots_[position] = slot;
+        impacts_[position] = impact;
+        term_freqs_[position] = term_freq;
+        --removed_count_;
+        return;
+    }
+    documents_.insert(documents_.begin() + position, document_id);
+    slots_.insert(slots_.begin() + position, slot);
+    impacts_.insert(impacts_.begin() + position, impact);
+    term_freqs_.insert(term_freqs_.begin() + position, term_freq);
+}
+
+void QuantizedPostingList::Remove(int document_id) {
+    const size_t position = std::lower_bound(documents_.begin(), documents_.end(), document_id) - documents_.begin();
+    slots_[position] = QuantizedIndex::TRASH_SLOT;
+    impacts_[position] = 0;
+    ++removed_count_;
+    CompactIfNeeded();
+}
+
+void QuantizedPostingList::CompactIfNeeded() {
+    // Перепаковка стоит O(длины списка), а до неё накапливается не меньше четверти длины удалений
+    if (removed_count_ < std::max<size_t>(16, documents_.size() / 4)) {
+        return;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < documents_.size(); ++i) {
+        if (impacts_[i] != 0) {
+            documents_[kept] = documents_[i];
+            slots_[kept] = slots_[i];
+            impacts_[kept] = impacts_[i];
+            term_freqs_[kept] = term_freqs_[i];
+            ++kept;
+        }
+    }
+    documents_.resize(kept);
+    slots_.resize(kept);
+    impacts_.resize(kept);
+    term_freqs_.resize(kept);
+    removed_count_ = 0;
+}
+
+void QuantizedPostingList::Rescale(double max_term_freq) {
+    // Вклады пересчитываются из точных TF, поэтому погрешность не накапливается от смены к смене
+    const double scale = std::min(1.0, 2.0 * max_term_freq) / MAX_IMPACT;
+    for (size_t i = 0; i < impacts_.size(); ++i) {
+        if (impacts_[i] != 0) {
+            impacts_[i] = Quantize(term_freqs_[i], scale);
+        }
+    }
+    scale_ = scale;
+}
+
+std::optional<double> QuantizedPostingList::FindTermFreq(int document_id) const {
+    const auto document_it = std::lower_bound(documents_.begin(), documents_.end(), document_id);
+    if (document_it == documents_.end() || *document_it != document_id) {
+        return std::nullopt;
+    }
+    const size_t position = document_it - documents_.begin();
+    if (impacts_[position] == 0) {
+        return std::nullopt;
+    }
+    return term_freqs_[position];
+}
+
+size_t QuantizedPostingList::GetSize() const {
+    return documents_.size() - removed_count_;
+}
+
+size_t QuantizedPostingList::GetMemoryUsage() const {
+    return sizeof(*this) + documents_.capacity() * sizeof(int) + slots_.capacity() * sizeof(uint32_t)
+           + impacts_.capacity() * sizeof(uint16_t) + term_freqs_.capacity() * sizeof(double);
+}
+
+void QuantizedPostingList::Accumulate(float weight, std::vector<float> &scores) const {
+    ScatterAccumulate(slots_.data(), impacts_.data(), slots_.size(), static_cast<float>(scale_) * weight,
+                      scores.data());
+}
+
+void QuantizedPostingList::Exclude(std::vector<float> &scores) const {
+    ScatterAssign(slots_.data(), slots_.size(), -std::numeric_limits<float>::infinity(), scores.data());
+}
+
+QuantizedPostingList::Iterator QuantizedPostingList::GetIterator() const {
+    return Iterator(*this);
+}
+
+QuantizedPostingList::Iterator::Iterator(const QuantizedPostingList &list)
+        : list_(&list) {
+    SkipRemoved();
+}
+
+void QuantizedPostingList::Iterator::SkipRemoved() {
+    while (position_ < list_->documents_.size() && list_->impacts_[position_] == 0) {
+        ++position_;
+    }
+}
+
+int QuantizedPostingList::Iterator::GetDocument() const {
+    return position_ < list_->documents_.size() ? list_->documents_[position_] : END;
+}
+
+double QuantizedPostingList::Iterator::GetTermFreq() const {
+    return list_->term_freqs_[position_];
+}
+
+void QuantizedPostingList::Iterator::Next() {
+    ++position_;
+    SkipRemoved();
+}
+
+void QuantizedPostingList::Iterator::Advance(int target) {
+    if (GetDocument() >= target) {
+        return;
+    }
+    const auto &documents = list_->documents_;
+    position_ = std::lower_bound(documents.begin() + position_, documents.end(), target) - documents.begin();
+    SkipRemoved();
+}
+
+QuantizedIndex::QuantizedIndex() {
+    Clear();
+}
+
+uint32_t QuantizedIndex::AddDocument(int document_id, DocumentStatus status) {
+    const auto slot_it = document_to_slot_.find(document_id);
+    if (slot_it != document_to_slot_.end()) {
+        return slot_it->second;
+    }
+    uint32_t slot;
+    if (free_slots_.empty()) {
+        slot = static_cast<uint32_t>(slot_to_document_.size());
+        slot_to_document_.push_back(document_id);
+        slot_statuses_.push_back(static_cast<uint8_t>(status));
+    } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        slot_to_document_[slot] = document_id;
+        slot_statuses_[slot] = static_cast<uint8_t>(status);
+    }
+    document_to_slot_.emplace(document_id, slot);
+    return slot;
+}
+
+void QuantizedIndex::RemoveDocument(int document_id) {
+    const auto slot_it = document_to_slot_.find(document_id);
+    if (slot_it == document_to_slot_.end()) {
+        return;
+    }
+    const uint32_t slot = slot_it->second;
+    slot_to_document_[slot] = -1;
+    slot_statuses_[slot] = FREE_SLOT_STATUS;
+    free_slots_.push_back(slot);
+    document_to_slot_.erase(slot_it);
+}
+
+uint32_t QuantizedIndex::GetSlot(int document_id) const {
+    return document_to_slot_.at(document_id);
+}
+
+void QuantizedIndex::MaskByStatus(DocumentStatus status, std::vector<float> &scores) const {
+    ::MaskByStatus(slot_statuses_.data(), static_cast<uint8_t>(status), slot_statuses_.size(), scores.data());
+}
+
+size_t QuantizedIndex::GetSlotCount() const {
+    return slot_to_document_.size();
+}
+
+int QuantizedIndex::GetDocumentId(size_t slot) const {
+    return slot_to_document_[slot];
+}
+
+size_t QuantizedIndex::GetMemoryUsage() const {
+    return slot_to_document_.capacity() * sizeof(int) + slot_statuses_.capacity()
+           + free_slots_.capacity() * sizeof(uint32_t)
+           + document_to_slot_.size() * (sizeof(std::pair<const int, uint32_t>) + 4 * sizeof(void *));
+}
+
+void QuantizedIndex::Clear() {
+    document_to_slot_.clear();
+    slot_to_document_.assign(1, -1);
+    slot_statuses_.assign(1, FREE_SLOT_STATUS);
+    free_slots_.clear();
+}
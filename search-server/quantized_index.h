@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "document.h"
+
+// Документы слова по возрастанию id в параллельных массивах вместо узлов std::map<int, double>: точный TF,
+// слот документа в QuantizedIndex и вклад — TF, округлённый до 16 бит с общим для слова шагом
+// min(1, 2 * наибольший TF) / MAX_IMPACT. Вклады читают только ядра Accumulate и Exclude, остальные
+// методы отдают точный TF. Удалённый документ до перепаковки остаётся на месте с нулевым вкладом в мусорном слоте
+class QuantizedPostingList {
+public:
+    static constexpr int END = std::numeric_limits<int>::max();
+    static constexpr uint32_t MAX_IMPACT = 0xFFFF;
+
+    // Масштаб выбирается по наибольшему ожидаемому TF с запасом вдвое
+    explicit QuantizedPostingList(double max_term_freq = 0.0);
+
+    // Документа ещё не должно быть в списке. TF больше допустимого шагом пересчитывает вклады
+    // всех документов слова из их точных TF
+    void Add(int document_id, uint32_t slot, double term_freq);
+
+    // Документ должен быть в списке
+    void Remove(int document_id);
+
+    std::optional<double> FindTermFreq(int document_id) const;
+
+    size_t GetSize() const;
+
+    size_t GetMemoryUsage() const;
+
+    // Прибавляет к scores[slot] приближённое TF * weight каждого документа слова: TF отличается от точного
+    // не больше чем на половину шага, а TF меньше половины шага поднимается до одного шага.
+    // Размер scores должен быть не меньше QuantizedIndex::GetSlotCount()
+    void Accumulate(float weight, std::vector<float> &scores) const;
+
+    // Ставит -inf в scores документов слова
+    void Exclude(std::vector<float> &scores) const;
+
+    class Iterator {
+    public:
+        explicit Iterator(const QuantizedPostingList &list);
+
+        // После последнего документа возвращает END
+        int GetDocument() const;
+
+        double GetTermFreq() const;
+
+        void Next();
+
+        // Переходит к первому документу не меньше target
+        void Advance(int target);
+
+    private:
+        void SkipRemoved();
+
+        const QuantizedPostingList *list_;
+        size_t position_ = 0;
+    };
+
+    Iterator GetIterator() const;
+
+private:
+    static uint16_t Quantize(double term_freq, double scale);
+
+    void Rescale(double max_term_freq);
+
+    void CompactIfNeeded();
+
+    std::vector<int> documents_;
+    std::vector<uint32_t> slots_;
+    // У удалённых документов 0: живой документ всегда получает ненулевой вклад
+    std::vector<uint16_t> impacts_;
+    std::vector<double> term_freqs_;
+    // Шаг квантования: вклад равен round(TF / scale)
+    double scale_;
+    size_t removed_count_ = 0;
+};
+
+// Плотные номера (слоты) документов для квантованных списков и статусы документов по слотам.
+// Релевантность накапливается во float по слотам ядрами из simd_kernels.h
+class QuantizedIndex {
+public:
+    // Слот, куда квантованные списки отправляют удалённые документы. Он никогда не достаётся документу,
+    // его оценка не имеет смысла, поэтому повторы этого слота в списке ядрам не мешают
+    static constexpr uint32_t TRASH_SLOT = 0;
+
+    QuantizedIndex();
+
+    // Заводит слот для документа, документ должен быть добавлен до своих слов
+    uint32_t AddDocument(int document_id, DocumentStatus status);
+
+    // Документ к этому времени должен быть удалён из всех квантованных списков
+    void RemoveDocument(int document_id);
+
+    uint32_t GetSlot(int document_id) const;
+
+    // Ставит -inf в scores документов с другим статусом и свободных слотов
+    void MaskByStatus(DocumentStatus status, std::vector<float> &scores) const;
+
+    size_t GetSlotCount() const;
+
+    // Для свободного слота возвращает -1
+    int GetDocumentId(size_t slot) const;
+
+    size_t GetMemoryUsage() const;
+
+    void Clear();
+
+private:
+    static constexpr uint8_t FREE_SLOT_STATUS = 0xFF;
+
+    std::map<int, uint32_t> document_to_slot_;
+    std::vector<int> slot_to_document_;
+    // Статусы документов по слотам, у свободного слота FREE_SLOT_STATUS
+    std::vector<uint8_t> slot_statuses_;
+    std::vector<uint32_t> free_slots_;
+};
@@ -0,0 +1,209 @@
+#include "query_analytics.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "term_set_fingerprint.h"
+
+namespace {
+
+std::vector<QueryFrequency> GetTopQueries(const std::map<std::string, uint64_t> &query_to_count, size_t top_count) {
+    std::vector<QueryFrequency> top_queries;
+    top_queries.reserve(query_to_count.size());
+    for (const auto &[query, count]: query_to_count) {
+        top_queries.push_back({query, count});
+    }
+    std::sort(top_queries.begin(), top_queries.end(), [](const QueryFrequency &lhs, const QueryFrequency &rhs) {
+        return lhs.count > rhs.count || (lhs.count == rhs.count && lhs.query < rhs.query);
+    });
+    if (top_queries.size() > top_count) {
+        top_queries.resize(top_count);
+    }
+    return top_queries;
+}
+
+void AddCounts(const std::map<std::string, uint64_t> &from, std::map<std::string, uint64_t> &to) {
+    for (const auto &[query, count]: from) {
+        to[query] += count;
+    }
+}
+
+}  // namespace
+
+void HeavyHitters::Add(std::string_view query) {
+    query = query.substr(0, MAX_QUERY_LENGTH);
+    const uint64_t hash = HashWord(query, 0);
+    const uint64_t count = IncrementSketch(hash);
+
+    Candidate *rarest = nullptr;
+    uint64_t rarest_count = count;
+    for (Candidate &candidate: candidates_) {
+        const uint64_t candidate_count = candidate.count.load(std::memory_order_relaxed);
+        if (candidate.hash.load(std::memory_order_relaxed) == hash && candidate_count != 0) {
+            if (candidate_count < count) {
+                candidate.count.store(count, std::memory_order_relaxed);
+            }
+            return;
+        }
+        if (candidate_count < rarest_count) {
+            rarest = &candidate;
+            rarest_count = candidate_count;
+        }
+    }
+    if (rarest != nullptr) {
+        Replace(*rarest, query, hash, count);
+    }
+}
+
+void HeavyHitters::Clear() {
+    for (auto &counter: sketch_) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (Candidate &candidate: candidates_) {
+        candidate.count.store(0, std::memory_order_relaxed);
+        candidate.hash.store(0, std::memory_order_relaxed);
+    }
+}
+
+void HeavyHitters::Collect(std::map<std::string, uint64_t> &query_to_count) const {
+    // Один запрос мог попасть в две записи при гонке потоков, берётся большая оценка
+    std::map<std::string, uint64_t> collected;
+    for (const Candidate &candidate: candidates_) {
+        const uint32_t version = candidate.version.load(std::memory_order_acquire);
+        if (version % 2 != 0) {
+            continue;
+        }
+        const uint64_t count = candidate.count.load(std::memory_order_relaxed);
+        const size_t length = std::min<size_t>(candidate.length.load(std::memory_order_relaxed), MAX_QUERY_LENGTH);
+        std::array<uint64_t, TEXT_WORDS> text{};
+        for (size_t i = 0; i < TEXT_WORDS; ++i) {
+            text[i] = candidate.text[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (count == 0 || candidate.version.load(std::memory_order_relaxed) != version) {
+            continue;
+        }
+        std::string query(length, '\0');
+        std::memcpy(query.data(), text.data(), length);
+        uint64_t &collected_count = collected[std::move(query)];
+        collected_count = std::max(collected_count, count);
+    }
+    AddCounts(collected, query_to_count);
+}
+
+uint64_t HeavyHitters::IncrementSketch(uint64_t hash) {
+    // Строки sketch индексируются хешами h1 + i * h2 (Kirsch–Mitzenmacher)
+    const uint64_t step = MixBits(hash) | 1u;
+    uint64_t count = UINT64_MAX;
+    for (size_t row = 0; row < SKETCH_DEPTH; ++row) {
+        const size_t column = (hash + row * step) % SKETCH_WIDTH;
+        const uint32_t row_count = sketch_[row * SKETCH_WIDTH + column].fetch_add(1, std::memory_order_relaxed) + 1;
+        count = std::min<uint64_t>(count, row_count);
+    }
+    return count;
+}
+
+void HeavyHitters::Replace(Candidate &candidate, std::string_view query, uint64_t hash, uint64_t count) {
+    uint32_t version = candidate.version.load(std::memory_order_relaxed);
+    if (version % 2 != 0
+        || !candidate.version.compare_exchange_strong(version, version + 1, std::memory_order_acquire)) {
+        return;
+    }
+    std::array<uint64_t, TEXT_WORDS> text{};
+    std::memcpy(text.data(), query.data(), query.size());
+    for (size_t i = 0; i < TEXT_WORDS; ++i) {
+        candidate.text[i].store(text[i], std::memory_order_relaxed);
+    }
+    candidate.length.store(static_cast<uint32_t>(query.size()), std::memory_order_relaxed);
+    candidate.hash.store(hash, std::memory_order_relaxed);
+    candidate.count.store(count, std::memory_order_relaxed);
+    candidate.version.store(version + 2, std::memory_order_release);
+}
+
+QueryAnalytics::QueryAnalytics(Clock::duration window_duration, size_t window_count)
+        : start_(Clock::now()),
+          window_duration_(std::max(window_duration, Clock::duration(1))),
+          window_count_(std::max<size_t>(window_count, 1)),
+          windows_(std::make_unique<Window[]>(window_count_)) {
+}
+
+void QueryAnalytics::RecordQuery(std::string_view raw_query, size_t result_count, Clock::duration latency,
+                                 Clock::time_point time) {
+    Window *window = AcquireWindow(GetWindowIndex(time));
+    if (window == nullptr) {
+        dropped_queries_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    window->queries.fetch_add(1, std::memory_order_relaxed);
+    window->latency_ns.Record(static_cast<uint64_t>(
+            std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(), 0)));
+    window->result_counts.Record(result_count);
+    window->top_queries.Add(raw_query);
+    if (result_count == 0) {
+        window->zero_result_queries.fetch_add(1, std::memory_order_relaxed);
+        window->top_zero_result_queries.Add(raw_query);
+    }
+}
+
+QueryAnalyticsReport QueryAnalytics::GetReport(Clock::duration period, Clock::time_point now,
+                                               size_t top_count) const {
+    const int64_t last_index = GetWindowIndex(now);
+    const int64_t first_index = GetWindowIndex(now - period);
+    QueryAnalyticsReport report;
+    std::map<std::string, uint64_t> query_to_count;
+    std::map<std::string, uint64_t> zero_result_query_to_count;
+    for (size_t i = 0; i < window_count_; ++i) {
+        const Window &window = windows_[i];
+        const int64_t index = window.index.load(std::memory_order_acquire);
+        if (index < first_index || index > last_index) {
+            continue;
+        }
+        report.queries += window.queries.load(std::memory_order_relaxed);
+        report.zero_result_queries += window.zero_result_queries.load(std::memory_order_relaxed);
+        report.latency_ns.Merge(window.latency_ns.GetSnapshot());
+        report.result_counts.Merge(window.result_counts.GetSnapshot());
+        window.top_queries.Collect(query_to_count);
+        window.top_zero_result_queries.Collect(zero_result_query_to_count);
+    }
+    report.top_queries = GetTopQueries(query_to_count, top_count);
+    report.top_zero_result_queries = GetTopQueries(zero_result_query_to_count, top_count);
+    return report;
+}
+
+uint64_t QueryAnalytics::GetDroppedQueries() const {
+    return dropped_queries_.load(std::memory_order_relaxed);
+}
+
+QueryAnalytics::Clock::duration QueryAnalytics::GetWindowDuration() const {
+    return window_duration_;
+}
+
+QueryAnalytics::Window *QueryAnalytics::AcquireWindow(int64_t window_index) {
+    Window &window = windows_[static_cast<size_t>(window_index) % window_count_];
+    int64_t current_index = window.index.load(std::memory_order_acquire);
+    if (current_index == window_index) {
+        return &window;
+    }
+    // Окно уже занято более поздним временем или его очищает другой поток
+    if (current_index > window_index || current_index == CLEARING_WINDOW) {
+        return nullptr;
+    }
+    if (!window.index.compare_exchange_strong(current_index, CLEARING_WINDOW, std::memory_order_acquire)) {
+        return current_index == window_index ? &window : nullptr;
+    }
+    window.queries.store(0, std::memory_order_relaxed);
+    window.zero_result_queries.store(0, std::memory_order_relaxed);
+    window.latency_ns.Clear();
+    window.result_counts.Clear();
+    window.top_queries.Clear();
+    window.top_zero_result_queries.Clear();
+    window.index.store(window_index, std::memory_order_release);
+    return &window;
+}
+
+int64_t QueryAnalytics::GetWindowIndex(Clock::time_point time) const {
+    if (time <= start_) {
+        return 0;
+    }
+    return (time - start_) / window_duration_;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "histogram.h"
+
+struct QueryFrequency {
+    std::string query;
+    uint64_t count = 0;
+};
+
+struct QueryAnalyticsReport {
+    uint64_t queries = 0;
+    uint64_t zero_result_queries = 0;
+    HistogramSnapshot latency_ns;
+    HistogramSnapshot result_counts;
+    // По убыванию частоты; частоты — оценки сверху
+    std::vector<QueryFrequency> top_queries;
+    std::vector<QueryFrequency> top_zero_result_queries;
+};
+
+// Частые запросы в ограниченной памяти: Count-Min sketch оценивает частоту любого запроса, а CAPACITY
+// самых частых хранятся вместе с текстом, как в SpaceSaving — новый запрос вытесняет самый редкий из
+// хранимых, если оценка его частоты больше. Обновление без блокировок: счётчики атомарны, а запись
+// кандидата защищена версией (seqlock); поток, не захвативший запись, просто не обновляет её
+class HeavyHitters {
+public:
+    static constexpr size_t CAPACITY = 16;
+    static constexpr size_t SKETCH_DEPTH = 4;
+    static constexpr size_t SKETCH_WIDTH = 512;
+    // Более длинные запросы хранятся обрезанными
+    static constexpr size_t MAX_QUERY_LENGTH = 64;
+
+    HeavyHitters() = default;
+
+    HeavyHitters(const HeavyHitters &) = delete;
+
+    HeavyHitters &operator=(const HeavyHitters &) = delete;
+
+    void Add(std::string_view query);
+
+    void Clear();
+
+    // Добавляет хранимые запросы к query_to_count
+    void Collect(std::map<std::string, uint64_t> &query_to_count) const;
+
+private:
+    static constexpr size_t TEXT_WORDS = MAX_QUERY_LENGTH / sizeof(uint64_t);
+
+    struct Candidate {
+        // Нечётная, пока запись меняется
+        std::atomic<uint32_t> version{0};
+        std::atomic<uint32_t> length{0};
+        std::atomic<uint64_t> hash{0};
+        std::atomic<uint64_t> count{0};
+        std::array<std::atomic<uint64_t>, TEXT_WORDS> text{};
+    };
+
+    uint64_t IncrementSketch(uint64_t hash);
+
+    static void Replace(Candidate &candidate, std::string_view query, uint64_t hash, uint64_t count);
+
+    std::array<std::atomic<uint32_t>, SKETCH_DEPTH * SKETCH_WIDTH> sketch_{};
+    std::array<Candidate, CAPACITY> candidates_;
+};
+
+// Статистика запросов по окнам времени: гистограммы задержки и числа результатов, частые запросы и частые
+// запросы без результатов. Память фиксирована: хранится window_count последних окон, старое окно
+// очищается первым запросом, попавшим в его место. Запись не блокирует: запросы, пришедшие во время
+// очистки окна или опоздавшие больше чем на window_count окон, отбрасываются и учитываются в GetDroppedQueries
+class QueryAnalytics {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DEFAULT_WINDOW_COUNT = 8;
+
+    explicit QueryAnalytics(Clock::duration window_duration = std::chrono::minutes(1),
+                            size_t window_count = DEFAULT_WINDOW_COUNT);
+
+    void RecordQuery(std::string_view raw_query, size_t result_count, Clock::duration latency,
+                     Clock::time_point time = Clock::now());
+
+    // Сводка по окнам, пересекающимся с последними period от now
+    QueryAnalyticsReport GetReport(Clock::duration period, Clock::time_point now = Clock::now(),
+                                   size_t top_count = 10) const;
+
+    uint64_t GetDroppedQueries() const;
+
+    Clock::duration GetWindowDuration() const;
+
+private:
+    static constexpr int64_t EMPTY_WINDOW = -1;
+    static constexpr int64_t CLEARING_WINDOW = -2;
+
+    struct Window {
+        std::atomic<int64_t> index{EMPTY_WINDOW};
+        std::atomic<uint64_t> queries{0};
+        std::atomic<uint64_t> zero_result_queries{0};
+        AtomicHistogram latency_ns;
+        AtomicHistogram result_counts;
+        HeavyHitters top_queries;
+        HeavyHitters top_zero_result_queries;
+    };
+
+    // nullptr, если запрос нужно отбросить
+    Window *AcquireWindow(int64_t window_index);
+
+    int64_t GetWindowIndex(Clock::time_point time) const;
+
+    const Clock::time_point start_;
+    const Clock::duration window_duration_;
+    const size_t window_count_;
+    std::unique_ptr<Window[]> windows_;
+    std::atomic<uint64_t> dropped_queries_{0};
+};
@@ -0,0 +1,105 @@
+#include "query_budget.h"
+
+#include <algorithm>
+
+QueryBudget QueryBudget::Unlimited() {
+    return {};
+}
+
+QueryBudget QueryBudget::WithTimeout(Clock::duration timeout) {
+    QueryBudget budget;
+    budget.deadline = Clock::now() + timeout;
+    return budget;
+}
+
+QueryBudget QueryBudget::WithMaxPostings(uint64_t max_postings) {
+    QueryBudget budget;
+    budget.max_postings = max_postings;
+    return budget;
+}
+
+bool QueryBudget::IsUnlimited() const {
+    return deadline == Clock::time_point::max() && max_postings == std::numeric_limits<uint64_t>::max();
+}
+
+QueryBudgetTracker::QueryBudgetTracker(const QueryBudget &budget)
+        : budget_(budget), check_deadline_(budget.deadline != QueryBudget::Clock::time_point::max()) {
+}
+
+uint64_t QueryBudgetTracker::Acquire() {
+    if (IsExhausted()) {
+        return 0;
+    }
+    if (check_deadline_ && QueryBudget::Clock::now() >= budget_.deadline) {
+        MarkExhausted(BudgetExhaustion::DEADLINE);
+        return 0;
+    }
+
+    const uint64_t already_scanned = scanned_postings_.fetch_add(CHECK_INTERVAL, std::memory_order_relaxed);
+    if (already_scanned >= budget_.max_postings) {
+        scanned_postings_.fetch_sub(CHECK_INTERVAL, std::memory_order_relaxed);
+        MarkExhausted(BudgetExhaustion::POSTINGS);
+        return 0;
+    }
+    const uint64_t granted = std::min(CHECK_INTERVAL, budget_.max_postings - already_scanned);
+    if (granted < CHECK_INTERVAL) {
+        scanned_postings_.fetch_sub(CHECK_INTERVAL - granted, std::memory_order_relaxed);
+    }
+    return granted;
+}
+
+void QueryBudgetTracker::Release(uint64_t unused_postings) {
+    scanned_postings_.fetch_sub(unused_postings, std::memory_order_relaxed);
+}
+
+bool QueryBudgetTracker::IsExhausted() const {
+    return exhaustion_.load(std::memory_order_relaxed) != BudgetExhaustion::NONE;
+}
+
+BudgetExhaustion QueryBudgetTracker::GetExhaustion() const {
+    return exhaustion_.load(std::memory_order_relaxed);
+}
+
+uint64_t QueryBudgetTracker::GetScannedPostings() const {
+    return scanned_postings_.load(std::memory_order_relaxed);
+}
+
+void QueryBudgetTracker::MarkExhausted(BudgetExhaustion reason) {
+    BudgetExhaustion expected = BudgetExhaustion::NONE;
+    exhaustion_.compare_exchange_strong(expected, reason, std::memory_order_relaxed);
+}
+
+BudgetCounters::BudgetCounters(const BudgetCounters &other) {
+    *this = other;
+}
+
+BudgetCounters &BudgetCounters::operator=(const BudgetCounters &other) {
+    const BudgetStatistics statistics = other.GetStatistics();
+    budgeted_queries_ = statistics.budgeted_queries;
+    deadline_exceeded_ = statistics.deadline_exceeded;
+    postings_exceeded_ = statistics.postings_exceeded;
+    return *this;
+}
+
+void BudgetCounters::Record(const QueryBudget &budget, const QueryBudgetTracker &tracker) {
+    if (budget.IsUnlimited()) {
+        return;
+    }
+    budgeted_queries_.fetch_add(1, std::memory_order_relaxed);
+    switch (tracker.GetExhaustion()) {
+        case BudgetExhaustion::DEADLINE:
+            deadline_exceeded_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case BudgetExhaustion::POSTINGS:
+            postings_exceeded_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case BudgetExhaustion::NONE:
+            break;
+    }
+}
+
+BudgetStatistics BudgetCounters::GetStatistics() const {
+    return {budgeted_queries_.load(std::memory_order_relaxed),
+            deadline_exceeded_.load(std::memory_order_relaxed),
+            postings_exceeded_.load(std::memory_order_relaxed)};
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+// Ограничения на выполнение одного запроса: крайний срок и/или максимальное число просмотренных
+// элементов инвертированного индекса. По умолчанию ограничений нет.
+struct QueryBudget {
+    using Clock = std::chrono::steady_clock;
+
+    static QueryBudget Unlimited();
+
+    static QueryBudget WithTimeout(Clock::duration timeout);
+
+    static QueryBudget WithMaxPostings(uint64_t max_postings);
+
+    bool IsUnlimited() const;
+
+    Clock::time_point deadline = Clock::time_point::max();
+    uint64_t max_postings = std::numeric_limits<uint64_t>::max();
+};
+
+enum class BudgetExhaustion {
+    NONE,
+    DEADLINE,
+    POSTINGS,
+};
+
+// Кооперативный учёт бюджета запроса. Обход индекса берёт у трекера порции постингов через Acquire()
+// и прекращается, как только порция оказывается пустой. Безопасен для использования из нескольких потоков.
+class QueryBudgetTracker {
+public:
+    // Как часто (в постингах) проверяется крайний срок
+    static constexpr uint64_t CHECK_INTERVAL = 256;
+
+    explicit QueryBudgetTracker(const QueryBudget &budget);
+
+    // Резервирует до CHECK_INTERVAL постингов для просмотра, возвращает 0, если бюджет исчерпан
+    uint64_t Acquire();
+
+    // Возвращает неиспользованный остаток ранее зарезервированной порции
+    void Release(uint64_t unused_postings);
+
+    bool IsExhausted() const;
+
+    BudgetExhaustion GetExhaustion() const;
+
+    uint64_t GetScannedPostings() const;
+
+private:
+    void MarkExhausted(BudgetExhaustion reason);
+
+    const QueryBudget budget_;
+    const bool check_deadline_;
+    std::atomic<uint64_t> scanned_postings_{0};
+    std::atomic<BudgetExhaustion> exhaustion_{BudgetExhaustion::NONE};
+};
+
+struct BudgetStatistics {
+    uint64_t budgeted_queries = 0;
+    uint64_t deadline_exceeded = 0;
+    uint64_t postings_exceeded = 0;
+};
+
+// Счётчики срабатываний бюджетов, обновляемые конкурентно из запросов
+class BudgetCounters {
+public:
+    BudgetCounters() = default;
+
+    BudgetCounters(const BudgetCounters &other);
+
+    BudgetCounters &operator=(const BudgetCounters &other);
+
+    void Record(const QueryBudget &budget, const QueryBudgetTracker &tracker);
+
+    BudgetStatistics GetStatistics() const;
+
+private:
+    std::atomic<uint64_t> budgeted_queries_{0};
+    std::atomic<uint64_t> deadline_exceeded_{0};
+    std::atomic<uint64_t> postings_exceeded_{0};
+};
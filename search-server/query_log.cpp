@@ -0,0 +1,39 @@
+#include "query_log.h"
+
+#include <stdexcept>
+
+using namespace std::string_literals;
+
+void WriteQueryLogEntry(std::ostream &output, const LoggedQuery &query) {
+    output << query.offset.count() << '\t' << query.raw_query << '\n';
+}
+
+std::vector<LoggedQuery> ReadQueryLog(std::istream &input) {
+    std::vector<LoggedQuery> queries;
+    std::chrono::microseconds offset{0};
+    std::string line;
+    for (int line_number = 1; std::getline(input, line); ++line_number) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        const size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            queries.push_back({offset, line});
+            continue;
+        }
+        size_t parsed_length = 0;
+        try {
+            offset = std::chrono::microseconds(std::stoll(line.substr(0, tab), &parsed_length));
+        } catch (const std::logic_error &) {
+            parsed_length = 0;
+        }
+        if (tab == 0 || parsed_length != tab || offset.count() < 0) {
+            throw std::invalid_argument("Invalid query offset in line "s + std::to_string(line_number));
+        }
+        queries.push_back({offset, line.substr(tab + 1)});
+    }
+    return queries;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Запись журнала запросов: смещение от начала журнала и текст запроса
+struct LoggedQuery {
+    std::chrono::microseconds offset{0};
+    std::string raw_query;
+};
+
+// Строка журнала: смещение в микросекундах, табуляция, запрос. Управляющих символов в допустимом
+// запросе нет, так что экранирование не нужно
+void WriteQueryLogEntry(std::ostream &output, const LoggedQuery &query);
+
+// Пропускает пустые строки и комментарии, начинающиеся с '#'. Строка без табуляции — запрос
+// с тем же смещением, что у предыдущего. Бросает invalid_argument при неверном смещении
+std::vector<LoggedQuery> ReadQueryLog(std::istream &input);
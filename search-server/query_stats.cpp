@@ -0,0 +1,33 @@
+#include "query_stats.h"
+
+#include <array>
+
+namespace {
+
+constexpr std::array<std::string_view, 5> STRATEGY_NAMES = {
+        "exhaustive", "exhaustive_parallel", "required_words", "impacts", "quantized",
+};
+
+}  // namespace
+
+std::string_view GetQueryStrategyName(QueryStrategy strategy) {
+    return STRATEGY_NAMES[static_cast<size_t>(strategy)];
+}
+
+std::ostream &operator<<(std::ostream &output, const QueryStats &stats) {
+    return output << "strategy=" << GetQueryStrategyName(stats.strategy)
+                  << " plus_words=" << stats.plus_words
+                  << " required_words=" << stats.required_words
+                  << " minus_words=" << stats.minus_words
+                  << " scanned_postings=" << stats.scanned_postings
+                  << " excluded_postings=" << stats.excluded_postings
+                  << " predicate_rejections=" << stats.predicate_rejections
+                  << " candidates=" << stats.candidates
+                  << " results=" << stats.results
+                  << " partial=" << (stats.is_partial ? "true" : "false")
+                  << " parse_ns=" << stats.parse_time.count()
+                  << " lookup_ns=" << stats.lookup_time.count()
+                  << " score_ns=" << stats.score_time.count()
+                  << " sort_ns=" << stats.sort_time.count()
+                  << " total_ns=" << stats.total_time.count();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+enum class QueryStrategy {
+    // Обход списков всех плюс-слов с накоплением релевантности
+    EXHAUSTIVE,
+    EXHAUSTIVE_PARALLEL,
+    // Пересечение списков обязательных слов
+    REQUIRED_WORDS,
+    // Алгоритм с порогом по спискам вкладов
+    IMPACTS,
+    QUANTIZED,
+};
+
+std::string_view GetQueryStrategyName(QueryStrategy strategy);
+
+// Сведения о выполнении одного запроса для настройки и журнала медленных запросов
+struct QueryStats {
+    QueryStrategy strategy = QueryStrategy::EXHAUSTIVE;
+    // Слова запроса, найденные в индексе
+    size_t plus_words = 0;
+    size_t required_words = 0;
+    size_t minus_words = 0;
+    uint64_t scanned_postings = 0;
+    // Постинги документов с минус-словами, пропущенные без проверки предиката
+    uint64_t excluded_postings = 0;
+    // Вызовы предиката, отклонившие документ
+    uint64_t predicate_rejections = 0;
+    // Документы, для которых накапливалась релевантность
+    size_t candidates = 0;
+    size_t results = 0;
+    // Обход прерван по бюджету
+    bool is_partial = false;
+
+    std::chrono::nanoseconds parse_time{0};
+    std::chrono::nanoseconds lookup_time{0};
+    std::chrono::nanoseconds score_time{0};
+    std::chrono::nanoseconds sort_time{0};
+    std::chrono::nanoseconds total_time{0};
+};
+
+// Одна строка вида ключ=значение
+std::ostream &operator<<(std::ostream &output, const QueryStats &stats);
+
+// Замер этапов запроса в QueryStats; без stats ничего не делает
+class QueryStatsStopwatch {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit QueryStatsStopwatch(QueryStats *stats)
+            : stats_(stats) {
+        if (stats_ != nullptr) {
+            start_time_ = lap_start_time_ = Clock::now();
+        }
+    }
+
+    QueryStatsStopwatch(const QueryStatsStopwatch &) = delete;
+
+    QueryStatsStopwatch &operator=(const QueryStatsStopwatch &) = delete;
+
+    ~QueryStatsStopwatch() {
+        if (stats_ != nullptr) {
+            stats_->total_time = Clock::now() - start_time_;
+        }
+    }
+
+    // Записывает в phase время с предыдущей отметки
+    void Lap(std::chrono::nanoseconds QueryStats::*phase) {
+        if (stats_ != nullptr) {
+            const Clock::time_point now = Clock::now();
+            stats_->*phase = now - lap_start_time_;
+            lap_start_time_ = now;
+        }
+    }
+
+private:
+    QueryStats *const stats_;
+    Clock::time_point start_time_;
+    Clock::time_point lap_start_time_;
+};
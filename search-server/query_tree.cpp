@@ -0,0 +1,312 @@
+#include "query_tree.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace std::string_literals;
+
+namespace {
+
+std::vector<std::string_view> TokenizeBooleanQuery(std::string_view text) {
+    std::vector<std::string_view> tokens;
+    while (!text.empty()) {
+        if (text[0] == ' ') {
+            text.remove_prefix(1);
+        } else if (text[0] == '(' || text[0] == ')') {
+            tokens.push_back(text.substr(0, 1));
+            text.remove_prefix(1);
+        } else {
+            const size_t token_end = std::min(text.find_first_of(" ()"), text.size());
+            tokens.push_back(text.substr(0, token_end));
+            text.remove_prefix(token_end);
+        }
+    }
+    return tokens;
+}
+
+class BooleanQueryParser {
+public:
+    explicit BooleanQueryParser(std::string_view text)
+            : tokens_(TokenizeBooleanQuery(text)) {
+    }
+
+    QueryNode Parse() {
+        if (tokens_.empty()) {
+            throw std::invalid_argument("Bad request"s);
+        }
+        QueryNode root = ParseOr();
+        if (position_ != tokens_.size()) {
+            throw std::invalid_argument("Unexpected "s + std::string(tokens_[position_]) + " in query"s);
+        }
+        return root;
+    }
+
+private:
+    bool IsAtEnd() const {
+        return position_ == tokens_.size();
+    }
+
+    std::string_view Peek() const {
+        return IsAtEnd() ? std::string_view() : tokens_[position_];
+    }
+
+    static QueryNode Combine(QueryNode::Type type, std::vector<QueryNode> operands) {
+        if (operands.size() == 1) {
+            return std::move(operands.front());
+        }
+        return {type, {}, std::move(operands)};
+    }
+
+    QueryNode ParseOr() {
+        std::vector<QueryNode> operands;
+        operands.push_back(ParseAnd());
+        while (Peek() == "OR") {
+            ++position_;
+            operands.push_back(ParseAnd());
+        }
+        return Combine(QueryNode::Type::OR, std::move(operands));
+    }
+
+    QueryNode ParseAnd() {
+        std::vector<QueryNode> operands;
+        operands.push_back(ParseUnary());
+        while (!IsAtEnd() && Peek() != ")" && Peek() != "OR") {
+            if (Peek() == "AND") {
+                ++position_;
+            }
+            operands.push_back(ParseUnary());
+        }
+        return Combine(QueryNode::Type::AND, std::move(operands));
+    }
+
+    QueryNode ParseUnary() {
+        const std::string_view token = Peek();
+        if (token == "NOT" || token == "-") {
+            ++position_;
+            return {QueryNode::Type::NOT, {}, {ParseUnary()}};
+        }
+        if (token.size() > 1 && token[0] == '-') {
+            ++position_;
+            return {QueryNode::Type::NOT, {}, {MakeWord(token.substr(1))}};
+        }
+        return ParsePrimary();
+    }
+
+    QueryNode ParsePrimary() {
+        if (IsAtEnd()) {
+            throw std::invalid_argument("Query ends with an operator"s);
+        }
+        const std::string_view token = tokens_[position_++];
+        if (token == "(") {
+            QueryNode node = ParseOr();
+            if (Peek() != ")") {
+                throw std::invalid_argument("Unbalanced parentheses in query"s);
+            }
+            ++position_;
+            return node;
+        }
+        if (token == ")" || token == "AND" || token == "OR") {
+            throw std::invalid_argument("Unexpected "s + std::string(token) + " in query"s);
+        }
+        return MakeWord(token);
+    }
+
+    static QueryNode MakeWord(std::string_view word) {
+        if (word[0] == '-') {
+            throw std::invalid_argument("Query word "s + std::string(word) + " is invalid"s);
+        }
+        return {QueryNode::Type::WORD, word, {}};
+    }
+
+    std::vector<std::string_view> tokens_;
+    size_t position_ = 0;
+};
+
+}  // namespace
+
+QueryNode ParseBooleanQuery(std::string_view text) {
+    return BooleanQueryParser(text).Parse();
+}
+
+int EmptyIterator::GetDocument() const {
+    return END;
+}
+
+void EmptyIterator::Next() {
+}
+
+void EmptyIterator::Advance(int) {
+}
+
+double EmptyIterator::GetScore() const {
+    return 0.0;
+}
+
+size_t EmptyIterator::GetCost() const {
+    return 0;
+}
+
+TermIterator::TermIterator(const PostingList &postings, double inverse_document_freq)
+        : postings_(postings),
+          position_(postings.GetIterator()),
+          inverse_document_freq_(inverse_document_freq) {
+}
+
+int TermIterator::GetDocument() const {
+    return position_.GetDocument();
+}
+
+void TermIterator::Next() {
+    position_.Next();
+}
+
+void TermIterator::Advance(int target) {
+    position_.Advance(target);
+}
+
+double TermIterator::GetScore() const {
+    return position_.GetTermFreq() * inverse_document_freq_;
+}
+
+size_t TermIterator::GetCost() const {
+    return postings_.GetSize();
+}
+
+AndIterator::AndIterator(std::vector<std::unique_ptr<PostingIterator>> children)
+        : children_(std::move(children)) {
+    std::sort(children_.begin(), children_.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs->GetCost() < rhs->GetCost();
+    });
+    AlignChildren();
+}
+
+int AndIterator::GetDocument() const {
+    return children_.front()->GetDocument();
+}
+
+void AndIterator::Next() {
+    children_.front()->Next();
+    AlignChildren();
+}
+
+void AndIterator::Advance(int target) {
+    children_.front()->Advance(target);
+    AlignChildren();
+}
+
+double AndIterator::GetScore() const {
+    double score = 0.0;
+    for (const auto &child: children_) {
+        score += child->GetScore();
+    }
+    return score;
+}
+
+size_t AndIterator::GetCost() const {
+    return children_.front()->GetCost();
+}
+
+void AndIterator::AlignChildren() {
+    auto &lead = *children_.front();
+    size_t aligned_count = 1;
+    while (lead.GetDocument() != END && aligned_count < children_.size()) {
+        const int candidate = lead.GetDocument();
+        aligned_count = 1;
+        for (size_t i = 1; i < children_.size(); ++i) {
+            children_[i]->Advance(candidate);
+            if (children_[i]->GetDocument() != candidate) {
+                lead.Advance(children_[i]->GetDocument());
+                break;
+            }
+            ++aligned_count;
+        }
+    }
+}
+
+OrIterator::OrIterator(std::vector<std::unique_ptr<PostingIterator>> children)
+        : children_(std::move(children)) {
+    UpdateDocument();
+}
+
+int OrIterator::GetDocument() const {
+    return document_;
+}
+
+void OrIterator::Next() {
+    for (const auto &child: children_) {
+        if (child->GetDocument() == document_) {
+            child->Next();
+        }
+    }
+    UpdateDocument();
+}
+
+void OrIterator::Advance(int target) {
+    for (const auto &child: children_) {
+        child->Advance(target);
+    }
+    UpdateDocument();
+}
+
+double OrIterator::GetScore() const {
+    double score = 0.0;
+    for (const auto &child: children_) {
+        if (child->GetDocument() == document_) {
+            score += child->GetScore();
+        }
+    }
+    return score;
+}
+
+size_t OrIterator::GetCost() const {
+    size_t cost = 0;
+    for (const auto &child: children_) {
+        cost += child->GetCost();
+    }
+    return cost;
+}
+
+void OrIterator::UpdateDocument() {
+    document_ = END;
+    for (const auto &child: children_) {
+        document_ = std::min(document_, child->GetDocument());
+    }
+}
+
+AndNotIterator::AndNotIterator(std::unique_ptr<PostingIterator> included, std::unique_ptr<PostingIterator> excluded)
+        : included_(std::move(included)), excluded_(std::move(excluded)) {
+    SkipExcluded();
+}
+
+int AndNotIterator::GetDocument() const {
+    return included_->GetDocument();
+}
+
+void AndNotIterator::Next() {
+    included_->Next();
+    SkipExcluded();
+}
+
+void AndNotIterator::Advance(int target) {
+    included_->Advance(target);
+    SkipExcluded();
+}
+
+double AndNotIterator::GetScore() const {
+    return included_->GetScore();
+}
+
+size_t AndNotIterator::GetCost() const {
+    return included_->GetCost();
+}
+
+void AndNotIterator::SkipExcluded() {
+    while (included_->GetDocument() != END) {
+        excluded_->Advance(included_->GetDocument());
+        if (excluded_->GetDocument() != included_->GetDocument()) {
+            return;
+        }
+        included_->Next();
+    }
+}
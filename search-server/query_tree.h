@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "posting_list.h"
+
+// Разобранный булев запрос вида "(cat OR dog) AND curly -hair".
+// Приоритет операций: NOT (или префикс '-') выше AND, AND выше OR; стоящие рядом операнды соединяются через AND
+struct QueryNode {
+    enum class Type {
+        WORD,
+        AND,
+        OR,
+        NOT,
+    };
+
+    Type type = Type::WORD;
+    std::string_view word;
+    std::vector<QueryNode> children;
+};
+
+QueryNode ParseBooleanQuery(std::string_view text);
+
+// Итератор по возрастающим id документов, удовлетворяющих части запроса.
+// Документы вычисляются лениво, промежуточные множества не строятся
+class PostingIterator {
+public:
+    static constexpr int END = std::numeric_limits<int>::max();
+
+    virtual ~PostingIterator() = default;
+
+    // Текущий документ или END, если документы закончились
+    virtual int GetDocument() const = 0;
+
+    virtual void Next() = 0;
+
+    // Переходит к первому документу с id не меньше target, назад не сдвигается
+    virtual void Advance(int target) = 0;
+
+    // Вклад текущего документа в релевантность
+    virtual double GetScore() const = 0;
+
+    // Верхняя оценка числа документов
+    virtual size_t GetCost() const = 0;
+};
+
+class EmptyIterator : public PostingIterator {
+public:
+    int GetDocument() const override;
+
+    void Next() override;
+
+    void Advance(int target) override;
+
+    double GetScore() const override;
+
+    size_t GetCost() const override;
+};
+
+class TermIterator : public PostingIterator {
+public:
+    TermIterator(const PostingList &postings, double inverse_document_freq);
+
+    int GetDocument() const override;
+
+    void Next() override;
+
+    void Advance(int target) override;
+
+    double GetScore() const override;
+
+    size_t GetCost() const override;
+
+private:
+    const PostingList &postings_;
+    PostingList::Iterator position_;
+    const double inverse_document_freq_;
+};
+
+class AndIterator : public PostingIterator {
+public:
+    explicit AndIterator(std::vector<std::unique_ptr<PostingIterator>> children);
+
+    int GetDocument() const override;
+
+    void Next() override;
+
+    void Advance(int target) override;
+
+    double GetScore() const override;
+
+    size_t GetCost() const override;
+
+private:
+    void AlignChildren();
+
+    // Отсортированы по возрастанию GetCost(): самый короткий список ведёт обход
+    std::vector<std::unique_ptr<PostingIterator>> children_;
+};
+
+class OrIterator : public PostingIterator {
+public:
+    explicit OrIterator(std::vector<std::unique_ptr<PostingIterator>> children);
+
+    int GetDocument() const override;
+
+    void Next() override;
+
+    void Advance(int target) override;
+
+    double GetScore() const override;
+
+    size_t GetCost() const override;
+
+private:
+    void UpdateDocument();
+
+    std::vector<std::unique_ptr<PostingIterator>> children_;
+    int document_ = END;
+};
+
+// Документы included, которых нет в excluded
+class AndNotIterator : public PostingIterator {
+public:
+    AndNotIterator(std::unique_ptr<PostingIterator> included, std::unique_ptr<PostingIterator> excluded);
+
+    int GetDocument() const override;
+
+    void Next() override;
+
+    void Advance(int target) override;
+
+    double GetScore() const override;
+
+    size_t GetCost() const override;
+
+private:
+    void SkipExcluded();
+
+    std::unique_ptr<PostingIterator> included_;
+    std::unique_ptr<PostingIterator> excluded_;
+};
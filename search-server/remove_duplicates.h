@@ -1,4 +1,6 @@
 #pragma once
 #include "search_server.h"
 
-void RemoveDuplicates(SearchServer& search_server);
\ No newline at end of file
+// Удаляет документы, множество слов которых совпадает с множеством слов документа с меньшим id,
+// а при min_similarity < 1 — и документы, похожие на него не меньше чем на min_similarity по Жаккару
+void RemoveDuplicates(SearchServer& search_server, double min_similarity = 1.0);
@@ -0,0 +1,315 @@
+// Воспроизведение журнала запросов против SearchServer с замером задержек:
+//   cpp_search_server_replay --corpus documents.tsv --queries queries.log [--threads 8] [--qps 500 | --speed 1.0]
+//                            [--loops 1] [--policy seq|par] [--stop-words "a the"] [--format text|json]
+// Без --qps и --speed клиенты шлют запросы без пауз (замкнутый цикл). С ними запросы уходят по расписанию,
+// и задержка считается от запланированного времени, чтобы отставание клиента не скрывало очередь.
+// Корпус: строки "id<TAB>статус<TAB>рейтинги через пробел<TAB>текст" или просто текст документа.
+// Вместо файлов можно задать --generate-documents N и --generate-queries M — синтетический корпус
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <execution>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "corpus_generator.h"
+#include "histogram.h"
+#include "query_log.h"
+#include "search_server.h"
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+struct ReplayOptions {
+    string corpus_path;
+    string queries_path;
+    size_t generated_documents = 0;
+    size_t generated_queries = 0;
+    string stop_words;
+    size_t threads = max(thread::hardware_concurrency(), 1u);
+    optional<double> qps;
+    optional<double> speed;
+    size_t loops = 1;
+    bool is_parallel_policy = false;
+    bool is_json = false;
+};
+
+struct CorpusDocument {
+    int id = 0;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    vector<int> ratings;
+    string text;
+};
+
+struct ReplayReport {
+    size_t queries = 0;
+    size_t errors = 0;
+    double wall_seconds = 0.0;
+    double cpu_seconds = 0.0;
+    HistogramSnapshot latency_ns;
+};
+
+ReplayOptions ParseOptions(int argc, char *argv[]) {
+    ReplayOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const string argument = argv[i];
+        if (i + 1 == argc) {
+            throw invalid_argument("Missing value for "s + argument);
+        }
+        const string value = argv[++i];
+        if (argument == "--corpus"s) {
+            options.corpus_path = value;
+        } else if (argument == "--queries"s) {
+            options.queries_path = value;
+        } else if (argument == "--generate-documents"s) {
+            options.generated_documents = stoul(value);
+        } else if (argument == "--generate-queries"s) {
+            options.generated_queries = stoul(value);
+        } else if (argument == "--stop-words"s) {
+            options.stop_words = value;
+        } else if (argument == "--threads"s) {
+            options.threads = max<size_t>(stoul(value), 1);
+        } else if (argument == "--qps"s) {
+            options.qps = stod(value);
+        } else if (argument == "--speed"s) {
+            options.speed = stod(value);
+        } else if (argument == "--loops"s) {
+            options.loops = max<size_t>(stoul(value), 1);
+        } else if (argument == "--policy"s) {
+            options.is_parallel_policy = value == "par"s;
+        } else if (argument == "--format"s) {
+            options.is_json = value == "json"s;
+        } else {
+            throw invalid_argument("Unknown option "s + argument);
+        }
+    }
+    if ((options.qps && *options.qps <= 0.0) || (options.speed && *options.speed <= 0.0)) {
+        throw invalid_argument("--qps and --speed must be positive"s);
+    }
+    if (options.qps && options.speed) {
+        throw invalid_argument("--qps and --speed are mutually exclusive"s);
+    }
+    return options;
+}
+
+DocumentStatus ParseStatus(const string &text) {
+    if (text == "ACTUAL"s) {
+        return DocumentStatus::ACTUAL;
+    }
+    if (text == "IRRELEVANT"s) {
+        return DocumentStatus::IRRELEVANT;
+    }
+    if (text == "BANNED"s) {
+        return DocumentStatus::BANNED;
+    }
+    if (text == "REMOVED"s) {
+        return DocumentStatus::REMOVED;
+    }
+    throw invalid_argument("Unknown document status "s + text);
+}
+
+vector<CorpusDocument> ReadCorpus(istream &input) {
+    vector<CorpusDocument> documents;
+    // Документам без id достаются следующие за наибольшим из встреченных
+    int next_id = 0;
+    string line;
+    while (getline(input, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        vector<string> fields;
+        istringstream line_input(line);
+        for (string field; fields.size() < 3 && getline(line_input, field, '\t');) {
+            fields.push_back(field);
+        }
+        string text;
+        getline(line_input, text);
+        if (fields.size() < 3 || text.empty()) {
+            documents.push_back({next_id++, DocumentStatus::ACTUAL, {0}, line});
+            continue;
+        }
+        CorpusDocument document{stoi(fields[0]), ParseStatus(fields[1]), {}, text};
+        next_id = max(next_id, document.id + 1);
+        istringstream ratings_input(fields[2]);
+        for (int rating; ratings_input >> rating;) {
+            document.ratings.push_back(rating);
+        }
+        documents.push_back(move(document));
+    }
+    return documents;
+}
+
+ifstream OpenFile(const string &path) {
+    ifstream input(path);
+    if (!input) {
+        throw invalid_argument("Can't open "s + path);
+    }
+    return input;
+}
+
+SearchServer LoadServer(const ReplayOptions &options, CorpusGenerator &generator) {
+    // Синтетическому корпусу — его самые частые слова в качестве стоп-слов
+    SearchServer search_server = options.stop_words.empty() && options.corpus_path.empty()
+                                 ? SearchServer(generator.GetMostFrequentWords(10))
+                                 : SearchServer(options.stop_words);
+    if (!options.corpus_path.empty()) {
+        ifstream input = OpenFile(options.corpus_path);
+        for (const CorpusDocument &document: ReadCorpus(input)) {
+            search_server.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+        return search_server;
+    }
+    for (size_t id = 0; id < options.generated_documents; ++id) {
+        search_server.AddDocument(static_cast<int>(id), generator.GenerateDocument(), generator.GenerateStatus(),
+                                  generator.GenerateRatings());
+    }
+    return search_server;
+}
+
+vector<LoggedQuery> LoadQueries(const ReplayOptions &options, CorpusGenerator &generator) {
+    if (!options.queries_path.empty()) {
+        ifstream input = OpenFile(options.queries_path);
+        return ReadQueryLog(input);
+    }
+    vector<LoggedQuery> queries;
+    for (size_t i = 0; i < options.generated_queries; ++i) {
+        queries.push_back({chrono::microseconds(0), generator.GenerateQuery()});
+    }
+    return queries;
+}
+
+// Время отправки запроса index от начала воспроизведения; nullopt в замкнутом цикле
+optional<Clock::duration> GetScheduledTime(const ReplayOptions &options, const vector<LoggedQuery> &queries,
+                                           size_t index) {
+    if (options.qps) {
+        return chrono::duration_cast<Clock::duration>(chrono::duration<double>(index / *options.qps));
+    }
+    if (options.speed) {
+        // Повторы журнала идут друг за другом, каждый длится столько же, сколько исходный журнал
+        const chrono::microseconds log_span = queries.back().offset - queries.front().offset
+                                              + chrono::microseconds(1);
+        const size_t loop = index / queries.size();
+        const chrono::microseconds offset = queries[index % queries.size()].offset - queries.front().offset
+                                            + log_span * static_cast<int64_t>(loop);
+        return chrono::duration_cast<Clock::duration>(chrono::duration<double, micro>(offset.count() / *options.speed));
+    }
+    return nullopt;
+}
+
+ReplayReport Replay(const SearchServer &search_server, const vector<LoggedQuery> &queries,
+                    const ReplayOptions &options) {
+    const size_t total_queries = queries.size() * options.loops;
+    AtomicHistogram latency_ns;
+    atomic<size_t> next_query{0};
+    atomic<size_t> errors{0};
+
+    const clock_t start_cpu_time = clock();
+    const Clock::time_point start_time = Clock::now();
+    vector<thread> clients;
+    for (size_t client = 0; client < options.threads; ++client) {
+        clients.emplace_back([&] {
+            for (size_t index = next_query++; index < total_queries; index = next_query++) {
+                const optional<Clock::duration> scheduled_time = GetScheduledTime(options, queries, index);
+                if (scheduled_time) {
+                    this_thread::sleep_until(start_time + *scheduled_time);
+                }
+                const Clock::time_point request_time = scheduled_time ? start_time + *scheduled_time : Clock::now();
+                const string &raw_query = queries[index % queries.size()].raw_query;
+                try {
+                    if (options.is_parallel_policy) {
+                        search_server.FindTopDocuments(execution::par, raw_query);
+                    } else {
+                        search_server.FindTopDocuments(execution::seq, raw_query);
+                    }
+                } catch (const exception &) {
+                    ++errors;
+                }
+                latency_ns.Record(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - request_time).count());
+            }
+        });
+    }
+    for (thread &client: clients) {
+        client.join();
+    }
+
+    ReplayReport report;
+    report.queries = total_queries;
+    report.errors = errors;
+    report.wall_seconds = chrono::duration<double>(Clock::now() - start_time).count();
+    report.cpu_seconds = static_cast<double>(clock() - start_cpu_time) / CLOCKS_PER_SEC;
+    report.latency_ns = latency_ns.GetSnapshot();
+    return report;
+}
+
+void PrintReport(const ReplayReport &report, const ReplayOptions &options) {
+    const HistogramSnapshot &latency = report.latency_ns;
+    const double throughput = report.queries / max(report.wall_seconds, 1e-9);
+    // Загрузка в ядрах и в долях всех ядер машины
+    const double busy_cores = report.cpu_seconds / max(report.wall_seconds, 1e-9);
+    const double cpu_utilization = busy_cores / max(thread::hardware_concurrency(), 1u);
+    const double mean_latency = latency.GetTotalCount() == 0
+                                ? 0.0 : static_cast<double>(latency.GetSum()) / latency.GetTotalCount();
+    const auto to_microseconds = [](double nanoseconds) {
+        return nanoseconds / 1000.0;
+    };
+    const string mode = options.qps ? "open_qps"s : options.speed ? "open_log_timing"s : "closed"s;
+    if (options.is_json) {
+        cout << "{\"mode\":\""s << mode << "\",\"threads\":"s << options.threads
+             << ",\"queries\":"s << report.queries << ",\"errors\":"s << report.errors
+             << ",\"wall_seconds\":"s << report.wall_seconds << ",\"throughput_qps\":"s << throughput
+             << ",\"cpu_seconds\":"s << report.cpu_seconds << ",\"busy_cores\":"s << busy_cores
+             << ",\"cpu_utilization\":"s << cpu_utilization
+             << ",\"latency_us\":{\"mean\":"s << to_microseconds(mean_latency);
+        for (const auto &[name, percentile]: {pair{"p50"s, 50.0}, pair{"p90"s, 90.0}, pair{"p99"s, 99.0},
+                                              pair{"p999"s, 99.9}}) {
+            cout << ",\""s << name << "\":"s << to_microseconds(latency.GetValueAtPercentile(percentile));
+        }
+        cout << ",\"max\":"s << to_microseconds(latency.GetMaxValue()) << "}}\n"s;
+        return;
+    }
+    cout << "mode: "s << mode << ", threads: "s << options.threads << '\n'
+         << "queries: "s << report.queries << ", errors: "s << report.errors << '\n'
+         << "wall time: "s << report.wall_seconds << " s, throughput: "s << throughput << " qps\n"s
+         << "cpu time: "s << report.cpu_seconds << " s, busy cores: "s << busy_cores
+         << ", utilization: "s << cpu_utilization * 100.0 << "%\n"s
+         << "latency us: mean "s << to_microseconds(mean_latency)
+         << ", p50 "s << to_microseconds(latency.GetValueAtPercentile(50.0))
+         << ", p90 "s << to_microseconds(latency.GetValueAtPercentile(90.0))
+         << ", p99 "s << to_microseconds(latency.GetValueAtPercentile(99.0))
+         << ", p999 "s << to_microseconds(latency.GetValueAtPercentile(99.9))
+         << ", max "s << to_microseconds(latency.GetMaxValue()) << '\n';
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    try {
+        const ReplayOptions options = ParseOptions(argc, argv);
+        if (options.corpus_path.empty() && options.generated_documents == 0) {
+            throw invalid_argument("Specify --corpus or --generate-documents"s);
+        }
+        CorpusGenerator generator;
+        const SearchServer search_server = LoadServer(options, generator);
+        const vector<LoggedQuery> queries = LoadQueries(options, generator);
+        if (queries.empty()) {
+            throw invalid_argument("Query log is empty, specify --queries or --generate-queries"s);
+        }
+        PrintReport(Replay(search_server, queries, options), options);
+    } catch (const exception &error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -18,3 +18,12 @@ std::vector<Document> RequestQueue::AddFindRequest(const std::string &raw_query)
 int RequestQueue::GetNoResultRequests() const {
     return this->empty_num_;
 }
+
+void RequestQueue::EnableAnalytics(QueryAnalytics &analytics) {
+    this->analytics_ = &analytics;
+}
+
+void RequestQueue::EnableQueryLog(std::ostream &output) {
+    this->query_log_ = &output;
+    this->query_log_start_ = QueryAnalytics::Clock::now();
+}
@@ -1,9 +1,13 @@
 #pragma once
 #include <algorithm>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <deque>
+#include <ostream>
 
+#include "query_analytics.h"
+#include "query_log.h"
 #include "search_server.h"
 
 class RequestQueue {
@@ -13,7 +17,16 @@ public:
     // сделаем "обёртки" для всех методов поиска, чтобы сохранять результаты для нашей статистики
     template<typename DocumentPredicate>
     std::vector<Document> AddFindRequest(const std::string &raw_query, DocumentPredicate document_predicate) {
+        const auto start_time = QueryAnalytics::Clock::now();
+        if (this->query_log_ != nullptr) {
+            WriteQueryLogEntry(*this->query_log_, {std::chrono::duration_cast<std::chrono::microseconds>(
+                    start_time - this->query_log_start_), raw_query});
+        }
         auto result = this->sserv_->FindTopDocuments(raw_query, document_predicate);
+        if (this->analytics_ != nullptr) {
+            const auto end_time = QueryAnalytics::Clock::now();
+            this->analytics_->RecordQuery(raw_query, result.size(), end_time - start_time, end_time);
+        }
         if (result.empty()) {
             ++this->empty_num_;
         }
@@ -32,6 +45,12 @@ public:
     std::vector<Document> AddFindRequest(const std::string &raw_query);
 
     int GetNoResultRequests() const;
+
+    // запросы будут замеряться и записываться в analytics
+    void EnableAnalytics(QueryAnalytics &analytics);
+
+    // запросы будут записываться в output в формате журнала для воспроизведения, смещения — от этого вызова
+    void EnableQueryLog(std::ostream &output);
 private:
     struct QueryResult {
         std::string raw_query;
@@ -41,5 +60,8 @@ private:
     std::deque<QueryResult> requests_;
     const static int min_in_day_ = 1440;
     const SearchServer *sserv_;
+    QueryAnalytics *analytics_ = nullptr;
+    std::ostream *query_log_ = nullptr;
+    QueryAnalytics::Clock::time_point query_log_start_;
     int empty_num_ = 0;
 };
\ No newline at end of file
@@ -0,0 +1,488 @@
+#include "roaring_bitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+using ArrayContainer = RoaringBitmap::ArrayContainer;
+using BitmapContainer = RoaringBitmap::BitmapContainer;
+using RunContainer = RoaringBitmap::RunContainer;
+using Container = RoaringBitmap::Container;
+using Run = RoaringBitmap::Run;
+
+uint32_t Cardinality(const Container &container) {
+    if (const auto *array = std::get_if<ArrayContainer>(&container)) {
+        return static_cast<uint32_t>(array->values.size());
+    }
+    if (const auto *bitmap = std::get_if<BitmapContainer>(&container)) {
+        return bitmap->cardinality;
+    }
+    uint32_t cardinality = 0;
+    for (const Run &run: std::get<RunContainer>(container).runs) {
+        cardinality += run.length + 1u;
+    }
+    return cardinality;
+}
+
+bool BitmapContains(const BitmapContainer &bitmap, uint16_t value) {
+    return (bitmap.words[value >> 6] >> (value & 63)) & 1u;
+}
+
+bool ContainerContains(const Container &container, uint16_t value) {
+    if (const auto *array = std::get_if<ArrayContainer>(&container)) {
+        return std::binary_search(array->values.begin(), array->values.end(), value);
+    }
+    if (const auto *bitmap = std::get_if<BitmapContainer>(&container)) {
+        return BitmapContains(*bitmap, value);
+    }
+    const auto &runs = std::get<RunContainer>(container).runs;
+    auto run_it = std::upper_bound(runs.begin(), runs.end(), value, [](uint16_t lhs, const Run &rhs) {
+        return lhs < rhs.start;
+    });
+    if (run_it == runs.begin()) {
+        return false;
+    }
+    --run_it;
+    return value <= static_cast<uint32_t>(run_it->start) + run_it->length;
+}
+
+std::vector<uint16_t> Elements(const Container &container) {
+    if (const auto *array = std::get_if<ArrayContainer>(&container)) {
+        return array->values;
+    }
+    std::vector<uint16_t> elements;
+    elements.reserve(Cardinality(container));
+    if (const auto *bitmap = std::get_if<BitmapContainer>(&container)) {
+        for (uint32_t word_index = 0; word_index < RoaringBitmap::BITMAP_CONTAINER_WORDS; ++word_index) {
+            for (uint64_t word = bitmap->words[word_index]; word != 0; word &= word - 1) {
+                elements.push_back(static_cast<uint16_t>(word_index * 64 + __builtin_ctzll(word)));
+            }
+        }
+    } else {
+        for (const Run &run: std::get<RunContainer>(container).runs) {
+            for (uint32_t value = run.start; value <= static_cast<uint32_t>(run.start) + run.length; ++value) {
+                elements.push_back(static_cast<uint16_t>(value));
+            }
+        }
+    }
+    return elements;
+}
+
+void SetRange(BitmapContainer &bitmap, uint32_t first, uint32_t last) {
+    for (uint32_t value = first; value <= last; ++value) {
+        bitmap.words[value >> 6] |= uint64_t{1} << (value & 63);
+    }
+}
+
+void RecountCardinality(BitmapContainer &bitmap) {
+    bitmap.cardinality = 0;
+    for (const uint64_t word: bitmap.words) {
+        bitmap.cardinality += __builtin_popcountll(word);
+    }
+}
+
+BitmapContainer ToBitmap(const Container &container) {
+    if (const auto *bitmap = std::get_if<BitmapContainer>(&container)) {
+        return *bitmap;
+    }
+    BitmapContainer bitmap;
+    if (const auto *array = std::get_if<ArrayContainer>(&container)) {
+        for (const uint16_t value: array->values) {
+            bitmap.words[value >> 6] |= uint64_t{1} << (value & 63);
+        }
+    } else {
+        for (const Run &run: std::get<RunContainer>(container).runs) {
+            SetRange(bitmap, run.start, static_cast<uint32_t>(run.start) + run.length);
+        }
+    }
+    RecountCardinality(bitmap);
+    return bitmap;
+}
+
+// Небольшие битовые карты хранятся массивом
+Container Compact(BitmapContainer &&bitmap) {
+    if (bitmap.cardinality > RoaringBitmap::MAX_ARRAY_CONTAINER_SIZE) {
+        return std::move(bitmap);
+    }
+    return ArrayContainer{Elements(Container{std::move(bitmap)})};
+}
+
+Container Compact(ArrayContainer &&array) {
+    if (array.values.size() <= RoaringBitmap::MAX_ARRAY_CONTAINER_SIZE) {
+        return std::move(array);
+    }
+    return ToBitmap(Container{std::move(array)});
+}
+
+// Отсортированный массив или битовую карту удобнее изменять, чем список отрезков
+void Expand(Container &container) {
+    if (std::holds_alternative<RunContainer>(container)) {
+        container = Compact(ToBitmap(container));
+    }
+}
+
+void ContainerAdd(Container &container, uint16_t value) {
+    Expand(container);
+    if (auto *array = std::get_if<ArrayContainer>(&container)) {
+        const auto value_it = std::lower_bound(array->values.begin(), array->values.end(), value);
+        if (value_it != array->values.end() && *value_it == value) {
+            return;
+        }
+        array->values.insert(value_it, value);
+        if (array->values.size() > RoaringBitmap::MAX_ARRAY_CONTAINER_SIZE) {
+            container = ToBitmap(container);
+        }
+        return;
+    }
+    auto &bitmap = std::get<BitmapContainer>(container);
+    if (!BitmapContains(bitmap, value)) {
+        bitmap.words[value >> 6] |= uint64_t{1} << (value & 63);
+        ++bitmap.cardinality;
+    }
+}
+
+bool ContainerRemove(Container &container, uint16_t value) {
+    Expand(container);
+    if (auto *array = std::get_if<ArrayContainer>(&container)) {
+        const auto value_it = std::lower_bound(array->values.begin(), array->values.end(), value);
+        if (value_it == array->values.end() || *value_it != value) {
+            return false;
+        }
+        array->values.erase(value_it);
+        return true;
+    }
+    auto &bitmap = std::get<BitmapContainer>(container);
+    if (!BitmapContains(bitmap, value)) {
+        return false;
+    }
+    bitmap.words[value >> 6] &= ~(uint64_t{1} << (value & 63));
+    --bitmap.cardinality;
+    if (bitmap.cardinality <= RoaringBitmap::MAX_ARRAY_CONTAINER_SIZE) {
+        container = Compact(std::move(bitmap));
+    }
+    return true;
+}
+
+ArrayContainer FilterArray(const ArrayContainer &array, const Container &other, bool keep_contained) {
+    ArrayContainer result;
+    result.values.reserve(array.values.size());
+    for (const uint16_t value: array.values) {
+        if (ContainerContains(other, value) == keep_contained) {
+            result.values.push_back(value);
+        }
+    }
+    return result;
+}
+
+// При таком соотношении размеров массивов выгоднее искать элементы меньшего в большем, чем сливать их
+const size_t GALLOPING_SIZE_RATIO = 32;
+
+// Для каждого элемента меньшего массива позиция в большем находится экспоненциальным поиском от предыдущей,
+// так что пересечение стоит O(m log(n / m)) вместо O(m + n)
+ArrayContainer GallopingIntersection(const ArrayContainer &smaller, const ArrayContainer &larger) {
+    ArrayContainer result;
+    auto position = larger.values.begin();
+    for (const uint16_t value: smaller.values) {
+        size_t step = 1;
+        auto bound = position;
+        while (bound != larger.values.end() && *bound < value) {
+            position = bound;
+            bound = static_cast<size_t>(larger.values.end() - bound) > step ? bound + step : larger.values.end();
+            step *= 2;
+        }
+        position = std::lower_bound(position, bound, value);
+        if (position == larger.values.end()) {
+            break;
+        }
+        if (*position == value) {
+            result.values.push_back(value);
+        }
+    }
+    return result;
+}
+
+Container Union(const Container &lhs, const Container &rhs) {
+    const auto *lhs_array = std::get_if<ArrayContainer>(&lhs);
+    const auto *rhs_array = std::get_if<ArrayContainer>(&rhs);
+    if (lhs_array && rhs_array) {
+        ArrayContainer result;
+        result.values.reserve(lhs_array->values.size() + rhs_array->values.size());
+        std::set_union(lhs_array->values.begin(), lhs_array->values.end(),
+                       rhs_array->values.begin(), rhs_array->values.end(),
+                       std::back_inserter(result.values));
+        return Compact(std::move(result));
+    }
+
+    BitmapContainer result = ToBitmap(lhs_array ? rhs : lhs);
+    const Container &added = lhs_array ? lhs : rhs;
+    if (const auto *array = std::get_if<ArrayContainer>(&added)) {
+        for (const uint16_t value: array->values) {
+            result.words[value >> 6] |= uint64_t{1} << (value & 63);
+        }
+    } else if (const auto *bitmap = std::get_if<BitmapContainer>(&added)) {
+        for (uint32_t i = 0; i < RoaringBitmap::BITMAP_CONTAINER_WORDS; ++i) {
+            result.words[i] |= bitmap->words[i];
+        }
+    } else {
+        for (const Run &run: std::get<RunContainer>(added).runs) {
+            SetRange(result, run.start, static_cast<uint32_t>(run.start) + run.length);
+        }
+    }
+    RecountCardinality(result);
+    return result;
+}
+
+Container Intersection(const Container &lhs, const Container &rhs) {
+    const auto *lhs_array = std::get_if<ArrayContainer>(&lhs);
+    const auto *rhs_array = std::get_if<ArrayContainer>(&rhs);
+    if (lhs_array && rhs_array) {
+        const auto &smaller = lhs_array->values.size() <= rhs_array->values.size() ? *lhs_array : *rhs_array;
+        const auto &larger = &smaller == lhs_array ? *rhs_array : *lhs_array;
+        if (smaller.values.size() * GALLOPING_SIZE_RATIO < larger.values.size()) {
+            return GallopingIntersection(smaller, larger);
+        }
+        ArrayContainer result;
+        std::set_intersection(lhs_array->values.begin(), lhs_array->values.end(),
+                              rhs_array->values.begin(), rhs_array->values.end(),
+                              std::back_inserter(result.values));
+        return result;
+    }
+    if (lhs_array) {
+        return FilterArray(*lhs_array, rhs, true);
+    }
+    if (rhs_array) {
+        return FilterArray(*rhs_array, lhs, true);
+    }
+
+    BitmapContainer result = ToBitmap(lhs);
+    const BitmapContainer rhs_bitmap = ToBitmap(rhs);
+    for (uint32_t i = 0; i < RoaringBitmap::BITMAP_CONTAINER_WORDS; ++i) {
+        result.words[i] &= rhs_bitmap.words[i];
+    }
+    RecountCardinality(result);
+    return Compact(std::move(result));
+}
+
+Container Difference(const Container &lhs, const Container &rhs) {
+    if (const auto *lhs_array = std::get_if<ArrayContainer>(&lhs)) {
+        return FilterArray(*lhs_array, rhs, false);
+    }
+
+    BitmapContainer result = ToBitmap(lhs);
+    if (const auto *rhs_array = std::get_if<ArrayContainer>(&rhs)) {
+        for (const uint16_t value: rhs_array->values) {
+            result.words[value >> 6] &= ~(uint64_t{1} << (value & 63));
+        }
+    } else {
+        const BitmapContainer rhs_bitmap = ToBitmap(rhs);
+        for (uint32_t i = 0; i < RoaringBitmap::BITMAP_CONTAINER_WORDS; ++i) {
+            result.words[i] &= ~rhs_bitmap.words[i];
+        }
+    }
+    RecountCardinality(result);
+    return Compact(std::move(result));
+}
+
+RunContainer ToRuns(const std::vector<uint16_t> &elements) {
+    RunContainer result;
+    for (const uint16_t value: elements) {
+        if (!result.runs.empty()
+            && static_cast<uint32_t>(result.runs.back().start) + result.runs.back().length + 1 == value) {
+            ++result.runs.back().length;
+        } else {
+            result.runs.push_back({value, 0});
+        }
+    }
+    return result;
+}
+
+size_t ContainerMemoryUsage(const Container &container) {
+    if (const auto *array = std::get_if<ArrayContainer>(&container)) {
+        return array->values.capacity() * sizeof(uint16_t);
+    }
+    if (const auto *bitmap = std::get_if<BitmapContainer>(&container)) {
+        return bitmap->words.capacity() * sizeof(uint64_t);
+    }
+    return std::get<RunContainer>(container).runs.capacity() * sizeof(Run);
+}
+
+}  // namespace
+
+size_t RoaringBitmap::FindKey(uint16_t key) const {
+    return std::lower_bound(keys_.begin(), keys_.end(), key) - keys_.begin();
+}
+
+void RoaringBitmap::Add(uint32_t value) {
+    const uint16_t key = value >> 16;
+    const size_t index = FindKey(key);
+    if (index == keys_.size() || keys_[index] != key) {
+        keys_.insert(keys_.begin() + index, key);
+        containers_.insert(containers_.begin() + index, ArrayContainer{});
+    }
+    ContainerAdd(containers_[index], static_cast<uint16_t>(value));
+}
+
+bool RoaringBitmap::Remove(uint32_t value) {
+    const uint16_t key = value >> 16;
+    const size_t index = FindKey(key);
+    if (index == keys_.size() || keys_[index] != key) {
+        return false;
+    }
+    if (!ContainerRemove(containers_[index], static_cast<uint16_t>(value))) {
+        return false;
+    }
+    if (Cardinality(containers_[index]) == 0) {
+        keys_.erase(keys_.begin() + index);
+        containers_.erase(containers_.begin() + index);
+    }
+    return true;
+}
+
+bool RoaringBitmap::Contains(uint32_t value) const {
+    const uint16_t key = value >> 16;
+    const size_t index = FindKey(key);
+    return index != keys_.size() && keys_[index] == key
+           && ContainerContains(containers_[index], static_cast<uint16_t>(value));
+}
+
+uint64_t RoaringBitmap::GetCardinality() const {
+    uint64_t cardinality = 0;
+    for (const Container &container: containers_) {
+        cardinality += Cardinality(container);
+    }
+    return cardinality;
+}
+
+void RoaringBitmap::Clear() {
+    keys_.clear();
+    containers_.clear();
+}
+
+void RoaringBitmap::RunOptimize() {
+    for (Container &container: containers_) {
+        const std::vector<uint16_t> elements = Elements(container);
+        RunContainer runs = ToRuns(elements);
+        const size_t run_bytes = runs.runs.size() * sizeof(Run);
+        const size_t array_bytes = elements.size() * sizeof(uint16_t);
+        const size_t bitmap_bytes = BITMAP_CONTAINER_WORDS * sizeof(uint64_t);
+        if (run_bytes < std::min(array_bytes, bitmap_bytes)) {
+            runs.runs.shrink_to_fit();
+            container = std::move(runs);
+        } else if (array_bytes <= bitmap_bytes) {
+            container = ArrayContainer{elements};
+        } else {
+            container = ToBitmap(container);
+        }
+    }
+}
+
+size_t RoaringBitmap::GetMemoryUsage() const {
+    size_t memory = sizeof(*this) + keys_.capacity() * sizeof(uint16_t) + containers_.capacity() * sizeof(Container);
+    for (const Container &container: containers_) {
+        memory += ContainerMemoryUsage(container);
+    }
+    return memory;
+}
+
+std::vector<uint32_t> RoaringBitmap::ToVector() const {
+    std::vector<uint32_t> values;
+    values.reserve(GetCardinality());
+    ForEach([&values](uint32_t value) {
+        values.push_back(value);
+    });
+    return values;
+}
+
+RoaringBitmap &RoaringBitmap::operator|=(const RoaringBitmap &other) {
+    std::vector<uint16_t> keys;
+    std::vector<Container> containers;
+    keys.reserve(keys_.size() + other.keys_.size());
+    containers.reserve(keys_.size() + other.keys_.size());
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < keys_.size() || j < other.keys_.size()) {
+        if (j == other.keys_.size() || (i < keys_.size() && keys_[i] < other.keys_[j])) {
+            keys.push_back(keys_[i]);
+            containers.push_back(std::move(containers_[i++]));
+        } else if (i == keys_.size() || other.keys_[j] < keys_[i]) {
+            keys.push_back(other.keys_[j]);
+            containers.push_back(other.containers_[j++]);
+        } else {
+            keys.push_back(keys_[i]);
+            containers.push_back(Union(containers_[i++], other.containers_[j++]));
+        }
+    }
+
+    keys_ = std::move(keys);
+    containers_ = std::move(containers);
+    return *this;
+}
+
+RoaringBitmap &RoaringBitmap::operator&=(const RoaringBitmap &other) {
+    std::vector<uint16_t> keys;
+    std::vector<Container> containers;
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < keys_.size() && j < other.keys_.size()) {
+        if (keys_[i] < other.keys_[j]) {
+            ++i;
+        } else if (other.keys_[j] < keys_[i]) {
+            ++j;
+        } else {
+            Container intersection = Intersection(containers_[i], other.containers_[j]);
+            if (Cardinality(intersection) > 0) {
+                keys.push_back(keys_[i]);
+                containers.push_back(std::move(intersection));
+            }
+            ++i;
+            ++j;
+        }
+    }
+
+    keys_ = std::move(keys);
+    containers_ = std::move(containers);
+    return *this;
+}
+
+RoaringBitmap &RoaringBitmap::operator-=(const RoaringBitmap &other) {
+    std::vector<uint16_t> keys;
+    std::vector<Container> containers;
+    keys.reserve(keys_.size());
+    containers.reserve(keys_.size());
+
+    size_t j = 0;
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        while (j < other.keys_.size() && other.keys_[j] < keys_[i]) {
+            ++j;
+        }
+        if (j == other.keys_.size() || other.keys_[j] != keys_[i]) {
+            keys.push_back(keys_[i]);
+            containers.push_back(std::move(containers_[i]));
+            continue;
+        }
+        Container difference = Difference(containers_[i], other.containers_[j]);
+        if (Cardinality(difference) > 0) {
+            keys.push_back(keys_[i]);
+            containers.push_back(std::move(difference));
+        }
+    }
+
+    keys_ = std::move(keys);
+    containers_ = std::move(containers);
+    return *this;
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap &other) const {
+    if (keys_ != other.keys_) {
+        return false;
+    }
+    for (size_t i = 0; i < containers_.size(); ++i) {
+        if (Elements(containers_[i]) != Elements(other.containers_[i])) {
+            return false;
+        }
+    }
+    return true;
+}
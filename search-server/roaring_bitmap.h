@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Сжатое множество 32-битных чисел по схеме Roaring: старшие 16 бит значения выбирают контейнер,
+// младшие хранятся в нём в одном из трёх представлений — отсортированный массив (до 4096 элементов),
+// битовая карта на 65536 бит или список отрезков (после RunOptimize)
+class RoaringBitmap {
+public:
+    RoaringBitmap() = default;
+
+    template<typename InputIt>
+    RoaringBitmap(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            Add(static_cast<uint32_t>(*first));
+        }
+    }
+
+    void Add(uint32_t value);
+
+    // Возвращает true, если значение было в множестве
+    bool Remove(uint32_t value);
+
+    bool Contains(uint32_t value) const;
+
+    uint64_t GetCardinality() const;
+
+    bool IsEmpty() const {
+        return keys_.empty();
+    }
+
+    void Clear();
+
+    // Переводит каждый контейнер в самое компактное из трёх представлений
+    void RunOptimize();
+
+    // Оценка занимаемой памяти в байтах
+    size_t GetMemoryUsage() const;
+
+    std::vector<uint32_t> ToVector() const;
+
+    template<typename Function>
+    void ForEach(Function function) const;
+
+    RoaringBitmap &operator|=(const RoaringBitmap &other);
+
+    RoaringBitmap &operator&=(const RoaringBitmap &other);
+
+    // Разность множеств
+    RoaringBitmap &operator-=(const RoaringBitmap &other);
+
+    friend RoaringBitmap operator|(RoaringBitmap lhs, const RoaringBitmap &rhs) {
+        return lhs |= rhs;
+    }
+
+    friend RoaringBitmap operator&(RoaringBitmap lhs, const RoaringBitmap &rhs) {
+        return lhs &= rhs;
+    }
+
+    friend RoaringBitmap operator-(RoaringBitmap lhs, const RoaringBitmap &rhs) {
+        return lhs -= rhs;
+    }
+
+    bool operator==(const RoaringBitmap &other) const;
+
+    bool operator!=(const RoaringBitmap &other) const {
+        return !(*this == other);
+    }
+
+    static constexpr uint32_t MAX_ARRAY_CONTAINER_SIZE = 4096;
+    static constexpr uint32_t BITMAP_CONTAINER_WORDS = 1024;
+
+    struct ArrayContainer {
+        std::vector<uint16_t> values;
+    };
+
+    struct BitmapContainer {
+        std::vector<uint64_t> words = std::vector<uint64_t>(BITMAP_CONTAINER_WORDS);
+        uint32_t cardinality = 0;
+    };
+
+    struct Run {
+        uint16_t start;
+        // Число элементов отрезка минус один
+        uint16_t length;
+    };
+
+    struct RunContainer {
+        std::vector<Run> runs;
+    };
+
+    using Container = std::variant<ArrayContainer, BitmapContainer, RunContainer>;
+
+private:
+    size_t FindKey(uint16_t key) const;
+
+    std::vector<uint16_t> keys_;
+    std::vector<Container> containers_;
+};
+
+template<typename Function>
+void RoaringBitmap::ForEach(Function function) const {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        const uint32_t high = static_cast<uint32_t>(keys_[i]) << 16;
+        const Container &container = containers_[i];
+        if (const auto *array = std::get_if<ArrayContainer>(&container)) {
+            for (const uint16_t low: array->values) {
+                function(high | low);
+            }
+        } else if (const auto *bitmap = std::get_if<BitmapContainer>(&container)) {
+            for (uint32_t word_index = 0; word_index < BITMAP_CONTAINER_WORDS; ++word_index) {
+                for (uint64_t word = bitmap->words[word_index]; word != 0; word &= word - 1) {
+                    function(high | (word_index * 64 + __builtin_ctzll(word)));
+                }
+            }
+        } else {
+            for (const Run &run: std::get<RunContainer>(container).runs) {
+                for (uint32_t low = run.start; low <= static_cast<uint32_t>(run.start) + run.length; ++low) {
+                    function(high | low);
+                }
+            }
+        }
+    }
+}
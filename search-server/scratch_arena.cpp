@@ -0,0 +1,78 @@
+#include "scratch_arena.h"
+
+#include <algorithm>
+
+ScratchArena::ScratchArena(size_t capacity, size_t max_capacity)
+        : initial_capacity_(std::max<size_t>(capacity, 1)),
+          max_capacity_(std::max(max_capacity, initial_capacity_)),
+          capacity_(initial_capacity_),
+          buffer_(std::make_unique<std::byte[]>(capacity_)) {
+    resource_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+ScratchArena &ScratchArena::ForCurrentThread() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+size_t ScratchArena::GetCapacity() const {
+    return capacity_;
+}
+
+void ScratchArena::Reset() {
+    resource_->release();
+    if (overflow_.GetAllocatedBytes() == 0) {
+        return;
+    }
+    // Буфер вмещает всё, что понадобилось последнему запросу, если это не больше max_capacity_
+    const size_t needed_capacity = capacity_ + overflow_.GetAllocatedBytes();
+    overflow_.ResetAllocatedBytes();
+    if (needed_capacity > max_capacity_) {
+        if (capacity_ == initial_capacity_) {
+            return;
+        }
+        capacity_ = initial_capacity_;
+    } else {
+        capacity_ = needed_capacity;
+    }
+    resource_.reset();
+    buffer_ = std::make_unique<std::byte[]>(capacity_);
+    resource_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+ScratchArena::Scope::Scope(ScratchArena &arena)
+        : arena_(arena) {
+    ++arena_.scope_depth_;
+}
+
+ScratchArena::Scope::~Scope() {
+    if (--arena_.scope_depth_ == 0) {
+        arena_.Reset();
+    }
+}
+
+std::pmr::memory_resource *ScratchArena::Scope::GetResource() const {
+    return &*arena_.resource_;
+}
+
+size_t ScratchArena::OverflowResource::GetAllocatedBytes() const {
+    return allocated_bytes_;
+}
+
+void ScratchArena::OverflowResource::ResetAllocatedBytes() {
+    allocated_bytes_ = 0;
+}
+
+void *ScratchArena::OverflowResource::do_allocate(size_t bytes, size_t alignment) {
+    void *pointer = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    allocated_bytes_ += bytes;
+    return pointer;
+}
+
+void ScratchArena::OverflowResource::do_deallocate(void *pointer, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+}
+
+bool ScratchArena::OverflowResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
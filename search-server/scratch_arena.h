@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Память для временных структур запроса. Выделение — сдвиг указателя в буфере, освобождения нет вовсе:
+// память возвращается разом по окончании запроса. Если запросу не хватило буфера, недостающее берётся
+// из кучи, а буфер к следующему запросу увеличивается, так что повторяющиеся запросы к куче не обращаются.
+// Буфер больше max_capacity не сохраняется: после такого запроса арена возвращается к начальному размеру,
+// чтобы один тяжёлый запрос не занимал память в каждом потоке навсегда
+class ScratchArena {
+public:
+    static constexpr size_t INITIAL_CAPACITY = 64 * 1024;
+    static constexpr size_t MAX_RETAINED_CAPACITY = 16 * 1024 * 1024;
+
+    explicit ScratchArena(size_t capacity = INITIAL_CAPACITY, size_t max_capacity = MAX_RETAINED_CAPACITY);
+
+    ScratchArena(const ScratchArena &) = delete;
+
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    // Своя арена у каждого потока
+    static ScratchArena &ForCurrentThread();
+
+    size_t GetCapacity() const;
+
+    // Время жизни одного запроса. Вложенные запросы того же потока продолжают заполнять арену,
+    // а освобождается она с выходом из внешнего
+    class Scope {
+    public:
+        explicit Scope(ScratchArena &arena);
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope();
+
+        std::pmr::memory_resource *GetResource() const;
+
+    private:
+        ScratchArena &arena_;
+    };
+
+private:
+    // Берёт память из кучи, подсчитывая её объём
+    class OverflowResource : public std::pmr::memory_resource {
+    public:
+        size_t GetAllocatedBytes() const;
+
+        void ResetAllocatedBytes();
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+        size_t allocated_bytes_ = 0;
+    };
+
+    void Reset();
+
+    const size_t initial_capacity_;
+    const size_t max_capacity_;
+    size_t capacity_;
+    std::unique_ptr<std::byte[]> buffer_;
+    OverflowResource overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> resource_;
+    int scope_depth_ = 0;
+};
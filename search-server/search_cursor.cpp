@@ -0,0 +1,57 @@
+#include "search_cursor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+bool IsRankedBefore(const Document &lhs, const Document &rhs) {
+    if (lhs.relevance != rhs.relevance) {
+        return lhs.relevance > rhs.relevance;
+    }
+    if (lhs.rating != rhs.rating) {
+        return lhs.rating > rhs.rating;
+    }
+    return lhs.id < rhs.id;
+}
+
+SearchCursor SearchCursor::After(const Document &document) {
+    SearchCursor cursor;
+    cursor.last_document_ = document;
+    return cursor;
+}
+
+SearchCursor SearchCursor::FromToken(std::string_view token) {
+    using namespace std::string_literals;
+
+    if (token.empty()) {
+        return {};
+    }
+    // Релевантность записана в шестнадцатеричном виде, чтобы восстановиться без потери точности
+    const std::string text(token);
+    Document document;
+    int consumed = 0;
+    if (std::sscanf(text.c_str(), "%la:%d:%d%n", &document.relevance, &document.rating, &document.id,
+                    &consumed) != 3 || consumed != static_cast<int>(text.size()) || !std::isfinite(document.relevance)
+        || document.id < 0) {
+        throw std::invalid_argument("Search cursor "s + text + " is invalid"s);
+    }
+    return After(document);
+}
+
+std::string SearchCursor::ToToken() const {
+    if (!last_document_) {
+        return {};
+    }
+    char buffer[64];
+    const int size = std::snprintf(buffer, sizeof(buffer), "%a:%d:%d", last_document_->relevance,
+                                   last_document_->rating, last_document_->id);
+    return std::string(buffer, size);
+}
+
+bool SearchCursor::IsStart() const {
+    return !last_document_;
+}
+
+bool SearchCursor::Admits(const Document &document) const {
+    return !last_document_ || IsRankedBefore(*last_document_, document);
+}
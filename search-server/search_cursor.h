@@ -0,0 +1,42 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "document.h"
+
+// Порядок постраничной выдачи: по убыванию релевантности, затем рейтинга, затем по возрастанию id. В отличие
+// от IsRankedHigher релевантности сравниваются точно, без EPSILON: иначе порядок не транзитивен, и куча
+// или курсор могут пропустить либо повторить документ. Место в выдаче у каждого документа однозначно
+bool IsRankedBefore(const Document &lhs, const Document &rhs);
+
+// Место в выдаче, с которого продолжается постраничный обход: последний документ предыдущей страницы.
+// Курсор по умолчанию указывает на начало выдачи
+class SearchCursor {
+public:
+    SearchCursor() = default;
+
+    static SearchCursor After(const Document &document);
+
+    // Восстанавливает курсор из токена ToToken(), для повреждённого токена бросает invalid_argument
+    static SearchCursor FromToken(std::string_view token);
+
+    // Непрозрачная для клиента строка, которую он возвращает за следующей страницей
+    std::string ToToken() const;
+
+    bool IsStart() const;
+
+    // true, если документ стоит в выдаче после курсора
+    bool Admits(const Document &document) const;
+
+private:
+    std::optional<Document> last_document_;
+};
+
+struct SearchPage {
+    std::vector<Document> documents;
+    // Не задан, если страница последняя
+    std::optional<SearchCursor> next_cursor;
+};
@@ -11,6 +11,8 @@ SearchServer::SearchServer(const std::string &stop_words_text)
 void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,
                                const std::vector<int> &ratings) {
     using namespace std::string_literals;
+    METRICS_SCOPED_TIMER(MetricStage::ADD_DOCUMENT);
+    TRACE_SCOPE("AddDocument");
     if ((document_id < 0) || (documents_.count(document_id) > 0)) {
         throw std::invalid_argument("Invalid document_id"s);
     }
@@ -21,30 +23,292 @@ void SearchServer::AddDocument(int document_id, std::string_view document, Docum
                                                                                          ComputeAverageRating(ratings),
                                                                                          status});
     const auto words = SplitIntoWordsNoStop(document_id_to_data->second.document_data);
+    std::optional<TermSetFingerprint> fingerprint;
+    if (duplicate_policy_) {
+        std::vector<std::string_view> unique_words = words;
+        std::sort(unique_words.begin(), unique_words.end());
+        unique_words.erase(std::unique(unique_words.begin(), unique_words.end()), unique_words.end());
+        fingerprint = ComputeTermSetFingerprint(unique_words);
+        const auto same_documents_it = fingerprint_to_documents_.find(*fingerprint);
+        if (*duplicate_policy_ == DuplicatePolicy::REJECT && same_documents_it != fingerprint_to_documents_.end()
+            && *same_documents_it->second.begin() < document_id) {
+            const int original_id = *same_documents_it->second.begin();
+            documents_.erase(document_id);
+            document_ids_.erase(document_id);
+            throw std::invalid_argument("Document "s + std::to_string(document_id) + " duplicates document "s
+                                        + std::to_string(original_id));
+        }
+    }
+    document_blocks_.AddDocument(document_id, status, document_id_to_data->second.rating);
 
+    std::vector<std::string_view> stored_words;
+    if (use_positional_index_) {
+        stored_words.reserve(words.size());
+    }
     const double inv_word_count = 1.0 / words.size();
     for (const std::string_view word: words) {
-        word_to_document_freqs_[word][document_id] += inv_word_count;
-        document_to_word_freqs_[document_id][word] += inv_word_count;
+        auto word_it = words_.find(word);
+        if (word_it == words_.end()) {
+            word_it = words_.emplace(word).first;
+            if (use_trigram_index_) {
+                trigram_index_.AddWord(*word_it);
+            }
+        }
+        const std::string_view stored_word = *word_it;
+        document_to_word_freqs_[document_id][stored_word] += inv_word_count;
+        if (use_word_bitmaps_) {
+            word_to_document_bitmap_[stored_word].Add(document_id);
+        }
+        if (use_positional_index_) {
+            stored_words.push_back(stored_word);
+        }
     }
-
+    if (use_positional_index_) {
+        positional_index_.AddDocument(document_id, stored_words);
+    }
+    // TF слова в документе известен только после просмотра всех слов
+    const auto word_freqs_it = document_to_word_freqs_.find(document_id);
+    if (word_freqs_it != document_to_word_freqs_.end()) {
+        const uint32_t slot = use_quantized_impacts_ ? quantized_index_.AddDocument(document_id, status) : 0;
+        for (const auto &[word, term_freq]: word_freqs_it->second) {
+            PostingList &postings = word_to_document_freqs_[word];
+            if (use_quantized_impacts_) {
+                postings.Quantize(quantized_index_);
+                postings.AddQuantized(document_id, slot, term_freq);
+            } else {
+                if (use_compressed_postings_) {
+                    postings.Compress();
+                }
+                postings.Add(document_id, term_freq);
+            }
+        }
+    }
+    if (use_impact_lists_) {
+        AddImpacts(document_id);
+    }
+    if (fingerprint) {
+        AddFingerprint(document_id, *fingerprint);
+    }
+    METRICS_ADD(MetricCounter::ADDED_DOCUMENTS, 1);
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query, DocumentStatus status) const {
-    return FindTopDocuments(std::execution::seq, raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-        return document_status == status;});
+    return FindTopDocuments(std::execution::seq, raw_query, DocumentStatusPredicate{status});
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query) const {
-    return FindTopDocuments(std::execution::seq, raw_query, [](int document_id, DocumentStatus document_status, int rating) {
-        return document_status ==  DocumentStatus::ACTUAL;
-    });
+    return FindTopDocuments(std::execution::seq, raw_query, DocumentStatusPredicate{DocumentStatus::ACTUAL});
+}
+
+void SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                    std::vector<Document> &result) const {
+    FindTopDocuments(raw_query, DocumentStatusPredicate{status}, result);
+}
+
+void SearchServer::FindTopDocuments(std::string_view raw_query, std::vector<Document> &result) const {
+    FindTopDocuments(raw_query, DocumentStatusPredicate{DocumentStatus::ACTUAL}, result);
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsWithStats(std::string_view raw_query, DocumentStatus status,
+                                                              QueryStats &stats) const {
+    return FindTopDocumentsWithStats(raw_query, DocumentStatusPredicate{status}, stats);
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsWithStats(std::string_view raw_query, QueryStats &stats) const {
+    return FindTopDocumentsWithStats(raw_query, DocumentStatusPredicate{DocumentStatus::ACTUAL}, stats);
+}
+
+SearchPage SearchServer::FindTopDocumentsPage(std::string_view raw_query, DocumentStatus status,
+                                              const SearchCursor &cursor, size_t page_size) const {
+    return FindTopDocumentsPage(raw_query, DocumentStatusPredicate{status}, cursor, page_size);
+}
+
+SearchPage SearchServer::FindTopDocumentsPage(std::string_view raw_query, const SearchCursor &cursor,
+                                              size_t page_size) const {
+    return FindTopDocumentsPage(raw_query, DocumentStatusPredicate{DocumentStatus::ACTUAL}, cursor, page_size);
+}
+
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, const QueryBudget &budget,
+                                                     bool &is_partial) const {
+    return FindTopDocuments(std::execution::seq, raw_query, DocumentStatusPredicate{DocumentStatus::ACTUAL}, budget,
+                            is_partial);
+}
+
+BudgetStatistics SearchServer::GetBudgetStatistics() const {
+    return budget_counters_.GetStatistics();
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsByBooleanQuery(std::string_view raw_query,
+                                                                   DocumentStatus status) const {
+    return FindTopDocumentsByBooleanQuery(raw_query, DocumentStatusPredicate{status});
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsByBooleanQuery(std::string_view raw_query) const {
+    return FindTopDocumentsByBooleanQuery(raw_query, DocumentStatus::ACTUAL);
+}
+
+void SearchServer::EnablePositionalIndex() {
+    if (use_positional_index_) {
+        return;
+    }
+    use_positional_index_ = true;
+    for (const auto &[document_id, document_data]: documents_) {
+        std::vector<std::string_view> words = SplitIntoWordsNoStop(document_data.document_data);
+        for (std::string_view &word: words) {
+            word = *words_.find(word);
+        }
+        positional_index_.AddDocument(document_id, words);
+    }
+}
+
+void SearchServer::EnableTrigramIndex() {
+    if (use_trigram_index_) {
+        return;
+    }
+    use_trigram_index_ = true;
+    for (const std::string &word: words_) {
+        trigram_index_.AddWord(word);
+    }
+}
+
+void SearchServer::EnableImpactLists(size_t min_documents) {
+    if (use_impact_lists_ && min_documents_for_impact_list_ == min_documents) {
+        return;
+    }
+    use_impact_lists_ = true;
+    min_documents_for_impact_list_ = min_documents;
+    word_to_impacts_.clear();
+    for (const auto &[word, postings]: word_to_document_freqs_) {
+        if (postings.GetSize() >= min_documents_for_impact_list_) {
+            word_to_impacts_.emplace(word, MakeImpactList(postings));
+        }
+    }
+}
+
+void SearchServer::EnableQuantizedImpacts() {
+    if (use_quantized_impacts_) {
+        return;
+    }
+    use_quantized_impacts_ = true;
+    for (const int document_id: document_ids_) {
+        quantized_index_.AddDocument(document_id, documents_.at(document_id).status);
+    }
+    for (auto &[word, postings]: word_to_document_freqs_) {
+        postings.Quantize(quantized_index_);
+    }
+}
+
+size_t SearchServer::GetQuantizedIndexMemoryUsage() const {
+    if (!use_quantized_impacts_) {
+        return 0;
+    }
+    size_t memory_usage = quantized_index_.GetMemoryUsage();
+    for (const auto &[word, postings]: word_to_document_freqs_) {
+        memory_usage += postings.GetMemoryUsage();
+    }
+    return memory_usage;
+}
+
+void SearchServer::EnableCompressedPostings() {
+    if (use_compressed_postings_) {
+        return;
+    }
+    use_compressed_postings_ = true;
+    for (auto &[word, postings]: word_to_document_freqs_) {
+        postings.Compress();
+    }
+}
+
+size_t SearchServer::GetCompressedPostingsMemoryUsage() const {
+    if (!use_compressed_postings_) {
+        return 0;
+    }
+    size_t memory = 0;
+    for (const auto &[word, postings]: word_to_document_freqs_) {
+        memory += postings.GetMemoryUsage();
+    }
+    return memory;
+}
+
+void SearchServer::EnableWordBitmaps() {
+    if (use_word_bitmaps_) {
+        return;
+    }
+    use_word_bitmaps_ = true;
+    for (const auto &[word, postings]: word_to_document_freqs_) {
+        auto &bitmap = word_to_document_bitmap_[word];
+        postings.ForEach([&bitmap](int document_id, double) {
+            bitmap.Add(document_id);
+            return true;
+        });
+    }
 }
 
 int SearchServer::GetDocumentCount() const {
     return documents_.size();
 }
 
+void SearchServer::EnableDuplicateDetection(DuplicatePolicy policy) {
+    const bool was_enabled = duplicate_policy_.has_value();
+    duplicate_policy_ = policy;
+    if (!was_enabled) {
+        // Отпечатки заносятся без вытеснения: удалять документы, пока идёт обход document_ids_, нельзя
+        for (const int document_id: document_ids_) {
+            const TermSetFingerprint fingerprint = ComputeTermSetFingerprint(GetWordFrequencies(document_id));
+            document_to_fingerprint_.emplace(document_id, fingerprint);
+            fingerprint_to_documents_[fingerprint].insert(document_id);
+        }
+    }
+    if (policy == DuplicatePolicy::REJECT) {
+        const std::vector<int> duplicates = GetDuplicates();
+        for (const int document_id: duplicates) {
+            RemoveDocument(document_id);
+        }
+    }
+}
+
+bool SearchServer::IsDuplicate(int document_id) const {
+    const auto fingerprint_it = document_to_fingerprint_.find(document_id);
+    if (fingerprint_it == document_to_fingerprint_.end()) {
+        return false;
+    }
+    return *fingerprint_to_documents_.at(fingerprint_it->second).begin() != document_id;
+}
+
+std::vector<int> SearchServer::GetDuplicates() const {
+    std::vector<int> duplicates;
+    for (const auto &[_, same_documents]: fingerprint_to_documents_) {
+        duplicates.insert(duplicates.end(), std::next(same_documents.begin()), same_documents.end());
+    }
+    std::sort(duplicates.begin(), duplicates.end());
+    return duplicates;
+}
+
+void SearchServer::AddFingerprint(int document_id, const TermSetFingerprint &fingerprint) {
+    document_to_fingerprint_.emplace(document_id, fingerprint);
+    std::set<int> &same_documents = fingerprint_to_documents_[fingerprint];
+    same_documents.insert(document_id);
+    if (*duplicate_policy_ == DuplicatePolicy::REJECT) {
+        // Документ с меньшим id вытесняет прежние
+        while (same_documents.size() > 1) {
+            RemoveDocument(*same_documents.rbegin());
+        }
+    }
+}
+
+void SearchServer::RemoveFingerprint(int document_id) {
+    const auto fingerprint_it = document_to_fingerprint_.find(document_id);
+    if (fingerprint_it == document_to_fingerprint_.end()) {
+        return;
+    }
+    const auto same_documents_it = fingerprint_to_documents_.find(fingerprint_it->second);
+    same_documents_it->second.erase(document_id);
+    if (same_documents_it->second.empty()) {
+        fingerprint_to_documents_.erase(same_documents_it);
+    }
+    document_to_fingerprint_.erase(fingerprint_it);
+}
+
 const std::map<std::string_view, double> &SearchServer::GetWordFrequencies(int document_id) const {
     static const std::map<std::string_view, double> empty_map;
 
@@ -63,18 +327,34 @@ void SearchServer::RemoveDocument(const std::execution::sequenced_policy &, int
     if (!count(document_ids_.begin(), document_ids_.end(), document_id)) {
         return;
     }
+    METRICS_SCOPED_TIMER(MetricStage::REMOVE_DOCUMENT);
+    TRACE_SCOPE("RemoveDocument");
+    if (use_positional_index_) {
+        positional_index_.RemoveDocument(document_id, document_to_word_freqs_.at(document_id));
+    }
+    if (use_impact_lists_) {
+        RemoveImpacts(document_id);
+    }
 
     for (auto &[word, freqs]: document_to_word_freqs_.at(document_id)) {
-        auto &document_freqs = word_to_document_freqs_.at(word);
-        document_freqs.erase(document_id);
-        if (document_freqs.empty()) {
-            word_to_document_freqs_.erase(word);
+        word_to_document_freqs_.at(word).Remove(document_id);
+        if (use_word_bitmaps_) {
+            word_to_document_bitmap_.at(word).Remove(document_id);
         }
+        RemoveWordIfUnused(word);
+    }
+    if (use_quantized_impacts_) {
+        quantized_index_.RemoveDocument(document_id);
     }
 
     document_to_word_freqs_.erase(document_id);
     documents_.erase(document_id);
     document_ids_.erase(document_id);
+    document_blocks_.RemoveDocument(document_id);
+    if (duplicate_policy_) {
+        RemoveFingerprint(document_id);
+    }
+    METRICS_ADD(MetricCounter::REMOVED_DOCUMENTS, 1);
 }
 
 void SearchServer::RemoveDocument(const std::execution::parallel_policy &, int document_id) {
@@ -82,8 +362,16 @@ void SearchServer::RemoveDocument(const std::execution::parallel_policy &, int d
     if (!count(document_ids_.begin(), document_ids_.end(), document_id)) {
         return;
     }
+    METRICS_SCOPED_TIMER(MetricStage::REMOVE_DOCUMENT);
+    TRACE_SCOPE("RemoveDocument");
 
     const auto &word_freqs = document_to_word_freqs_.at(document_id);
+    if (use_positional_index_) {
+        positional_index_.RemoveDocument(document_id, word_freqs);
+    }
+    if (use_impact_lists_) {
+        RemoveImpacts(document_id);
+    }
     std::vector<std::string_view> words(word_freqs.size());
     transform(
             std::execution::par,
@@ -95,13 +383,95 @@ void SearchServer::RemoveDocument(const std::execution::parallel_policy &, int d
             std::execution::par,
             words.begin(), words.end(),
             [this, document_id](std::string_view word) {
-                word_to_document_freqs_.at(std::string(word)).erase(document_id);
+                word_to_document_freqs_.at(word).Remove(document_id);
+                if (use_word_bitmaps_) {
+                    word_to_document_bitmap_.at(word).Remove(document_id);
+                }
             }
     );
+    for (const std::string_view word: words) {
+        RemoveWordIfUnused(word);
+    }
+    if (use_quantized_impacts_) {
+        quantized_index_.RemoveDocument(document_id);
+    }
 
     document_to_word_freqs_.erase(document_id);
     documents_.erase(document_id);
     document_ids_.erase(document_id);
+    document_blocks_.RemoveDocument(document_id);
+    if (duplicate_policy_) {
+        RemoveFingerprint(document_id);
+    }
+    METRICS_ADD(MetricCounter::REMOVED_DOCUMENTS, 1);
+}
+
+void SearchServer::RemoveWordIfUnused(std::string_view word) {
+    const auto word_it = word_to_document_freqs_.find(word);
+    if (word_it == word_to_document_freqs_.end() || !word_it->second.IsEmpty()) {
+        return;
+    }
+    word_to_document_freqs_.erase(word_it);
+    word_to_document_bitmap_.erase(word);
+    const auto stored_word_it = words_.find(word);
+    if (use_trigram_index_) {
+        trigram_index_.RemoveWord(*stored_word_it);
+    }
+    words_.erase(stored_word_it);
+}
+
+ImpactList SearchServer::MakeImpactList(const PostingList &postings) const {
+    ImpactList impacts;
+    postings.ForEach([this, &impacts](int document_id, double term_freq) {
+        impacts.insert({term_freq, documents_.at(document_id).rating, document_id});
+        return true;
+    });
+    return impacts;
+}
+
+void SearchServer::AddImpacts(int document_id) {
+    const int rating = documents_.at(document_id).rating;
+    for (const auto &[word, term_freq]: document_to_word_freqs_.at(document_id)) {
+        const auto impacts_it = word_to_impacts_.find(word);
+        if (impacts_it != word_to_impacts_.end()) {
+            impacts_it->second.insert({term_freq, rating, document_id});
+            continue;
+        }
+        const auto &postings = word_to_document_freqs_.at(word);
+        if (postings.GetSize() >= min_documents_for_impact_list_) {
+            word_to_impacts_.emplace(word, MakeImpactList(postings));
+        }
+    }
+}
+
+void SearchServer::RemoveImpacts(int document_id) {
+    const int rating = documents_.at(document_id).rating;
+    for (const auto &[word, term_freq]: document_to_word_freqs_.at(document_id)) {
+        const auto impacts_it = word_to_impacts_.find(word);
+        if (impacts_it == word_to_impacts_.end()) {
+            continue;
+        }
+        impacts_it->second.erase({term_freq, rating, document_id});
+        // Список убирается с запасом ниже порога, чтобы слово на границе не перестраивало его раз за разом
+        if (impacts_it->second.size() * 2 < min_documents_for_impact_list_ || impacts_it->second.empty()) {
+            word_to_impacts_.erase(impacts_it);
+        }
+    }
+}
+
+bool SearchServer::IsQuantizedSearchApplicable(const QueryPlan &plan, const QueryBudget &budget) const {
+    return use_quantized_impacts_ && budget.IsUnlimited() && plan.required_words.empty() && plan.phrases.empty()
+           && !plan.plus_words.empty();
+}
+
+bool SearchServer::IsImpactSearchApplicable(const QueryPlan &plan, const QueryBudget &budget) const {
+    if (!use_impact_lists_ || !budget.IsUnlimited() || !plan.required_words.empty() || !plan.phrases.empty()
+        || plan.plus_words.empty() || plan.plus_words.size() > MAX_WORDS_FOR_IMPACT_SEARCH) {
+        return false;
+    }
+    return std::any_of(plan.plus_words.begin(), plan.plus_words.end(), [this](const PlannedWord &word) {
+        return word_to_impacts_.count(word.data) > 0;
+    });
 }
 
 std::tuple<std::vector<std::string_view>, DocumentStatus>
@@ -112,8 +482,8 @@ SearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
 std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(
         const std::execution::sequenced_policy &, std::string_view raw_query, int document_id) const {
     using namespace std::string_literals;
-    if (!count(document_ids_.begin(), document_ids_.end(), document_id)) {
-        throw std::out_of_range("No documents with id " + document_id);
+    if (documents_.count(document_id) == 0) {
+        throw std::out_of_range("No documents with id "s + std::to_string(document_id));
     }
     auto &status = documents_.at(document_id).status;
     const auto query = ParseQuery(raw_query);
@@ -124,26 +494,41 @@ std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDoc
         if (word_to_document_freqs_.count(word) == 0) {
             continue;
         }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+        if (word_to_document_freqs_.at(word).Contains(document_id)) {
+            return make_tuple(matched_words, status);
+        }
+    }
+    for (const std::string_view word_view: query.required_words) {
+        const auto word_it = word_to_document_freqs_.find(word_view);
+        if (word_it == word_to_document_freqs_.end() || !word_it->second.Contains(document_id)) {
             return make_tuple(matched_words, status);
         }
     }
+    if (!ContainsPhrases(document_id, query.phrases)) {
+        return make_tuple(matched_words, status);
+    }
     for (const std::string_view word_view: query.plus_words) {
         std::string word(word_view);
         if (word_to_document_freqs_.count(word) == 0) {
             continue;
         }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+        if (word_to_document_freqs_.at(word).Contains(document_id)) {
             matched_words.push_back(word_view);
         }
     }
+    if (!query.required_words.empty()) {
+        const auto plus_words_end = matched_words.insert(matched_words.end(), query.required_words.begin(),
+                                                         query.required_words.end());
+        std::inplace_merge(matched_words.begin(), plus_words_end, matched_words.end());
+    }
     return make_tuple(matched_words, status);
 }
 
 std::tuple <std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(
         const std::execution::parallel_policy &, std::string_view raw_query, int document_id) const {
-    if (!count(document_ids_.begin(), document_ids_.end(), document_id)) {
-        throw std::out_of_range("No documents with id " + document_id);
+    using namespace std::string_literals;
+    if (documents_.count(document_id) == 0) {
+        throw std::out_of_range("No documents with id "s + std::to_string(document_id));
     }
     auto &status = documents_.at(document_id).status;
     const auto query = ParseQuery(raw_query);
@@ -153,12 +538,16 @@ std::tuple <std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDo
     const auto word_checker = [this, document_id](std::string_view word_view) {
         std::string word(word_view);
         const auto &item = word_to_document_freqs_.find(word);
-        return item != word_to_document_freqs_.end() && item->second.count(document_id);
+        return item != word_to_document_freqs_.end() && item->second.Contains(document_id);
     };
 
     if (any_of(query.minus_words.begin(), query.minus_words.end(), word_checker)) {
         return make_tuple(matched_words, status);
     }
+    if (!all_of(query.required_words.begin(), query.required_words.end(), word_checker)
+        || !ContainsPhrases(document_id, query.phrases)) {
+        return make_tuple(matched_words, status);
+    }
 
     matched_words.resize(query.plus_words.size());
     auto matched_words_end = copy_if(
@@ -168,10 +557,103 @@ std::tuple <std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDo
             word_checker
     );
     matched_words.erase(matched_words_end, matched_words.end());
+    if (!query.required_words.empty()) {
+        const auto plus_words_end = matched_words.insert(matched_words.end(), query.required_words.begin(),
+                                                         query.required_words.end());
+        std::inplace_merge(matched_words.begin(), plus_words_end, matched_words.end());
+    }
 
     return make_tuple(matched_words, status);
 }
 
+std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>>
+SearchServer::MatchDocuments(std::string_view raw_query, const std::vector<int> &document_ids) const {
+    return MatchDocuments(std::execution::seq, raw_query, document_ids);
+}
+
+std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>>
+SearchServer::MatchDocuments(const std::execution::sequenced_policy &, std::string_view raw_query,
+                             const std::vector<int> &document_ids) const {
+    CheckDocumentsExist(document_ids);
+    const auto query = ParseQuery(raw_query);
+
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> results;
+    results.reserve(document_ids.size());
+    for (const int document_id: document_ids) {
+        results.push_back(MatchQuery(query, document_id));
+    }
+    return results;
+}
+
+std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>>
+SearchServer::MatchDocuments(const std::execution::parallel_policy &, std::string_view raw_query,
+                             const std::vector<int> &document_ids) const {
+    // Исключение внутри параллельного алгоритма завершило бы программу, поэтому id проверяются заранее
+    CheckDocumentsExist(document_ids);
+    const auto query = ParseQuery(raw_query);
+
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> results(document_ids.size());
+    std::transform(std::execution::par, document_ids.begin(), document_ids.end(), results.begin(),
+                   [this, &query](int document_id) {
+                       return MatchQuery(query, document_id);
+                   });
+    return results;
+}
+
+void SearchServer::CheckDocumentsExist(const std::vector<int> &document_ids) const {
+    using namespace std::string_literals;
+
+    for (const int document_id: document_ids) {
+        if (documents_.count(document_id) == 0) {
+            throw std::out_of_range("No documents with id "s + std::to_string(document_id));
+        }
+    }
+}
+
+namespace {
+
+// Дописывает в matched_words слова документа, встречающиеся среди упорядоченных query_words
+template<typename QueryWords>
+void IntersectWithDocumentWords(const QueryWords &query_words,
+                                const std::map<std::string_view, double> &document_word_freqs,
+                                std::vector<std::string_view> &matched_words) {
+    auto query_word_it = query_words.begin();
+    auto document_word_it = document_word_freqs.begin();
+    while (query_word_it != query_words.end() && document_word_it != document_word_freqs.end()) {
+        if (*query_word_it < document_word_it->first) {
+            ++query_word_it;
+        } else if (document_word_it->first < *query_word_it) {
+            ++document_word_it;
+        } else {
+            matched_words.push_back(document_word_it->first);
+            ++query_word_it;
+            ++document_word_it;
+        }
+    }
+}
+
+}  // namespace
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchQuery(const Query &query,
+                                                                                    int document_id) const {
+    const DocumentStatus status = documents_.at(document_id).status;
+    const auto &document_word_freqs = GetWordFrequencies(document_id);
+
+    std::vector<std::string_view> matched_words;
+    IntersectWithDocumentWords(query.minus_words, document_word_freqs, matched_words);
+    if (!matched_words.empty()) {
+        return {std::vector<std::string_view>{}, status};
+    }
+    IntersectWithDocumentWords(query.required_words, document_word_freqs, matched_words);
+    if (matched_words.size() != query.required_words.size() || !ContainsPhrases(document_id, query.phrases)) {
+        return {std::vector<std::string_view>{}, status};
+    }
+    const size_t required_words_count = matched_words.size();
+    IntersectWithDocumentWords(query.plus_words, document_word_freqs, matched_words);
+    std::inplace_merge(matched_words.begin(), matched_words.begin() + required_words_count, matched_words.end());
+    return {matched_words, status};
+}
+
 bool SearchServer::IsStopWord(std::string_view word) const {
     return stop_words_.count(word) > 0;
 }
@@ -219,21 +701,116 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) cons
     }
 
     bool is_minus = false;
+    bool is_required = false;
     if (text[0] == '-') {
         is_minus = true;
         text.remove_prefix(1);
+    } else if (text[0] == '+') {
+        is_required = true;
+        text.remove_prefix(1);
     }
-    if (text.empty() || text[0] == '-' || !IsValidWord(text)) {
+    int fuzzy_distance = 0;
+    const size_t tilde_pos = text.rfind('~');
+    if (tilde_pos != std::string_view::npos) {
+        const std::string_view distance = text.substr(tilde_pos + 1);
+        if (distance.empty()) {
+            fuzzy_distance = 1;
+        } else if (distance.size() == 1 && distance[0] >= '1' && distance[0] - '0' <= MAX_FUZZY_DISTANCE) {
+            fuzzy_distance = distance[0] - '0';
+        } else if (distance.find_first_not_of("0123456789") == std::string_view::npos) {
+            throw std::invalid_argument("Fuzzy distance of "s + std::string(text) + " is out of range"s);
+        }
+        if (fuzzy_distance > 0) {
+            text.remove_suffix(distance.size() + 1);
+        }
+    }
+    const bool is_prefix = !text.empty() && text.back() == '*';
+    if (is_prefix) {
+        text.remove_suffix(1);
+    }
+    if (text.empty() || text[0] == '-' || text[0] == '+' || !IsValidWord(text) || (is_prefix && fuzzy_distance > 0)) {
         throw std::invalid_argument("Query word "s + std::string(text) + " is invalid");
     }
 
-    return {text, is_minus, IsStopWord(text)};
+    const bool is_pattern = is_prefix || fuzzy_distance > 0;
+    return {text, is_minus, is_required, !is_pattern && IsStopWord(text), is_prefix, fuzzy_distance};
+}
+
+void SearchServer::ExpandFuzzyWord(std::string_view word, int max_distance, size_t max_expansions,
+                                   std::pmr::vector<std::string_view> &words) const {
+    struct Expansion {
+        std::string_view word;
+        int distance;
+        size_t document_count;
+    };
+    std::pmr::vector<Expansion> expansions(words.get_allocator().resource());
+    const LevenshteinAutomaton automaton(word, max_distance);
+
+    const auto candidates = use_trigram_index_ ? trigram_index_.FindCandidates(word, max_distance) : std::nullopt;
+    if (candidates) {
+        for (const std::string_view candidate: *candidates) {
+            const int distance = automaton.GetDistance(candidate);
+            if (distance <= max_distance) {
+                expansions.push_back({candidate, distance, word_to_document_freqs_.at(candidate).GetSize()});
+            }
+        }
+    } else {
+        ForEachFuzzyMatch(automaton, word_to_document_freqs_, [&expansions](const auto &word_freqs, int distance) {
+            expansions.push_back({word_freqs.first, distance, word_freqs.second.GetSize()});
+        });
+    }
+
+    if (expansions.size() > max_expansions) {
+        std::nth_element(expansions.begin(), expansions.begin() + max_expansions, expansions.end(),
+                         [](const Expansion &lhs, const Expansion &rhs) {
+                             return std::tie(lhs.distance, rhs.document_count, lhs.word)
+                                    < std::tie(rhs.distance, lhs.document_count, rhs.word);
+                         });
+        expansions.resize(max_expansions);
+    }
+    for (const Expansion &expansion: expansions) {
+        words.push_back(expansion.word);
+    }
 }
 
-SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool remove_duplicates) const {
-    Query result;
-    const auto word_view_vector = SplitIntoWords(text);
-    if (word_view_vector.empty()) {
+void SearchServer::ExpandQueryWord(const QueryWord &query_word, std::pmr::vector<std::string_view> &words) const {
+    // Исключаются все подходящие слова, иначе в выдачу попадут документы с редкими из них
+    const size_t vocabulary_size = word_to_document_freqs_.size();
+    if (query_word.is_prefix) {
+        ExpandPrefix(query_word.data, query_word.is_minus ? vocabulary_size : MAX_PREFIX_EXPANSIONS, words);
+    } else {
+        ExpandFuzzyWord(query_word.data, query_word.fuzzy_distance,
+                        query_word.is_minus ? vocabulary_size : MAX_FUZZY_EXPANSIONS, words);
+    }
+}
+
+void SearchServer::ExpandPrefix(std::string_view prefix, size_t max_expansions,
+                                std::pmr::vector<std::string_view> &words) const {
+    std::pmr::vector<std::pair<std::string_view, size_t>> expansions(words.get_allocator().resource());
+    for (auto word_it = word_to_document_freqs_.lower_bound(prefix);
+         word_it != word_to_document_freqs_.end() && word_it->first.substr(0, prefix.size()) == prefix; ++word_it) {
+        expansions.emplace_back(word_it->first, word_it->second.GetSize());
+    }
+    if (expansions.size() > max_expansions) {
+        std::nth_element(expansions.begin(), expansions.begin() + max_expansions, expansions.end(),
+                         [](const auto &lhs, const auto &rhs) {
+                             return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+                         });
+        expansions.resize(max_expansions);
+    }
+    for (const auto &[word, _]: expansions) {
+        words.push_back(word);
+    }
+}
+
+SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool remove_duplicates,
+                                             std::pmr::memory_resource *resource) const {
+    using namespace std::string_literals;
+    TRACE_SCOPE("ParseQuery");
+
+    Query result(resource);
+    const auto word_view_vector = SplitQueryIntoWords(text, result.phrases);
+    if (word_view_vector.empty() && result.phrases.empty()) {
         throw std::invalid_argument("Bad request");
     }
 
@@ -242,15 +819,33 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool remove_
 
     for (auto word_it: word_view_vector) {
         const auto query_word = ParseQueryWord(word_it);
-        if (!query_word.is_stop) {
+        if (query_word.is_prefix || query_word.fuzzy_distance > 0) {
+            if (query_word.is_required) {
+                throw std::invalid_argument("Query word "s + std::string(word_it) + " can't be required"s);
+            }
+            ExpandQueryWord(query_word, query_word.is_minus ? result.minus_words : result.plus_words);
+        } else if (!query_word.is_stop) {
             if (query_word.is_minus) {
                 result.minus_words.push_back(query_word.data);
+            } else if (query_word.is_required) {
+                result.required_words.push_back(query_word.data);
             } else {
                 result.plus_words.push_back(query_word.data);
             }
         }
     }
 
+    for (const QueryPhrase &phrase: result.phrases) {
+        if (phrase.words.size() > 1 && !use_positional_index_) {
+            throw std::invalid_argument("Phrase search requires the positional index"s);
+        }
+        result.required_words.insert(result.required_words.end(), phrase.words.begin(), phrase.words.end());
+    }
+    // Фразе из одного слова достаточно обязательного слова
+    result.phrases.erase(std::remove_if(result.phrases.begin(), result.phrases.end(), [](const QueryPhrase &phrase) {
+        return phrase.words.size() < 2;
+    }), result.phrases.end());
+
     if (remove_duplicates) {
         std::sort(result.plus_words.begin(), result.plus_words.end());
         std::sort(result.minus_words.begin(), result.minus_words.end());
@@ -258,6 +853,17 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool remove_
                                 result.plus_words.end());
         result.minus_words.erase(std::unique(result.minus_words.begin(), result.minus_words.end()),
                                  result.minus_words.end());
+        if (!result.required_words.empty()) {
+            std::sort(result.required_words.begin(), result.required_words.end());
+            result.required_words.erase(std::unique(result.required_words.begin(), result.required_words.end()),
+                                        result.required_words.end());
+            // Обязательное слово уже учтено, повторять его среди необязательных не нужно
+            result.plus_words.erase(std::remove_if(result.plus_words.begin(), result.plus_words.end(),
+                                                   [&result](std::string_view word) {
+                                                       return std::binary_search(result.required_words.begin(),
+                                                                                 result.required_words.end(), word);
+                                                   }), result.plus_words.end());
+        }
     }
     //result.plus_words.shrink_to_fit();
     //result.minus_words.shrink_to_fit();
@@ -265,7 +871,313 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool remove_
     return result;
 }
 
-double SearchServer::ComputeWordInverseDocumentFreq(const std::string &word) const {
-    return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
+double SearchServer::ComputeWordInverseDocumentFreq(const PostingList &postings) const {
+    return log(GetDocumentCount() * 1.0 / postings.GetSize());
 }
 
+std::pmr::vector<std::string_view> SearchServer::SplitQueryIntoWords(std::string_view text,
+                                                                     std::pmr::vector<QueryPhrase> &phrases) const {
+    using namespace std::string_literals;
+
+    std::pmr::vector<std::string_view> words(phrases.get_allocator().resource());
+    if (text.find('"') == std::string_view::npos) {
+        SplitIntoWords(text, words);
+        return words;
+    }
+
+    // Пробелы по краям отделяют слова от фраз
+    const auto append_words = [&words](std::string_view segment) {
+        const size_t first = segment.find_first_not_of(' ');
+        if (first == std::string_view::npos) {
+            return;
+        }
+        SplitIntoWords(segment.substr(first, segment.find_last_not_of(' ') - first + 1), words);
+    };
+
+    while (!text.empty()) {
+        const size_t opening_quote = text.find('"');
+        append_words(text.substr(0, opening_quote));
+        if (opening_quote == std::string_view::npos) {
+            break;
+        }
+        const size_t closing_quote = text.find('"', opening_quote + 1);
+        if (closing_quote == std::string_view::npos) {
+            throw std::invalid_argument("Unbalanced quotes in query"s);
+        }
+
+        QueryPhrase phrase;
+        for (const std::string_view word: SplitIntoWords(
+                text.substr(opening_quote + 1, closing_quote - opening_quote - 1))) {
+            if (word.empty()) {
+                continue;
+            }
+            const auto query_word = ParseQueryWord(word);
+            if (query_word.is_minus || query_word.is_required || query_word.is_prefix
+                || query_word.fuzzy_distance > 0) {
+                throw std::invalid_argument("Phrase word "s + std::string(word) + " is invalid"s);
+            }
+            if (!query_word.is_stop) {
+                phrase.words.push_back(query_word.data);
+            }
+        }
+        text.remove_prefix(closing_quote + 1);
+
+        if (!text.empty() && text[0] == '~') {
+            const size_t digits_end = std::min(text.find_first_not_of("0123456789", 1), text.size());
+            if (digits_end == 1 || digits_end > 5) {
+                throw std::invalid_argument("Phrase proximity must be a small number"s);
+            }
+            phrase.slop = std::stoi(std::string(text.substr(1, digits_end - 1)));
+            text.remove_prefix(digits_end);
+        }
+        if (!text.empty() && text[0] != ' ') {
+            throw std::invalid_argument("Phrase must be followed by a space"s);
+        }
+        phrases.push_back(std::move(phrase));
+    }
+    return words;
+}
+
+bool SearchServer::ContainsPhrases(int document_id, const std::pmr::vector<QueryPhrase> &phrases) const {
+    return std::all_of(phrases.begin(), phrases.end(), [this, document_id](const QueryPhrase &phrase) {
+        return positional_index_.ContainsPhrase(document_id, phrase.words, phrase.slop);
+    });
+}
+
+SearchServer::QueryPlan SearchServer::PlanQuery(const Query &query) const {
+    TRACE_SCOPE("PlanQuery");
+    QueryPlan plan(query.plus_words.get_allocator().resource());
+    plan.phrases = query.phrases;
+
+    plan.plus_words.reserve(query.plus_words.size());
+    for (const std::string_view word: query.plus_words) {
+        const auto word_it = word_to_document_freqs_.find(word);
+        if (word_it == word_to_document_freqs_.end() || word_it->second.IsEmpty()) {
+            continue;
+        }
+        plan.plus_words.push_back({word_it->first, &word_it->second, ComputeWordInverseDocumentFreq(word_it->second)});
+        plan.estimated_postings += word_it->second.GetSize();
+    }
+    const auto by_document_count = [](const PlannedWord &lhs, const PlannedWord &rhs) {
+        return lhs.postings->GetSize() < rhs.postings->GetSize();
+    };
+    std::sort(plan.plus_words.begin(), plan.plus_words.end(), by_document_count);
+
+    plan.required_words.reserve(query.required_words.size());
+    for (const std::string_view word: query.required_words) {
+        const auto word_it = word_to_document_freqs_.find(word);
+        if (word_it == word_to_document_freqs_.end() || word_it->second.IsEmpty()) {
+            plan.is_unsatisfiable = true;
+            return plan;
+        }
+        plan.required_words.push_back({word_it->first, &word_it->second,
+                                       ComputeWordInverseDocumentFreq(word_it->second)});
+    }
+    std::sort(plan.required_words.begin(), plan.required_words.end(), by_document_count);
+
+    for (const std::string_view word: query.minus_words) {
+        const auto word_it = word_to_document_freqs_.find(word);
+        if (word_it == word_to_document_freqs_.end()) {
+            continue;
+        }
+        plan.minus_words.push_back(word_it->first);
+        if (use_word_bitmaps_) {
+            word_to_document_bitmap_.at(word_it->first).ForEach([&plan](uint32_t document_id) {
+                plan.excluded_documents.push_back(static_cast<int>(document_id));
+            });
+        } else {
+            word_it->second.ForEach([&plan](int document_id, double) {
+                plan.excluded_documents.push_back(document_id);
+                return true;
+            });
+        }
+    }
+    // Документы одного слова уже упорядочены
+    if (plan.minus_words.size() > 1) {
+        std::sort(plan.excluded_documents.begin(), plan.excluded_documents.end());
+        plan.excluded_documents.erase(std::unique(plan.excluded_documents.begin(), plan.excluded_documents.end()),
+                                      plan.excluded_documents.end());
+    }
+
+    if (!plan.required_words.empty()) {
+        // Просматривается лишь самый короткий список, остальные слова проверяются поиском в своих списках
+        plan.estimated_postings = plan.required_words.front().postings->GetSize()
+                                  * (plan.required_words.size() + plan.plus_words.size());
+    }
+    plan.is_parallel_worthwhile = plan.required_words.empty() && plan.plus_words.size() > 1
+                                  && plan.estimated_postings >= MIN_POSTINGS_FOR_PARALLEL_SEARCH;
+    return plan;
+}
+
+std::pmr::vector<int> SearchServer::IntersectRequiredWords(const QueryPlan &plan, QueryBudgetTracker &budget_tracker,
+                                                           const DocumentFilter *filter) const {
+    std::pmr::vector<int> document_ids(plan.GetResource());
+    uint64_t allowed_postings = 0;
+    // Возвращает false, когда бюджет исчерпан
+    const auto charge_posting = [&allowed_postings, &budget_tracker]() {
+        if (allowed_postings == 0 && (allowed_postings = budget_tracker.Acquire()) == 0) {
+            return false;
+        }
+        --allowed_postings;
+        return true;
+    };
+
+    if (use_word_bitmaps_) {
+        RoaringBitmap intersection = word_to_document_bitmap_.at(plan.required_words.front().data);
+        for (size_t i = 1; i < plan.required_words.size() && !intersection.IsEmpty(); ++i) {
+            intersection &= word_to_document_bitmap_.at(plan.required_words[i].data);
+        }
+        document_ids.reserve(intersection.GetCardinality());
+        // Битовые карты пересекаются целыми контейнерами, поэтому оплачиваются документы пересечения,
+        // кроме документов из блоков, где фильтру заведомо ничего не подходит
+        int checked_block = -1;
+        bool may_contain_matches = true;
+        intersection.ForEach([this, &plan, &document_ids, &charge_posting, filter, &checked_block,
+                                     &may_contain_matches](uint32_t document_id) {
+            if (filter != nullptr) {
+                const int block = DocumentBlockIndex::GetBlock(static_cast<int>(document_id));
+                if (block != checked_block) {
+                    checked_block = block;
+                    may_contain_matches = document_blocks_.MayContainMatches(block, *filter);
+                }
+                if (!may_contain_matches) {
+                    return;
+                }
+            }
+            if (!charge_posting()) {
+                return;
+            }
+            if (!plan.IsExcluded(static_cast<int>(document_id))) {
+                document_ids.push_back(static_cast<int>(document_id));
+            }
+        });
+        budget_tracker.Release(allowed_postings);
+        return document_ids;
+    }
+
+    const PlannedWord &rarest_word = plan.required_words.front();
+    document_ids.reserve(rarest_word.postings->GetSize());
+    std::pmr::vector<PostingList::Iterator> postings(plan.GetResource());
+    postings.reserve(plan.required_words.size() - 1);
+    for (size_t i = 1; i < plan.required_words.size(); ++i) {
+        postings.push_back(plan.required_words[i].postings->GetIterator());
+    }
+    // Документы самого редкого слова ищутся в остальных списках продвижением вперёд:
+    // в сжатых списках блоки с меньшими номерами пропускаются без распаковки.
+    // Оплачиваются постинг самого редкого слова и каждое продвижение по остальным спискам
+    const auto add_if_has_all_words = [&plan, &document_ids, &postings, &charge_posting](int document_id, double) {
+        if (!charge_posting()) {
+            return false;
+        }
+        if (plan.IsExcluded(document_id)) {
+            return true;
+        }
+        bool is_exhausted = false;
+        const bool has_all_words = std::all_of(postings.begin(), postings.end(),
+                                               [document_id, &charge_posting, &is_exhausted](
+                                                       PostingList::Iterator &posting) {
+                                                   if (!charge_posting()) {
+                                                       is_exhausted = true;
+                                                       return false;
+                                                   }
+                                                   posting.Advance(document_id);
+                                                   return posting.GetDocument() == document_id;
+                                               });
+        if (has_all_words) {
+            document_ids.push_back(document_id);
+        }
+        return !is_exhausted;
+    };
+    if (filter != nullptr) {
+        ForEachFilteredPosting(rarest_word, *filter, add_if_has_all_words);
+    } else {
+        rarest_word.postings->ForEach(add_if_has_all_words);
+    }
+    budget_tracker.Release(allowed_postings);
+    return document_ids;
+}
+
+std::unique_ptr<PostingIterator> SearchServer::CompileQueryTree(const QueryNode &node) const {
+    using namespace std::string_literals;
+
+    switch (node.type) {
+        case QueryNode::Type::WORD: {
+            const QueryWord query_word = ParseQueryWord(node.word);
+            if (query_word.is_minus || query_word.is_required) {
+                throw std::invalid_argument("Query word "s + std::string(node.word) + " is invalid"s);
+            }
+            if (query_word.is_prefix || query_word.fuzzy_distance > 0) {
+                std::pmr::vector<std::string_view> expansions;
+                ExpandQueryWord(query_word, expansions);
+                if (expansions.empty()) {
+                    return std::make_unique<EmptyIterator>();
+                }
+                std::vector<std::unique_ptr<PostingIterator>> alternatives;
+                for (const std::string_view word: expansions) {
+                    const auto &postings = word_to_document_freqs_.at(word);
+                    alternatives.push_back(
+                            std::make_unique<TermIterator>(postings, ComputeWordInverseDocumentFreq(postings)));
+                }
+                if (alternatives.size() == 1) {
+                    return std::move(alternatives.front());
+                }
+                return std::make_unique<OrIterator>(std::move(alternatives));
+            }
+            if (query_word.is_stop) {
+                return nullptr;
+            }
+            const auto word_it = word_to_document_freqs_.find(query_word.data);
+            if (word_it == word_to_document_freqs_.end() || word_it->second.IsEmpty()) {
+                return std::make_unique<EmptyIterator>();
+            }
+            return std::make_unique<TermIterator>(word_it->second, ComputeWordInverseDocumentFreq(word_it->second));
+        }
+        case QueryNode::Type::AND: {
+            std::vector<std::unique_ptr<PostingIterator>> included;
+            std::vector<std::unique_ptr<PostingIterator>> excluded;
+            for (const QueryNode &child: node.children) {
+                const bool is_negation = child.type == QueryNode::Type::NOT;
+                auto child_iterator = CompileQueryTree(is_negation ? child.children.front() : child);
+                if (child_iterator) {
+                    (is_negation ? excluded : included).push_back(std::move(child_iterator));
+                }
+            }
+            if (included.empty()) {
+                if (!excluded.empty()) {
+                    throw std::invalid_argument("Query can't consist of negations only"s);
+                }
+                return nullptr;
+            }
+            std::unique_ptr<PostingIterator> result = included.size() == 1
+                                                      ? std::move(included.front())
+                                                      : std::make_unique<AndIterator>(std::move(included));
+            if (!excluded.empty()) {
+                result = std::make_unique<AndNotIterator>(std::move(result), excluded.size() == 1
+                                                                             ? std::move(excluded.front())
+                                                                             : std::make_unique<OrIterator>(
+                                std::move(excluded)));
+            }
+            return result;
+        }
+        case QueryNode::Type::OR: {
+            std::vector<std::unique_ptr<PostingIterator>> alternatives;
+            for (const QueryNode &child: node.children) {
+                auto child_iterator = CompileQueryTree(child);
+                if (child_iterator) {
+                    alternatives.push_back(std::move(child_iterator));
+                }
+            }
+            if (alternatives.empty()) {
+                return nullptr;
+            }
+            if (alternatives.size() == 1) {
+                return std::move(alternatives.front());
+            }
+            return std::make_unique<OrIterator>(std::move(alternatives));
+        }
+        case QueryNode::Type::NOT:
+            break;
+    }
+    // Отрицание задаёт множество документов только в паре с тем, из чего исключать
+    throw std::invalid_argument("Negation must be combined with other words by AND"s);
+}
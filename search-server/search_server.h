@@ -1,25 +1,77 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <exception>
 #include <execution>
+#include <limits>
 #include <list>
 #include <map>
+#include <optional>
+#include <memory_resource>
 #include <set>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <cmath>
 
 #include "concurrent_map.h"
 #include "document.h"
+#include "document_filter.h"
+#include "fuzzy_search.h"
+#include "impact_list.h"
 #include "log_duration.h"
+#include "metrics.h"
+#include "positional_index.h"
+#include "posting_list.h"
+#include "quantized_index.h"
+#include "query_budget.h"
+#include "query_stats.h"
+#include "query_tree.h"
+#include "roaring_bitmap.h"
+#include "scratch_arena.h"
+#include "search_cursor.h"
+#include "simd_kernels.h"
 #include "string_processing.h"
+#include "term_set_fingerprint.h"
+#include "top_documents.h"
+#include "tracing.h"
 
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
-const double EPSILON = 1e-6;
+// Меньшие запросы быстрее обработать в одном потоке, чем распределять по нескольким
+const uint64_t MIN_POSTINGS_FOR_PARALLEL_SEARCH = 20000;
+// Префикс "cat*" заменяется не более чем этим числом самых частых слов словаря
+const size_t MAX_PREFIX_EXPANSIONS = 50;
+// Нечёткое слово "cat~" или "cat~2" заменяется не более чем этим числом ближайших слов словаря
+const size_t MAX_FUZZY_EXPANSIONS = 50;
+const int MAX_FUZZY_DISTANCE = 2;
+// Слова, встречающиеся хотя бы в стольких документах, получают список документов по убыванию вклада
+const size_t MIN_DOCUMENTS_FOR_IMPACT_LIST = 1000;
+// Запросы из большего числа слов быстрее обработать полным просмотром
+const size_t MAX_WORDS_FOR_IMPACT_SEARCH = 3;
+
+// Отбор документов по статусу. В отличие от произвольного предиката, применяется ко всем
+// документам сразу, а не к каждому по отдельности
+struct DocumentStatusPredicate {
+    DocumentStatus status;
+
+    bool operator()(int, DocumentStatus document_status, int) const {
+        return document_status == status;
+    }
+};
+
+// Что делать с документом, набор слов которого совпадает с набором слов документа с меньшим id
+enum class DuplicatePolicy {
+    // Не добавлять такой документ
+    REJECT,
+    // Добавить и пометить как дубликат
+    FLAG,
+};
 
 class SearchServer {
 public:
@@ -39,6 +91,13 @@ public:
     std::vector<Document>
     FindTopDocuments(ExecutionPolicy &&policy, std::string_view raw_query, DocumentPredicate document_predicate) const;
 
+    // Обход индекса прекращается при исчерпании бюджета, тогда возвращаются лучшие из уже найденных
+    // документов, а is_partial выставляется в true
+    template<typename ExecutionPolicy, typename DocumentPredicate>
+    std::vector<Document>
+    FindTopDocuments(ExecutionPolicy &&policy, std::string_view raw_query, DocumentPredicate document_predicate,
+                     const QueryBudget &budget, bool &is_partial) const;
+
     template<typename DocumentPredicate>
     std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate) const;
 
@@ -53,6 +112,60 @@ public:
 
     std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
 
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, const QueryBudget &budget,
+                                           bool &is_partial) const;
+
+    // Записывают выдачу в result, переиспользуя его память. Разбор, планирование и обход индекса
+    // идут в арене потока, поэтому повторяющиеся запросы из слов не обращаются к куче вовсе
+    template<typename ExecutionPolicy, typename DocumentPredicate>
+    void FindTopDocuments(ExecutionPolicy &&policy, std::string_view raw_query, DocumentPredicate document_predicate,
+                          const QueryBudget &budget, bool &is_partial, std::vector<Document> &result) const;
+
+    template<typename DocumentPredicate>
+    void FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                          std::vector<Document> &result) const;
+
+    void FindTopDocuments(std::string_view raw_query, DocumentStatus status, std::vector<Document> &result) const;
+
+    void FindTopDocuments(std::string_view raw_query, std::vector<Document> &result) const;
+
+    // Выдача как у FindTopDocuments и сведения о том, как она получена
+    template<typename ExecutionPolicy, typename DocumentPredicate>
+    std::vector<Document> FindTopDocumentsWithStats(ExecutionPolicy &&policy, std::string_view raw_query,
+                                                    DocumentPredicate document_predicate, QueryStats &stats) const;
+
+    template<typename DocumentPredicate>
+    std::vector<Document> FindTopDocumentsWithStats(std::string_view raw_query, DocumentPredicate document_predicate,
+                                                    QueryStats &stats) const;
+
+    std::vector<Document> FindTopDocumentsWithStats(std::string_view raw_query, DocumentStatus status,
+                                                    QueryStats &stats) const;
+
+    std::vector<Document> FindTopDocumentsWithStats(std::string_view raw_query, QueryStats &stats) const;
+
+    // Страница из page_size документов, следующих в выдаче за cursor в порядке IsRankedBefore. Из найденных
+    // документов хранятся лишь page_size + 1 лучших после курсора, поэтому глубокая страница обходится как
+    // первая: O(постингов + N log page_size), без сортировки и даже без сбора всей выдачи
+    template<typename DocumentPredicate>
+    SearchPage FindTopDocumentsPage(std::string_view raw_query, DocumentPredicate document_predicate,
+                                    const SearchCursor &cursor, size_t page_size) const;
+
+    SearchPage FindTopDocumentsPage(std::string_view raw_query, DocumentStatus status, const SearchCursor &cursor,
+                                    size_t page_size) const;
+
+    SearchPage FindTopDocumentsPage(std::string_view raw_query, const SearchCursor &cursor, size_t page_size) const;
+
+    BudgetStatistics GetBudgetStatistics() const;
+
+    // Булев запрос из слов, операций AND, OR, NOT (или '-' перед словом) и скобок, например
+    // "(cat OR dog) AND curly -hair". Стоящие рядом операнды соединяются через AND
+    template<typename DocumentPredicate>
+    std::vector<Document>
+    FindTopDocumentsByBooleanQuery(std::string_view raw_query, DocumentPredicate document_predicate) const;
+
+    std::vector<Document> FindTopDocumentsByBooleanQuery(std::string_view raw_query, DocumentStatus status) const;
+
+    std::vector<Document> FindTopDocumentsByBooleanQuery(std::string_view raw_query) const;
 
     int GetDocumentCount() const;
 
@@ -83,6 +196,63 @@ public:
                                                                             std::string_view raw_query,
                                                                             int document_id) const;
 
+    // Результаты MatchDocument для документов document_ids в том же порядке. Запрос разбирается один раз,
+    // а его упорядоченные слова сопоставляются со словами документа за один проход слиянием
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>>
+    MatchDocuments(std::string_view raw_query, const std::vector<int> &document_ids) const;
+
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>>
+    MatchDocuments(const std::execution::sequenced_policy &, std::string_view raw_query,
+                   const std::vector<int> &document_ids) const;
+
+    // Документы сопоставляются параллельно
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>>
+    MatchDocuments(const std::execution::parallel_policy &, std::string_view raw_query,
+                   const std::vector<int> &document_ids) const;
+
+    // Дополнительно хранить для каждого слова битовую карту содержащих его документов.
+    // Ускоряет операции над множествами документов, например исключение документов с минус-словами
+    void EnableWordBitmaps();
+
+    // Хранить позиции слов в документах. Нужно для поиска фраз: "curly hair" требует, чтобы слова
+    // стояли подряд, "curly hair"~2 допускает между ними до двух других слов
+    void EnablePositionalIndex();
+
+    // Индекс триграмм словаря: нечёткие слова запроса ищутся по кандидатам из него, а не обходом словаря
+    void EnableTrigramIndex();
+
+    // Упорядоченные по вкладу списки документов частых слов. Запросы из нескольких слов без обязательных
+    // слов и фраз обходят их от лучших документов и останавливаются, как только лучшие пять найдены
+    void EnableImpactLists(size_t min_documents = MIN_DOCUMENTS_FOR_IMPACT_LIST);
+
+    // Запросы без обязательных слов и фраз ранжируются по 16-битным вкладам без обхода деревьев и вычислений
+    // в double. TF слова округляется с шагом min(1, 2 * наибольший TF слова) / 65535: абсолютная погрешность TF
+    // не больше половины шага (не больше 7.7e-6), но TF меньше половины шага поднимается до целого шага, так что
+    // относительная погрешность малых TF может быть большой. Остальные виды поиска и MatchDocument используют
+    // точные TF, которые списки хранят рядом с вкладами вместо std::map.
+    // Сжатию списков (EnableCompressedPostings) квантованные списки не подлежат
+    void EnableQuantizedImpacts();
+
+    size_t GetQuantizedIndexMemoryUsage() const;
+
+    // Списки документов слов хранятся только сжатыми: все виды поиска идут по ним, а пересечение
+    // обязательных слов пропускает целые блоки
+    void EnableCompressedPostings();
+
+    size_t GetCompressedPostingsMemoryUsage() const;
+
+    // Проверять дубликаты при добавлении за время, пропорциональное длине документа, по отпечаткам наборов
+    // слов. Как и в RemoveDuplicates, из документов с одинаковым набором слов остаётся документ с меньшим id:
+    // при REJECT AddDocument бросает invalid_argument для документа с большим id, а добавление документа
+    // с меньшим id удаляет прежние. Уже имеющиеся дубликаты при REJECT удаляются сразу
+    void EnableDuplicateDetection(DuplicatePolicy policy);
+
+    // Есть ли документ с тем же набором слов и меньшим id. Требует EnableDuplicateDetection
+    bool IsDuplicate(int document_id) const;
+
+    // Документы, для которых IsDuplicate возвращает true, по возрастанию id
+    std::vector<int> GetDuplicates() const;
+
     std::set<std::string, std::less<>> GetStopWords() {
         return stop_words_;
     }
@@ -94,10 +264,32 @@ private:
         DocumentStatus status;
     };
     std::set<std::string, std::less<>> stop_words_;
-    std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
+    // Хранилище слов индекса: ключи словарей ниже ссылаются на его строки, а не на тексты документов,
+    // поэтому удаление документа не оставляет висячих ссылок у слов, встречающихся в других документах
+    std::set<std::string, std::less<>> words_;
+    std::map<std::string_view, PostingList> word_to_document_freqs_;
     std::map<int, std::map<std::string_view, double>> document_to_word_freqs_;
     std::map<int, DocumentData> documents_;
     std::set<int> document_ids_;
+    mutable BudgetCounters budget_counters_;
+    bool use_word_bitmaps_ = false;
+    std::map<std::string_view, RoaringBitmap> word_to_document_bitmap_;
+    bool use_positional_index_ = false;
+    PositionalIndex positional_index_;
+    bool use_trigram_index_ = false;
+    TrigramIndex trigram_index_;
+    bool use_impact_lists_ = false;
+    size_t min_documents_for_impact_list_ = MIN_DOCUMENTS_FOR_IMPACT_LIST;
+    std::map<std::string_view, ImpactList> word_to_impacts_;
+    bool use_quantized_impacts_ = false;
+    QuantizedIndex quantized_index_;
+    bool use_compressed_postings_ = false;
+    // Сводка рейтингов и статусов по блокам id для DocumentFilter
+    DocumentBlockIndex document_blocks_;
+    std::optional<DuplicatePolicy> duplicate_policy_;
+    std::map<int, TermSetFingerprint> document_to_fingerprint_;
+    // Документы с одинаковым набором слов, первый из них — оригинал
+    std::unordered_map<TermSetFingerprint, std::set<int>, TermSetFingerprintHasher> fingerprint_to_documents_;
 
     bool IsStopWord(std::string_view word) const;
 
@@ -110,31 +302,178 @@ private:
     struct QueryWord {
         std::string_view data;
         bool is_minus;
+        bool is_required;
         bool is_stop;
+        // Слово с '*' на конце, data — префикс без '*'
+        bool is_prefix;
+        // Для "cat~" и "cat~2" — допустимое расстояние редактирования, для обычных слов 0
+        int fuzzy_distance;
     };
 
     QueryWord ParseQueryWord(std::string_view text) const;
 
+    // Добавляет в words слова индекса, начинающиеся с prefix: при превышении max_expansions —
+    // самые частые из них. Словарь упорядочен, поэтому поиск занимает O(log N + число подходящих слов)
+    void ExpandPrefix(std::string_view prefix, size_t max_expansions, std::pmr::vector<std::string_view> &words) const;
+
+    // Добавляет в words слова индекса на расстоянии не больше max_distance от word: при превышении
+    // max_expansions — ближайшие, а из равноудалённых самые частые
+    void ExpandFuzzyWord(std::string_view word, int max_distance, size_t max_expansions,
+                         std::pmr::vector<std::string_view> &words) const;
+
+    // Раскрывает префиксное или нечёткое слово. Исключаемые слова раскрываются без ограничения числа
+    void ExpandQueryWord(const QueryWord &query_word, std::pmr::vector<std::string_view> &words) const;
+
+    struct QueryPhrase {
+        std::vector<std::string_view> words;
+        int slop = 0;
+    };
+
+    // Выделяет из запроса фразы в кавычках, возвращает остальные слова
+    std::pmr::vector<std::string_view> SplitQueryIntoWords(std::string_view text,
+                                                           std::pmr::vector<QueryPhrase> &phrases) const;
+
+    // Векторы запроса и плана размещаются в переданной памяти, обычно в арене запроса
     struct Query {
-        std::vector<std::string_view> plus_words;
-        std::vector<std::string_view> minus_words;
+        explicit Query(std::pmr::memory_resource *resource)
+                : plus_words(resource), minus_words(resource), required_words(resource), phrases(resource) {
+        }
+
+        std::pmr::vector<std::string_view> plus_words;
+        std::pmr::vector<std::string_view> minus_words;
+        // Слова с префиксом '+', которые обязаны встретиться в документе
+        std::pmr::vector<std::string_view> required_words;
+        // Слова фраз также входят в required_words
+        std::pmr::vector<QueryPhrase> phrases;
+    };
+
+    Query ParseQuery(std::string_view text, bool remove_duplicates = true,
+                     std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const;
+
+    double ComputeWordInverseDocumentFreq(const PostingList &postings) const;
+
+    // Слово запроса, найденное в индексе один раз на этапе планирования
+    struct PlannedWord {
+        std::string_view data;
+        const PostingList *postings;
+        double inverse_document_freq;
+    };
+
+    struct QueryPlan {
+        explicit QueryPlan(std::pmr::memory_resource *resource)
+                : plus_words(resource), required_words(resource), phrases(resource), excluded_documents(resource),
+                  minus_words(resource) {
+        }
+
+        // Память, в которой размещаются и промежуточные структуры обхода индекса
+        std::pmr::memory_resource *GetResource() const {
+            return plus_words.get_allocator().resource();
+        }
+
+        bool IsExcluded(int document_id) const {
+            return std::binary_search(excluded_documents.begin(), excluded_documents.end(), document_id);
+        }
+
+        // Плюс-слова по возрастанию длины списка документов: сначала самые селективные
+        std::pmr::vector<PlannedWord> plus_words;
+        // Обязательные слова, также по возрастанию длины списка документов
+        std::pmr::vector<PlannedWord> required_words;
+        std::pmr::vector<QueryPhrase> phrases;
+        // Одного из обязательных слов нет ни в одном документе
+        bool is_unsatisfiable = false;
+        // Документы с минус-словами по возрастанию id, их релевантность не вычисляется вовсе
+        std::pmr::vector<int> excluded_documents;
+        // Минус-слова, встречающиеся в индексе
+        std::pmr::vector<std::string_view> minus_words;
+        uint64_t estimated_postings = 0;
+        bool is_parallel_worthwhile = false;
+        // Задана, если вызывающий запросил сведения о выполнении
+        QueryStats *stats = nullptr;
     };
 
-    Query ParseQuery(std::string_view text, bool remove_duplicates = true) const;
+    // План размещается в той же памяти, что и запрос
+    QueryPlan PlanQuery(const Query &query) const;
+
+    bool ContainsPhrases(int document_id, const std::pmr::vector<QueryPhrase> &phrases) const;
+
+    // Бросает out_of_range, если хотя бы одного документа нет
+    void CheckDocumentsExist(const std::vector<int> &document_ids) const;
+
+    // Слова разобранного запроса, найденные в документе, по списку слов документа
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchQuery(const Query &query, int document_id) const;
+
+    // Документы, содержащие все обязательные слова и ни одного минус-слова, по возрастанию id.
+    // Пересечение начинается с самого короткого списка, поэтому работа пропорциональна его длине.
+    // Каждый просмотренный постинг оплачивается из бюджета, при его исчерпании пересечение обрывается.
+    // С фильтром документы из блоков, где ему заведомо ничего не подходит, пропускаются без проверки
+    std::pmr::vector<int> IntersectRequiredWords(const QueryPlan &plan, QueryBudgetTracker &budget_tracker,
+                                                 const DocumentFilter *filter = nullptr) const;
+
+    template<typename ExecutionPolicy, typename DocumentPredicate>
+    void FindTopDocuments(ExecutionPolicy &&policy, std::string_view raw_query, DocumentPredicate document_predicate,
+                          const QueryBudget &budget, bool &is_partial, std::vector<Document> &result,
+                          QueryStats *stats) const;
+
+    // Возвращает nullptr для поддерева, состоящего только из стоп-слов
+    std::unique_ptr<PostingIterator> CompileQueryTree(const QueryNode &node) const;
+
+    template<typename DocumentPredicate, typename Callback>
+    void ForEachDocumentWithRequiredWords(const QueryPlan &plan, DocumentPredicate document_predicate,
+                                          QueryBudgetTracker &budget_tracker, Callback callback) const;
+
+    void RemoveWordIfUnused(std::string_view word);
+
+    void AddFingerprint(int document_id, const TermSetFingerprint &fingerprint);
+
+    void RemoveFingerprint(int document_id);
+
+    ImpactList MakeImpactList(const PostingList &postings) const;
 
-    // Existence required
-    double ComputeWordInverseDocumentFreq(const std::string &word) const;
+    // Вносит документ в списки вкладов и заводит списки словам, ставшим частыми
+    void AddImpacts(int document_id);
+
+    void RemoveImpacts(int document_id);
+
+    bool IsImpactSearchApplicable(const QueryPlan &plan, const QueryBudget &budget) const;
+
+    // Передаёт callback документы слова из диапазона id фильтра, пропуская блоки id, где фильтру
+    // заведомо ничего не подходит. Обход прекращается, если callback вернул false.
+    // Поиск по спискам вкладов и квантованный поиск блоки не пропускают: первые упорядочены по вкладу,
+    // а не по id, второй обходит все слоты векторно. Там фильтр проверяется лишь для кандидатов в выдачу
+    template<typename Callback>
+    void ForEachFilteredPosting(const PlannedWord &word, const DocumentFilter &filter, Callback callback) const;
+
+    bool IsQuantizedSearchApplicable(const QueryPlan &plan, const QueryBudget &budget) const;
 
     template<typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const Query &query, DocumentPredicate document_predicate) const;
+    std::vector<Document> FindTopDocumentsQuantized(const QueryPlan &plan, DocumentPredicate document_predicate) const;
+
+    // Алгоритм с порогом: списки слов просматриваются параллельно от лучших документов, каждый новый
+    // документ оценивается целиком. Сумма текущих вкладов ограничивает релевантность ещё не встреченных
+    // документов, и обход заканчивается, когда худший из отобранных документов её превосходит
+    template<typename DocumentPredicate>
+    std::vector<Document> FindTopDocumentsByImpacts(const QueryPlan &plan, DocumentPredicate document_predicate) const;
+
+    // Передаёт callback каждый найденный документ с его релевантностью, не собирая их в вектор
+    template<typename DocumentPredicate, typename Callback>
+    void ForEachMatchedDocument(const QueryPlan &plan, DocumentPredicate document_predicate,
+                                QueryBudgetTracker &budget_tracker, Callback callback) const;
 
+    // Найденные документы размещаются в памяти плана
     template<typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy &, const Query &query,
-                                           DocumentPredicate document_predicate) const;
+    std::pmr::vector<Document> FindAllDocuments(const QueryPlan &plan, DocumentPredicate document_predicate,
+                                                QueryBudgetTracker &budget_tracker) const;
 
     template<typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy &, const Query &query,
-                                           DocumentPredicate document_predicate) const;
+    std::pmr::vector<Document> FindAllDocuments(const std::execution::sequenced_policy &, const QueryPlan &plan,
+                                                DocumentPredicate document_predicate,
+                                                QueryBudgetTracker &budget_tracker) const;
+
+    // При малом объёме работы выполняется последовательно
+    template<typename DocumentPredicate>
+    std::pmr::vector<Document> FindAllDocuments(const std::execution::parallel_policy &, const QueryPlan &plan,
+                                                DocumentPredicate document_predicate,
+                                                QueryBudgetTracker &budget_tracker) const;
 };
 
 template<typename StringContainer>
@@ -154,121 +493,531 @@ std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query,
     return SearchServer::FindTopDocuments(std::execution::seq, raw_query, document_predicate);
 }
 
+template<typename DocumentPredicate>
+void SearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                                    std::vector<Document> &result) const {
+    bool is_partial = false;
+    FindTopDocuments(std::execution::seq, raw_query, document_predicate, QueryBudget::Unlimited(), is_partial,
+                     result);
+}
+
 template<typename ExecutionPolicy>
 std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view raw_query) const {
-    return FindTopDocuments(policy, raw_query, [](int document_id, DocumentStatus document_status, int rating) {
-        return document_status == DocumentStatus::ACTUAL;
-    });
+    return FindTopDocuments(policy, raw_query, DocumentStatusPredicate{DocumentStatus::ACTUAL});
 }
 
 template<typename ExecutionPolicy>
 std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view raw_query,
                                                      DocumentStatus status) const {
-    return FindTopDocuments(policy, raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-        return document_status == status;
-    });
+    return FindTopDocuments(policy, raw_query, DocumentStatusPredicate{status});
 }
 
 template<class ExecutionPolicy, class DocumentPredicate>
 std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view raw_query,
                                                      DocumentPredicate document_predicate) const {
-    const auto query = ParseQuery(raw_query);
-    auto matched_documents = FindAllDocuments(policy, query, document_predicate);
-    sort(policy, matched_documents.begin(), matched_documents.end(), [](const Document &lhs, const Document &rhs) {
-        if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
-            return lhs.rating > rhs.rating;
-        } else {
-            return lhs.relevance > rhs.relevance;
+    bool is_partial = false;
+    return FindTopDocuments(policy, raw_query, document_predicate, QueryBudget::Unlimited(), is_partial);
+}
+
+template<class ExecutionPolicy, class DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view raw_query,
+                                                     DocumentPredicate document_predicate,
+                                                     const QueryBudget &budget, bool &is_partial) const {
+    std::vector<Document> result;
+    FindTopDocuments(policy, raw_query, document_predicate, budget, is_partial, result);
+    return result;
+}
+
+template<class ExecutionPolicy, class DocumentPredicate>
+void SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view raw_query,
+                                    DocumentPredicate document_predicate, const QueryBudget &budget,
+                                    bool &is_partial, std::vector<Document> &result) const {
+    FindTopDocuments(policy, raw_query, document_predicate, budget, is_partial, result, nullptr);
+}
+
+template<typename ExecutionPolicy, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocumentsWithStats(ExecutionPolicy &&policy, std::string_view raw_query,
+                                                              DocumentPredicate document_predicate,
+                                                              QueryStats &stats) const {
+    stats = QueryStats{};
+    bool is_partial = false;
+    std::vector<Document> result;
+    FindTopDocuments(policy, raw_query, document_predicate, QueryBudget::Unlimited(), is_partial, result, &stats);
+    return result;
+}
+
+template<typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocumentsWithStats(std::string_view raw_query,
+                                                              DocumentPredicate document_predicate,
+                                                              QueryStats &stats) const {
+    return FindTopDocumentsWithStats(std::execution::seq, raw_query, document_predicate, stats);
+}
+
+template<class ExecutionPolicy, class DocumentPredicate>
+void SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view raw_query,
+                                    DocumentPredicate document_predicate, const QueryBudget &budget,
+                                    bool &is_partial, std::vector<Document> &result, QueryStats *stats) const {
+    METRICS_STOPWATCH(stopwatch, MetricStage::QUERY_TOTAL);
+    QueryStatsStopwatch stats_stopwatch(stats);
+    METRICS_ADD(MetricCounter::QUERIES, 1);
+    TRACE_SCOPE("FindTopDocuments");
+    // Всё размещённое в арене должно быть разрушено до выхода из scratch
+    const ScratchArena::Scope scratch(ScratchArena::ForCurrentThread());
+    const Query query = ParseQuery(raw_query, true, scratch.GetResource());
+    METRICS_LAP(stopwatch, MetricStage::QUERY_PARSE);
+    stats_stopwatch.Lap(&QueryStats::parse_time);
+    auto plan = PlanQuery(query);
+    METRICS_LAP(stopwatch, MetricStage::QUERY_LOOKUP);
+    stats_stopwatch.Lap(&QueryStats::lookup_time);
+    plan.stats = stats;
+    if (stats != nullptr) {
+        stats->plus_words = plan.plus_words.size();
+        stats->required_words = plan.required_words.size();
+        stats->minus_words = plan.minus_words.size();
+    }
+    QueryBudgetTracker budget_tracker(budget);
+    if (IsImpactSearchApplicable(plan, budget)) {
+        budget_counters_.Record(budget, budget_tracker);
+        is_partial = false;
+        const auto top_documents = FindTopDocumentsByImpacts(plan, document_predicate);
+        result.assign(top_documents.begin(), top_documents.end());
+        METRICS_LAP(stopwatch, MetricStage::QUERY_SCORE);
+        stats_stopwatch.Lap(&QueryStats::score_time);
+        if (stats != nullptr) {
+            stats->strategy = QueryStrategy::IMPACTS;
+            stats->results = result.size();
         }
-    });
+        return;
+    }
+    if (IsQuantizedSearchApplicable(plan, budget)) {
+        budget_counters_.Record(budget, budget_tracker);
+        is_partial = false;
+        const auto top_documents = FindTopDocumentsQuantized(plan, document_predicate);
+        result.assign(top_documents.begin(), top_documents.end());
+        METRICS_LAP(stopwatch, MetricStage::QUERY_SCORE);
+        stats_stopwatch.Lap(&QueryStats::score_time);
+        if (stats != nullptr) {
+            stats->strategy = QueryStrategy::QUANTIZED;
+            stats->results = result.size();
+        }
+        return;
+    }
+    auto matched_documents = FindAllDocuments(policy, plan, document_predicate, budget_tracker);
+    METRICS_LAP(stopwatch, MetricStage::QUERY_SCORE);
+    stats_stopwatch.Lap(&QueryStats::score_time);
+    budget_counters_.Record(budget, budget_tracker);
+    is_partial = budget_tracker.IsExhausted();
+    METRICS_ADD(MetricCounter::PARTIAL_QUERIES, is_partial ? 1 : 0);
+    {
+        TRACE_SCOPE("Sort");
+        sort(policy, matched_documents.begin(), matched_documents.end(), IsRankedHigher);
+    }
+    METRICS_LAP(stopwatch, MetricStage::QUERY_SORT);
+    stats_stopwatch.Lap(&QueryStats::sort_time);
 
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+    const size_t result_size = std::min<size_t>(matched_documents.size(), MAX_RESULT_DOCUMENT_COUNT);
+    result.assign(matched_documents.begin(), matched_documents.begin() + result_size);
+    if (stats != nullptr) {
+        if (!plan.required_words.empty() || plan.is_unsatisfiable) {
+            stats->strategy = QueryStrategy::REQUIRED_WORDS;
+        } else if (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::parallel_policy>
+                   && plan.is_parallel_worthwhile) {
+            stats->strategy = QueryStrategy::EXHAUSTIVE_PARALLEL;
+        }
+        stats->scanned_postings = budget_tracker.GetScannedPostings();
+        stats->candidates = matched_documents.size();
+        stats->results = result.size();
+        stats->is_partial = is_partial;
     }
-    return matched_documents;
 }
 
 template<typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const Query &query, DocumentPredicate document_predicate) const {
-    return FindAllDocuments(query, document_predicate);
+SearchPage SearchServer::FindTopDocumentsPage(std::string_view raw_query, DocumentPredicate document_predicate,
+                                              const SearchCursor &cursor, size_t page_size) const {
+    using namespace std::string_literals;
+
+    if (page_size == 0) {
+        throw std::invalid_argument("Page size must be positive"s);
+    }
+    const ScratchArena::Scope scratch(ScratchArena::ForCurrentThread());
+    const auto plan = PlanQuery(ParseQuery(raw_query, true, scratch.GetResource()));
+    QueryBudgetTracker budget_tracker(QueryBudget::Unlimited());
+
+    // Куча с худшим документом на вершине. Документ сверх page_size означает, что страница не последняя.
+    // Найденные документы сразу отсеиваются курсором и кучей и нигде больше не хранятся
+    std::pmr::vector<Document> page(plan.GetResource());
+    page.reserve(page_size + 1);
+    const auto add_to_page = [&cursor, &page, page_size](const Document &document) {
+        if (!cursor.Admits(document)) {
+            return;
+        }
+        if (page.size() <= page_size) {
+            page.push_back(document);
+            std::push_heap(page.begin(), page.end(), IsRankedBefore);
+        } else if (IsRankedBefore(document, page.front())) {
+            std::pop_heap(page.begin(), page.end(), IsRankedBefore);
+            page.back() = document;
+            std::push_heap(page.begin(), page.end(), IsRankedBefore);
+        }
+    };
+    ForEachMatchedDocument(plan, document_predicate, budget_tracker, add_to_page);
+    std::sort_heap(page.begin(), page.end(), IsRankedBefore);
+
+    SearchPage result;
+    result.documents.assign(page.begin(), page.begin() + std::min(page.size(), page_size));
+    if (page.size() > page_size) {
+        result.next_cursor = SearchCursor::After(result.documents.back());
+    }
+    return result;
 }
 
 template<typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy &,
-                                                     const Query &query, DocumentPredicate document_predicate) const {
-    std::map<int, double> document_to_relevance;
-    for (auto word_view: query.plus_words) {
-        if (word_to_document_freqs_.count(word_view) == 0) {
-            continue;
+std::vector<Document> SearchServer::FindTopDocumentsByImpacts(const QueryPlan &plan,
+                                                              DocumentPredicate document_predicate) const {
+    struct Cursor {
+        ImpactList::const_iterator current;
+        ImpactList::const_iterator end;
+        double inverse_document_freq;
+    };
+    // Редкие слова без готового списка упорядочиваются на месте, их документов немного
+    std::list<ImpactList> temporary_lists;
+    std::vector<Cursor> cursors;
+    cursors.reserve(plan.plus_words.size());
+    for (const PlannedWord &word: plan.plus_words) {
+        auto impacts_it = word_to_impacts_.find(word.data);
+        const ImpactList &impacts = impacts_it != word_to_impacts_.end()
+                                    ? impacts_it->second
+                                    : temporary_lists.emplace_back(MakeImpactList(*word.postings));
+        cursors.push_back({impacts.begin(), impacts.end(), word.inverse_document_freq});
+    }
+
+    TopDocuments top_documents(MAX_RESULT_DOCUMENT_COUNT);
+    std::set<int> seen_documents;
+    uint64_t scanned_postings = 0;
+    uint64_t excluded_postings = 0;
+    uint64_t predicate_rejections = 0;
+    while (true) {
+        double threshold = 0.0;
+        bool is_exhausted = true;
+        for (const Cursor &cursor: cursors) {
+            if (cursor.current != cursor.end) {
+                threshold += cursor.current->term_freq * cursor.inverse_document_freq;
+                is_exhausted = false;
+            }
+        }
+        if (is_exhausted || (top_documents.IsFull() && top_documents.GetWorst().relevance - threshold >= EPSILON)) {
+            break;
         }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(std::string(word_view));
-        for (const auto &[document_id, term_freq]: word_to_document_freqs_.at(word_view)) {
+        for (Cursor &cursor: cursors) {
+            if (cursor.current == cursor.end) {
+                continue;
+            }
+            const int document_id = (cursor.current++)->document_id;
+            ++scanned_postings;
+            if (!seen_documents.insert(document_id).second) {
+                continue;
+            }
+            if (plan.IsExcluded(document_id)) {
+                ++excluded_postings;
+                continue;
+            }
             const auto &document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
+            if (!document_predicate(document_id, document_data.status, document_data.rating)) {
+                ++predicate_rejections;
+                continue;
             }
+            double relevance = 0.0;
+            for (const PlannedWord &word: plan.plus_words) {
+                if (const auto term_freq = word.postings->FindTermFreq(document_id)) {
+                    relevance += *term_freq * word.inverse_document_freq;
+                }
+            }
+            top_documents.Add({document_id, relevance, document_data.rating});
         }
     }
+    if (plan.stats != nullptr) {
+        plan.stats->scanned_postings = scanned_postings;
+        plan.stats->excluded_postings = excluded_postings;
+        plan.stats->predicate_rejections = predicate_rejections;
+        plan.stats->candidates = seen_documents.size() - excluded_postings - predicate_rejections;
+    }
+    return top_documents.Extract();
+}
+
+template<typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocumentsQuantized(const QueryPlan &plan,
+                                                              DocumentPredicate document_predicate) const {
+    constexpr bool is_status_predicate = std::is_same_v<DocumentPredicate, DocumentStatusPredicate>;
+
+    std::vector<float> scores(quantized_index_.GetSlotCount(), 0.0f);
+    // Слово из всех документов имеет нулевой IDF: тогда подходит любой документ, иначе — с ненулевой суммой
+    bool matches_all_documents = false;
+    for (const PlannedWord &word: plan.plus_words) {
+        word.postings->GetQuantized()->Accumulate(static_cast<float>(word.inverse_document_freq), scores);
+        matches_all_documents = matches_all_documents || word.postings->GetSize() == documents_.size();
+    }
+    // Исключённые документы получают -inf и не проходят ни один порог
+    for (const std::string_view word: plan.minus_words) {
+        word_to_document_freqs_.at(word).GetQuantized()->Exclude(scores);
+    }
+    if constexpr (is_status_predicate) {
+        quantized_index_.MaskByStatus(document_predicate.status, scores);
+    }
+    std::vector<uint32_t> candidates(scores.size());
+    candidates.resize(GatherCandidates(scores.data(), scores.size(), matches_all_documents ? -1.0f : 0.0f,
+                                       candidates.data()));
 
-    for (const auto &word_view: query.minus_words) {
-        std::string word(word_view);
-        if (word_to_document_freqs_.count(word) == 0) {
+    TopDocuments top_documents(MAX_RESULT_DOCUMENT_COUNT);
+    uint64_t predicate_rejections = 0;
+    size_t accepted_candidates = 0;
+    for (const uint32_t slot: candidates) {
+        const int document_id = quantized_index_.GetDocumentId(slot);
+        if (document_id < 0) {
             continue;
         }
-        for (const auto [document_id, _]: word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+        const auto &document_data = documents_.at(document_id);
+        if constexpr (!is_status_predicate) {
+            if (!document_predicate(document_id, document_data.status, document_data.rating)) {
+                ++predicate_rejections;
+                continue;
+            }
+        }
+        top_documents.Add({document_id, scores[slot], document_data.rating});
+        ++accepted_candidates;
+    }
+    if (plan.stats != nullptr) {
+        for (const PlannedWord &word: plan.plus_words) {
+            plan.stats->scanned_postings += word.postings->GetSize();
         }
+        plan.stats->predicate_rejections = predicate_rejections;
+        plan.stats->candidates = accepted_candidates;
+    }
+    return top_documents.Extract();
+}
+
+template<typename DocumentPredicate>
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const QueryPlan &plan, DocumentPredicate document_predicate,
+                                                          QueryBudgetTracker &budget_tracker) const {
+    return FindAllDocuments(std::execution::seq, plan, document_predicate, budget_tracker);
+}
+
+template<typename DocumentPredicate>
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy &,
+                                                          const QueryPlan &plan, DocumentPredicate document_predicate,
+                                                          QueryBudgetTracker &budget_tracker) const {
+    std::pmr::vector<Document> matched_documents(plan.GetResource());
+    ForEachMatchedDocument(plan, document_predicate, budget_tracker, [&matched_documents](const Document &document) {
+        matched_documents.push_back(document);
+    });
+    return matched_documents;
+}
+
+template<typename DocumentPredicate, typename Callback>
+void SearchServer::ForEachMatchedDocument(const QueryPlan &plan, DocumentPredicate document_predicate,
+                                          QueryBudgetTracker &budget_tracker, Callback callback) const {
+    if (plan.is_unsatisfiable) {
+        return;
+    }
+    if (!plan.required_words.empty()) {
+        ForEachDocumentWithRequiredWords(plan, document_predicate, budget_tracker, callback);
+        return;
+    }
+
+    std::pmr::map<int, double> document_to_relevance(plan.GetResource());
+    uint64_t excluded_postings = 0;
+    uint64_t predicate_rejections = 0;
+    for (const PlannedWord &word: plan.plus_words) {
+        TRACE_SCOPE("FindAllDocuments word");
+        uint64_t allowed_postings = 0;
+        // Возвращает false, когда бюджет исчерпан
+        const auto add_posting = [&](int document_id, double term_freq) {
+            if (allowed_postings == 0 && (allowed_postings = budget_tracker.Acquire()) == 0) {
+                return false;
+            }
+            --allowed_postings;
+            if (plan.IsExcluded(document_id)) {
+                ++excluded_postings;
+                return true;
+            }
+            const auto &document_data = documents_.at(document_id);
+            if (document_predicate(document_id, document_data.status, document_data.rating)) {
+                document_to_relevance[document_id] += term_freq * word.inverse_document_freq;
+            } else {
+                ++predicate_rejections;
+            }
+            return true;
+        };
+        if constexpr (std::is_same_v<DocumentPredicate, DocumentFilter>) {
+            ForEachFilteredPosting(word, document_predicate, add_posting);
+        } else {
+            word.postings->ForEach(add_posting);
+        }
+        budget_tracker.Release(allowed_postings);
+        if (budget_tracker.IsExhausted()) {
+            break;
+        }
+    }
+    if (plan.stats != nullptr) {
+        plan.stats->excluded_postings = excluded_postings;
+        plan.stats->predicate_rejections = predicate_rejections;
     }
 
-    std::vector<Document> matched_documents;
     for (const auto [document_id, relevance]: document_to_relevance) {
-        matched_documents.push_back({document_id, relevance, documents_.at(document_id).rating});
+        callback(Document{document_id, relevance, documents_.at(document_id).rating});
+    }
+}
+
+template<typename Callback>
+void SearchServer::ForEachFilteredPosting(const PlannedWord &word, const DocumentFilter &filter,
+                                          Callback callback) const {
+    constexpr int VISIT_BLOCK = -1;
+    constexpr int STOP = -2;
+    const int max_document_id = filter.GetMaxDocumentId();
+    // Для блока, который можно пропустить, — начало следующего блока
+    auto get_skip_target = [this, &filter, checked_block = -1](int document_id) mutable {
+        const int block = DocumentBlockIndex::GetBlock(document_id);
+        if (block == checked_block || document_blocks_.MayContainMatches(block, filter)) {
+            checked_block = block;
+            return VISIT_BLOCK;
+        }
+        const int next_block_start = DocumentBlockIndex::GetNextBlockStart(block);
+        return next_block_start < 0 ? STOP : next_block_start;
+    };
+
+    auto posting = word.postings->GetIterator();
+    posting.Advance(filter.GetMinDocumentId());
+    while (posting.GetDocument() != PostingList::END && posting.GetDocument() <= max_document_id) {
+        const int skip_target = get_skip_target(posting.GetDocument());
+        if (skip_target == STOP) {
+            return;
+        }
+        if (skip_target != VISIT_BLOCK) {
+            posting.Advance(skip_target);
+            continue;
+        }
+        if (!callback(posting.GetDocument(), posting.GetTermFreq())) {
+            return;
+        }
+        posting.Next();
     }
-    return matched_documents;
 }
 
 template<typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy &,
-                                                     const Query &query, DocumentPredicate document_predicate) const {
-    std::vector<std::string_view> words(query.plus_words.size());
-    auto words_end = std::copy_if(
-            std::execution::par,
-            query.plus_words.begin(), query.plus_words.end(),
-            words.begin(),
-            [this](std::string_view word_view) {
-                std::string word(word_view);
-                return word_to_document_freqs_.count(word) && !word_to_document_freqs_.at(word).empty();
-            }
-    );
-    words.erase(words_end, words.end());
-    words.erase(std::remove_if(
-            std::execution::par,
-            words.begin(), words.end(),
-            [this, &query](std::string_view word_view) {
-                std::string word(word_view);
-                return word_to_document_freqs_.count(word) && std::count(query.minus_words.begin(),
-                                                                         query.minus_words.end(), word_view);
+std::vector<Document> SearchServer::FindTopDocumentsByBooleanQuery(std::string_view raw_query,
+                                                                   DocumentPredicate document_predicate) const {
+    const auto documents_iterator = CompileQueryTree(ParseBooleanQuery(raw_query));
+    if (!documents_iterator) {
+        return {};
+    }
+    TopDocuments top_documents(MAX_RESULT_DOCUMENT_COUNT);
+    for (; documents_iterator->GetDocument() != PostingIterator::END; documents_iterator->Next()) {
+        const int document_id = documents_iterator->GetDocument();
+        const auto &document_data = documents_.at(document_id);
+        if (document_predicate(document_id, document_data.status, document_data.rating)) {
+            top_documents.Add({document_id, documents_iterator->GetScore(), document_data.rating});
+        }
+    }
+    return top_documents.Extract();
+}
+
+template<typename DocumentPredicate, typename Callback>
+void SearchServer::ForEachDocumentWithRequiredWords(const QueryPlan &plan, DocumentPredicate document_predicate,
+                                                    QueryBudgetTracker &budget_tracker, Callback callback) const {
+    uint64_t predicate_rejections = 0;
+    const DocumentFilter *filter = nullptr;
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentFilter>) {
+        filter = &document_predicate;
+    }
+    // Документы пересечения идут по возрастанию id, поэтому TF берутся продвижением курсоров по спискам слов,
+    // а не отдельным поиском для каждого документа
+    std::pmr::vector<std::pair<PostingList::Iterator, double>> word_postings(plan.GetResource());
+    word_postings.reserve(plan.required_words.size() + plan.plus_words.size());
+    for (const auto *words: {&plan.required_words, &plan.plus_words}) {
+        for (const PlannedWord &word: *words) {
+            word_postings.emplace_back(word.postings->GetIterator(), word.inverse_document_freq);
+        }
+    }
+    for (const int document_id: IntersectRequiredWords(plan, budget_tracker, filter)) {
+        const auto &document_data = documents_.at(document_id);
+        if (!document_predicate(document_id, document_data.status, document_data.rating)) {
+            ++predicate_rejections;
+            continue;
+        }
+        if (!ContainsPhrases(document_id, plan.phrases)) {
+            continue;
+        }
+        double relevance = 0.0;
+        for (auto &[posting, inverse_document_freq]: word_postings) {
+            posting.Advance(document_id);
+            if (posting.GetDocument() == document_id) {
+                relevance += posting.GetTermFreq() * inverse_document_freq;
             }
-    ), words.end());
+        }
+        callback(Document{document_id, relevance, document_data.rating});
+    }
+    if (plan.stats != nullptr) {
+        plan.stats->predicate_rejections = predicate_rejections;
+    }
+}
+
+template<typename DocumentPredicate>
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy &,
+                                                          const QueryPlan &plan, DocumentPredicate document_predicate,
+                                                          QueryBudgetTracker &budget_tracker) const {
+    if (!plan.is_parallel_worthwhile) {
+        return FindAllDocuments(std::execution::seq, plan, document_predicate, budget_tracker);
+    }
 
     ConcurrentMap<int, double> document_to_relevance_concurent(101u);
+    // Счётчики для статистики складываются один раз на слово
+    std::atomic<uint64_t> excluded_postings{0};
+    std::atomic<uint64_t> predicate_rejections{0};
     std::for_each(
             std::execution::par,
-            words.begin(), words.end(),
-            [this, document_predicate, &document_to_relevance_concurent](std::string_view word_view) {
-                std::string word(word_view);
-                const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-                for (const auto [document_id, term_freq]: word_to_document_freqs_.at(word)) {
+            plan.plus_words.begin(), plan.plus_words.end(),
+            [this, &plan, document_predicate, &document_to_relevance_concurent, &budget_tracker, &excluded_postings,
+                    &predicate_rejections](const PlannedWord &word) {
+                TRACE_SCOPE("FindAllDocuments word");
+                uint64_t allowed_postings = 0;
+                uint64_t word_excluded_postings = 0;
+                uint64_t word_predicate_rejections = 0;
+                const auto add_posting = [&](int document_id, double term_freq) {
+                    if (allowed_postings == 0 && (allowed_postings = budget_tracker.Acquire()) == 0) {
+                        return false;
+                    }
+                    --allowed_postings;
+                    if (plan.IsExcluded(document_id)) {
+                        ++word_excluded_postings;
+                        return true;
+                    }
                     const auto &document_data = documents_.at(document_id);
                     if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                        document_to_relevance_concurent[document_id].ref_to_value += term_freq * inverse_document_freq;
+                        document_to_relevance_concurent[document_id].ref_to_value +=
+                                term_freq * word.inverse_document_freq;
+                    } else {
+                        ++word_predicate_rejections;
                     }
+                    return true;
+                };
+                if constexpr (std::is_same_v<DocumentPredicate, DocumentFilter>) {
+                    ForEachFilteredPosting(word, document_predicate, add_posting);
+                } else {
+                    word.postings->ForEach(add_posting);
+                }
+                budget_tracker.Release(allowed_postings);
+                if (plan.stats != nullptr) {
+                    excluded_postings.fetch_add(word_excluded_postings, std::memory_order_relaxed);
+                    predicate_rejections.fetch_add(word_predicate_rejections, std::memory_order_relaxed);
                 }
             }
     );
+    if (plan.stats != nullptr) {
+        plan.stats->excluded_postings = excluded_postings.load(std::memory_order_relaxed);
+        plan.stats->predicate_rejections = predicate_rejections.load(std::memory_order_relaxed);
+    }
 
     const auto &document_to_relevance_ordinary = document_to_relevance_concurent.BuildOrdinaryMap();
-    std::vector<Document> matched_documents(document_to_relevance_ordinary.size());
+    std::pmr::vector<Document> matched_documents(document_to_relevance_ordinary.size(), plan.GetResource());
     transform(
             std::execution::par,
             document_to_relevance_ordinary.begin(), document_to_relevance_ordinary.end(),
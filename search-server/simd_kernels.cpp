@@ -0,0 +1,253 @@
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SEARCH_SERVER_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr float MASKED_SCORE = -std::numeric_limits<float>::infinity();
+
+void ScatterAccumulateScalar(const uint32_t *slots, const uint16_t *impacts, size_t count, float weight,
+                             float *scores) {
+    for (size_t i = 0; i < count; ++i) {
+        scores[slots[i]] += static_cast<float>(impacts[i]) * weight;
+    }
+}
+
+void ScatterAssignScalar(const uint32_t *slots, size_t count, float value, float *scores) {
+    for (size_t i = 0; i < count; ++i) {
+        scores[slots[i]] = value;
+    }
+}
+
+void MaskByStatusScalar(const uint8_t *statuses, uint8_t status, size_t count, float *scores) {
+    for (size_t i = 0; i < count; ++i) {
+        scores[i] = statuses[i] == status ? scores[i] : MASKED_SCORE;
+    }
+}
+
+// Без ветвлений: номер пишется всегда, а счётчик сдвигается только для подходящих
+size_t GatherCandidatesScalar(const float *scores, size_t count, float threshold, uint32_t *candidates) {
+    size_t candidate_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        candidates[candidate_count] = static_cast<uint32_t>(i);
+        candidate_count += scores[i] > threshold ? 1 : 0;
+    }
+    return candidate_count;
+}
+
+#ifdef SEARCH_SERVER_X86_KERNELS
+
+// В AVX2 нет записи по индексам: сумма считается векторно, а записывается по одной
+__attribute__((target("avx2,fma")))
+void ScatterAccumulateAvx2(const uint32_t *slots, const uint16_t *impacts, size_t count, float weight,
+                           float *scores) {
+    const __m256 weights = _mm256_set1_ps(weight);
+    size_t i = 0;
+    alignas(32) float sums[8];
+    alignas(32) uint32_t indices[8];
+    for (; i + 8 <= count; i += 8) {
+        const __m256i slot_vector = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(slots + i));
+        const __m256i impact_vector = _mm256_cvtepu16_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(impacts + i)));
+        const __m256 old_scores = _mm256_i32gather_ps(scores, slot_vector, 4);
+        const __m256 new_scores = _mm256_fmadd_ps(_mm256_cvtepi32_ps(impact_vector), weights, old_scores);
+        _mm256_store_ps(sums, new_scores);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(indices), slot_vector);
+        for (int lane = 0; lane < 8; ++lane) {
+            scores[indices[lane]] = sums[lane];
+        }
+    }
+    ScatterAccumulateScalar(slots + i, impacts + i, count - i, weight, scores);
+}
+
+__attribute__((target("avx2")))
+void MaskByStatusAvx2(const uint8_t *statuses, uint8_t status, size_t count, float *scores) {
+    const __m256i status_vector = _mm256_set1_epi32(status);
+    const __m256 masked = _mm256_set1_ps(MASKED_SCORE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i slot_statuses = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i *>(statuses + i)));
+        const __m256 is_matched = _mm256_castsi256_ps(_mm256_cmpeq_epi32(slot_statuses, status_vector));
+        const __m256 slot_scores = _mm256_loadu_ps(scores + i);
+        _mm256_storeu_ps(scores + i, _mm256_blendv_ps(masked, slot_scores, is_matched));
+    }
+    MaskByStatusScalar(statuses + i, status, count - i, scores + i);
+}
+
+__attribute__((target("avx2,bmi")))
+size_t GatherCandidatesAvx2(const float *scores, size_t count, float threshold, uint32_t *candidates) {
+    const __m256 thresholds = _mm256_set1_ps(threshold);
+    size_t candidate_count = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        unsigned mask = static_cast<unsigned>(
+                _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(scores + i), thresholds, _CMP_GT_OQ)));
+        // Кандидаты редки, поэтому перебираются только установленные биты
+        while (mask != 0) {
+            candidates[candidate_count++] = static_cast<uint32_t>(i + _tzcnt_u32(mask));
+            mask &= mask - 1;
+        }
+    }
+    for (; i < count; ++i) {
+        if (scores[i] > threshold) {
+            candidates[candidate_count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return candidate_count;
+}
+
+__attribute__((target("avx512f")))
+void ScatterAccumulateAvx512(const uint32_t *slots, const uint16_t *impacts, size_t count, float weight,
+                             float *scores) {
+    const __m512 weights = _mm512_set1_ps(weight);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512i slot_vector = _mm512_loadu_si512(slots + i);
+        const __m512i impact_vector = _mm512_cvtepu16_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(impacts + i)));
+        const __m512 old_scores = _mm512_i32gather_ps(slot_vector, scores, 4);
+        const __m512 new_scores = _mm512_fmadd_ps(_mm512_cvtepi32_ps(impact_vector), weights, old_scores);
+        _mm512_i32scatter_ps(scores, slot_vector, new_scores, 4);
+    }
+    ScatterAccumulateScalar(slots + i, impacts + i, count - i, weight, scores);
+}
+
+__attribute__((target("avx512f")))
+void ScatterAssignAvx512(const uint32_t *slots, size_t count, float value, float *scores) {
+    const __m512 values = _mm512_set1_ps(value);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_i32scatter_ps(scores, _mm512_loadu_si512(slots + i), values, 4);
+    }
+    ScatterAssignScalar(slots + i, count - i, value, scores);
+}
+
+__attribute__((target("avx512f")))
+void MaskByStatusAvx512(const uint8_t *statuses, uint8_t status, size_t count, float *scores) {
+    const __m512i status_vector = _mm512_set1_epi32(status);
+    const __m512 masked = _mm512_set1_ps(MASKED_SCORE);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512i slot_statuses = _mm512_cvtepu8_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(statuses + i)));
+        const __mmask16 is_matched = _mm512_cmpeq_epi32_mask(slot_statuses, status_vector);
+        _mm512_storeu_ps(scores + i, _mm512_mask_loadu_ps(masked, is_matched, scores + i));
+    }
+    MaskByStatusScalar(statuses + i, status, count - i, scores + i);
+}
+
+__attribute__((target("avx512f")))
+size_t GatherCandidatesAvx512(const float *scores, size_t count, float threshold, uint32_t *candidates) {
+    const __m512 thresholds = _mm512_set1_ps(threshold);
+    const __m512i lane_offsets = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    size_t candidate_count = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __mmask16 is_candidate = _mm512_cmp_ps_mask(_mm512_loadu_ps(scores + i), thresholds, _CMP_GT_OQ);
+        if (is_candidate == 0) {
+            continue;
+        }
+        const __m512i indices = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(i)), lane_offsets);
+        _mm512_mask_compressstoreu_epi32(candidates + candidate_count, is_candidate, indices);
+        candidate_count += static_cast<size_t>(__builtin_popcount(is_candidate));
+    }
+    for (; i < count; ++i) {
+        if (scores[i] > threshold) {
+            candidates[candidate_count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return candidate_count;
+}
+
+#endif
+
+SimdLevel DetectSimdLevel() {
+#ifdef SEARCH_SERVER_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::SCALAR;
+}
+
+std::atomic<SimdLevel> &CurrentSimdLevel() {
+    static std::atomic<SimdLevel> level(GetSupportedSimdLevel());
+    return level;
+}
+
+}  // namespace
+
+SimdLevel GetSupportedSimdLevel() {
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+SimdLevel GetSimdLevel() {
+    return CurrentSimdLevel().load(std::memory_order_relaxed);
+}
+
+void SetSimdLevel(SimdLevel level) {
+    CurrentSimdLevel().store(std::min(level, GetSupportedSimdLevel()), std::memory_order_relaxed);
+}
+
+void ScatterAccumulate(const uint32_t *slots, const uint16_t *impacts, size_t count, float weight, float *scores) {
+    switch (GetSimdLevel()) {
+#ifdef SEARCH_SERVER_X86_KERNELS
+        case SimdLevel::AVX512:
+            return ScatterAccumulateAvx512(slots, impacts, count, weight, scores);
+        case SimdLevel::AVX2:
+            return ScatterAccumulateAvx2(slots, impacts, count, weight, scores);
+#endif
+        default:
+            return ScatterAccumulateScalar(slots, impacts, count, weight, scores);
+    }
+}
+
+void ScatterAssign(const uint32_t *slots, size_t count, float value, float *scores) {
+    switch (GetSimdLevel()) {
+#ifdef SEARCH_SERVER_X86_KERNELS
+        case SimdLevel::AVX512:
+            return ScatterAssignAvx512(slots, count, value, scores);
+#endif
+        default:
+            return ScatterAssignScalar(slots, count, value, scores);
+    }
+}
+
+void MaskByStatus(const uint8_t *statuses, uint8_t status, size_t count, float *scores) {
+    switch (GetSimdLevel()) {
+#ifdef SEARCH_SERVER_X86_KERNELS
+        case SimdLevel::AVX512:
+            return MaskByStatusAvx512(statuses, status, count, scores);
+        case SimdLevel::AVX2:
+            return MaskByStatusAvx2(statuses, status, count, scores);
+#endif
+        default:
+            return MaskByStatusScalar(statuses, status, count, scores);
+    }
+}
+
+size_t GatherCandidates(const float *scores, size_t count, float threshold, uint32_t *candidates) {
+    switch (GetSimdLevel()) {
+#ifdef SEARCH_SERVER_X86_KERNELS
+        case SimdLevel::AVX512:
+            return GatherCandidatesAvx512(scores, count, threshold, candidates);
+        case SimdLevel::AVX2:
+            return GatherCandidatesAvx2(scores, count, threshold, candidates);
+#endif
+        default:
+            return GatherCandidatesScalar(scores, count, threshold, candidates);
+    }
+}
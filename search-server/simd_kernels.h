@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Ядра подсчёта релевантности по плотным номерам документов (слотам). Реализация выбирается
+// во время выполнения по возможностям процессора: AVX-512, AVX2 или скалярная
+enum class SimdLevel {
+    SCALAR,
+    AVX2,
+    AVX512,
+};
+
+SimdLevel GetSupportedSimdLevel();
+
+SimdLevel GetSimdLevel();
+
+// Для тестов и замеров: уровень выше поддерживаемого понижается до него
+void SetSimdLevel(SimdLevel level);
+
+// scores[slots[i]] += impacts[i] * weight. Слоты не должны повторяться
+void ScatterAccumulate(const uint32_t *slots, const uint16_t *impacts, size_t count, float weight, float *scores);
+
+// scores[slots[i]] = value. Слоты не должны повторяться
+void ScatterAssign(const uint32_t *slots, size_t count, float value, float *scores);
+
+// Заменяет на -inf оценки документов со статусом, отличным от status
+void MaskByStatus(const uint8_t *statuses, uint8_t status, size_t count, float *scores);
+
+// Записывает в candidates номера оценок больше threshold по возрастанию, возвращает их число.
+// candidates должен вмещать count элементов
+size_t GatherCandidates(const float *scores, size_t count, float threshold, uint32_t *candidates);
@@ -7,6 +7,19 @@
 
 std::vector<std::string_view> SplitIntoWords(std::string_view str);
 
+// Дописывает слова str в words, вектор может использовать любой аллокатор
+template<typename Allocator>
+void SplitIntoWords(std::string_view str, std::vector<std::string_view, Allocator> &words) {
+    while (true) {
+        const size_t space = str.find(' ');
+        words.push_back(str.substr(0, space));
+        if (space == std::string_view::npos) {
+            break;
+        }
+        str.remove_prefix(space + 1);
+    }
+}
+
 template<typename StringContainer>
 std::set<std::string, std::less<>> MakeUniqueNonEmptyStrings(const StringContainer &container) {
     std::set<std::string, std::less<>> non_empty_words;
@@ -0,0 +1,44 @@
+#include "term_set_fingerprint.h"
+
+namespace {
+
+// Сумма хешей слов не зависит от их порядка
+void AddWord(TermSetFingerprint &fingerprint, std::string_view word) {
+    fingerprint.high += HashWord(word, 0x5851F42D4C957F2Dull);
+    fingerprint.low += HashWord(word, 0x14057B7EF767814Full);
+}
+
+}  // namespace
+
+uint64_t HashWord(std::string_view word, uint64_t seed) {
+    // FNV-1a с начальным значением, зависящим от seed
+    uint64_t hash = 0xCBF29CE484222325ull ^ seed;
+    for (const char c: word) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001B3ull;
+    }
+    return MixBits(hash);
+}
+
+uint64_t MixBits(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+TermSetFingerprint ComputeTermSetFingerprint(const std::map<std::string_view, double> &word_freqs) {
+    TermSetFingerprint fingerprint;
+    for (const auto &[word, _]: word_freqs) {
+        AddWord(fingerprint, word);
+    }
+    return fingerprint;
+}
+
+TermSetFingerprint ComputeTermSetFingerprint(const std::vector<std::string_view> &unique_words) {
+    TermSetFingerprint fingerprint;
+    for (const std::string_view word: unique_words) {
+        AddWord(fingerprint, word);
+    }
+    return fingerprint;
+}
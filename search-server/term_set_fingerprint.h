@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string_view>
+#include <vector>
+
+// 64-битный хеш слова, разные seed дают независимые хеш-функции
+uint64_t HashWord(std::string_view word, uint64_t seed);
+
+// Финальное перемешивание splitmix64
+uint64_t MixBits(uint64_t value);
+
+// 128-битный отпечаток множества слов документа. Не зависит от порядка и повторов слов, так что
+// документы с одинаковым набором слов получают один отпечаток, а разные совпадают с вероятностью ~2^-128
+struct TermSetFingerprint {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const TermSetFingerprint &other) const {
+        return high == other.high && low == other.low;
+    }
+
+    bool operator!=(const TermSetFingerprint &other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const TermSetFingerprint &other) const {
+        return high < other.high || (high == other.high && low < other.low);
+    }
+};
+
+struct TermSetFingerprintHasher {
+    size_t operator()(const TermSetFingerprint &fingerprint) const {
+        return static_cast<size_t>(fingerprint.low);
+    }
+};
+
+TermSetFingerprint ComputeTermSetFingerprint(const std::map<std::string_view, double> &word_freqs);
+
+// Слова должны быть различны
+TermSetFingerprint ComputeTermSetFingerprint(const std::vector<std::string_view> &unique_words);
@@ -2,6 +2,26 @@
 
 using namespace std;
 
+namespace {
+// Число обращений к куче из текущего потока, по нему проверяются запросы без выделения памяти
+thread_local size_t heap_allocation_count = 0;
+}
+
+void *operator new(size_t size) {
+    ++heap_allocation_count;
+    if (void *pointer = malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    free(pointer);
+}
 
 void AssertImpl(bool value, const string &expr_str, const string &file, const string &func, unsigned line,
                 const string &hint) {
@@ -62,6 +82,30 @@ void MatchDocuments(const SearchServer &search_server, const string_view &query)
     }
 }
 
+// id найденных документов по возрастанию, для сравнения выдачи без учёта порядка
+vector<int> GetSortedIds(const vector<Document> &documents) {
+    vector<int> result;
+    for (const Document &document: documents) {
+        result.push_back(document.id);
+    }
+    sort(result.begin(), result.end());
+    return result;
+}
+
+// Детерминированный линейный конгруэнтный генератор для тестовых данных: одна и та же
+// последовательность на всех платформах, числа в диапазоне [0, 32767]
+class TestRandom {
+public:
+    explicit TestRandom(uint32_t seed) : seed_(seed) {}
+
+    uint32_t operator()() {
+        seed_ = seed_ * 1103515245u + 12345u;
+        return (seed_ >> 16) & 0x7FFF;
+    }
+
+private:
+    uint32_t seed_;
+};
 
 // -------- Начало модульных тестов поисковой системы ----------
 
@@ -878,6 +922,1745 @@ void TestFindTopDocumentParallel() {
     }
 }
 
+void TestFindTopDocumentsWithBudget() {
+    SearchServer search_server("and with"s);
+    for (int id = 0; id < 1000; ++id) {
+        search_server.AddDocument(id, id % 2 ? "white cat"s : "curly dog"s, DocumentStatus::ACTUAL, {id % 10});
+    }
+    const auto full_result = search_server.FindTopDocuments("cat dog"s);
+
+    // без ограничений результат совпадает с обычным поиском
+    {
+        bool is_partial = true;
+        const auto documents = search_server.FindTopDocuments("cat dog"s, QueryBudget::Unlimited(), is_partial);
+        ASSERT(!is_partial);
+        ASSERT_EQUAL(documents.size(), full_result.size());
+        ASSERT_EQUAL(search_server.GetBudgetStatistics().budgeted_queries, 0u);
+    }
+
+    // бюджета хватает на весь запрос
+    {
+        bool is_partial = true;
+        const auto documents = search_server.FindTopDocuments("cat dog"s, QueryBudget::WithMaxPostings(1000), is_partial);
+        ASSERT(!is_partial);
+        for (size_t i = 0; i < documents.size(); ++i) {
+            ASSERT_EQUAL(documents[i].id, full_result[i].id);
+        }
+    }
+
+    // обход прерывается, возвращаются лучшие из найденных
+    {
+        bool is_partial = false;
+        const auto documents = search_server.FindTopDocuments(execution::seq, "cat dog"s,
+                                                              [](int document_id, DocumentStatus status, int rating) {
+                                                                  return true;
+                                                              }, QueryBudget::WithMaxPostings(10), is_partial);
+        ASSERT(is_partial);
+        ASSERT_EQUAL(documents.size(), 5u);
+    }
+    {
+        bool is_partial = false;
+        search_server.FindTopDocuments(execution::par, "cat dog"s, [](int document_id, DocumentStatus status,
+                                                                      int rating) {
+            return true;
+        }, QueryBudget::WithMaxPostings(300), is_partial);
+        ASSERT(is_partial);
+    }
+
+    // крайний срок уже прошёл
+    {
+        bool is_partial = false;
+        const auto documents = search_server.FindTopDocuments("cat dog"s, QueryBudget::WithTimeout(-1ms), is_partial);
+        ASSERT(is_partial);
+        ASSERT(documents.empty());
+    }
+
+    const BudgetStatistics statistics = search_server.GetBudgetStatistics();
+    ASSERT_EQUAL(statistics.budgeted_queries, 4u);
+    ASSERT_EQUAL(statistics.postings_exceeded, 2u);
+    ASSERT_EQUAL(statistics.deadline_exceeded, 1u);
+
+    // пересечение частых обязательных слов оплачивается из бюджета, даже если оно пусто
+    for (const bool use_word_bitmaps: {false, true}) {
+        SearchServer required_server("and with"s);
+        if (use_word_bitmaps) {
+            required_server.EnableWordBitmaps();
+        }
+        for (int id = 0; id < 1000; ++id) {
+            required_server.AddDocument(id, id % 2 ? "white cat curly"s : "curly dog cat"s, DocumentStatus::ACTUAL,
+                                        {id % 10});
+        }
+        bool is_partial = false;
+        const auto documents = required_server.FindTopDocuments("+curly +cat"s, QueryBudget::WithMaxPostings(5),
+                                                                is_partial);
+        ASSERT_HINT(is_partial, use_word_bitmaps ? "bitmaps"s : "postings"s);
+        ASSERT_HINT(documents.size() <= 5u, use_word_bitmaps ? "bitmaps"s : "postings"s);
+        ASSERT_EQUAL(required_server.GetBudgetStatistics().postings_exceeded, 1u);
+
+        // списки обходятся постинг за постингом, поэтому и пустое пересечение не просматривается дальше бюджета
+        if (!use_word_bitmaps) {
+            for (int id = 1000; id < 2000; ++id) {
+                required_server.AddDocument(id, id % 2 ? "fancy collar"s : "fancy tail"s, DocumentStatus::ACTUAL,
+                                            {0});
+            }
+            is_partial = false;
+            ASSERT(required_server.FindTopDocuments("+collar +tail"s, QueryBudget::WithMaxPostings(5),
+                                                    is_partial).empty());
+            ASSERT(is_partial);
+        }
+    }
+}
+
+void TestMinusWordsExcludedInBothPolicies() {
+    SearchServer search_server("and with"s);
+    const vector<string> texts = {
+            "white cat and yellow hat"s,
+            "curly cat curly tail"s,
+            "nasty dog with big eyes"s,
+            "nasty cat john"s,
+    };
+    // объём работы должен быть достаточным, чтобы параллельный поиск действительно выполнялся параллельно
+    const int document_count = static_cast<int>(MIN_POSTINGS_FOR_PARALLEL_SEARCH);
+    for (int id = 0; id < document_count; ++id) {
+        search_server.AddDocument(id, texts[id % texts.size()], DocumentStatus::ACTUAL, {id});
+    }
+
+    const auto sequential = search_server.FindTopDocuments(execution::seq, "cat nasty -curly -white"s);
+    const auto parallel = search_server.FindTopDocuments(execution::par, "cat nasty -curly -white"s);
+    ASSERT_EQUAL(sequential.size(), parallel.size());
+    for (size_t i = 0; i < sequential.size(); ++i) {
+        ASSERT_EQUAL_HINT(sequential[i].id % 4, 3, "Documents with minus words must be excluded"s);
+        ASSERT_EQUAL(sequential[i].id, parallel[i].id);
+        ASSERT(abs(sequential[i].relevance - parallel[i].relevance) < EPSILON);
+    }
+
+    ASSERT(search_server.FindTopDocuments(execution::par, "cat -cat"s).empty());
+}
+
+// Оценка памяти узла красно-чёрного дерева std::set<int> в libstdc++: три указателя, цвет и значение
+size_t EstimateSetMemoryUsage(const set<int> &values) {
+    return sizeof(values) + values.size() * (3 * sizeof(void *) + 2 * sizeof(int));
+}
+
+void TestRoaringBitmap() {
+    // разреженные, плотные и сплошные диапазоны, чтобы задействовать все виды контейнеров
+    set<int> sparse;
+    set<int> dense;
+    for (int value = 0; value < 2'000'000; value += 97) {
+        sparse.insert(value);
+    }
+    for (int value = 1'000'000; value < 1'500'000; ++value) {
+        if (value % 3 != 0) {
+            dense.insert(value);
+        }
+    }
+    for (int value = 3'000'000; value < 3'200'000; ++value) {
+        dense.insert(value);
+    }
+
+    RoaringBitmap sparse_bitmap(sparse.begin(), sparse.end());
+    RoaringBitmap dense_bitmap(dense.begin(), dense.end());
+    ASSERT_EQUAL(sparse_bitmap.GetCardinality(), sparse.size());
+    ASSERT_EQUAL(dense_bitmap.GetCardinality(), dense.size());
+    ASSERT(dense_bitmap.Contains(1'000'001));
+    ASSERT(!dense_bitmap.Contains(1'000'002));
+    ASSERT(!sparse_bitmap.Contains(98));
+
+    const auto to_vector = [](const set<int> &values) {
+        return vector<uint32_t>(values.begin(), values.end());
+    };
+
+    set<int> set_union;
+    set<int> set_intersection;
+    set<int> set_difference;
+    {
+        LOG_DURATION("std::set<int> union, intersection, difference"s);
+        set_union = sparse;
+        set_union.insert(dense.begin(), dense.end());
+        std::set_intersection(sparse.begin(), sparse.end(), dense.begin(), dense.end(),
+                              inserter(set_intersection, set_intersection.end()));
+        std::set_difference(dense.begin(), dense.end(), sparse.begin(), sparse.end(),
+                            inserter(set_difference, set_difference.end()));
+    }
+    RoaringBitmap bitmap_union;
+    RoaringBitmap bitmap_intersection;
+    RoaringBitmap bitmap_difference;
+    {
+        LOG_DURATION("RoaringBitmap union, intersection, difference"s);
+        bitmap_union = sparse_bitmap | dense_bitmap;
+        bitmap_intersection = sparse_bitmap & dense_bitmap;
+        bitmap_difference = dense_bitmap - sparse_bitmap;
+    }
+    ASSERT_EQUAL(bitmap_union.ToVector(), to_vector(set_union));
+    ASSERT_EQUAL(bitmap_intersection.ToVector(), to_vector(set_intersection));
+    ASSERT_EQUAL(bitmap_difference.ToVector(), to_vector(set_difference));
+
+    const size_t bitmap_memory = dense_bitmap.GetMemoryUsage();
+    dense_bitmap.RunOptimize();
+    ASSERT(dense_bitmap.GetMemoryUsage() < bitmap_memory);
+    ASSERT_EQUAL(dense_bitmap.ToVector(), to_vector(dense));
+    cerr << "Memory for "s << dense.size() << " values: std::set<int> ~"s << EstimateSetMemoryUsage(dense)
+         << " bytes, RoaringBitmap "s << dense_bitmap.GetMemoryUsage() << " bytes"s << endl;
+
+    for (int value = 1'000'000; value < 1'500'000; ++value) {
+        dense_bitmap.Remove(value);
+    }
+    dense_bitmap.Add(5);
+    ASSERT_EQUAL(dense_bitmap.GetCardinality(), 200'001u);
+    ASSERT(dense_bitmap.Contains(5));
+    ASSERT(!dense_bitmap.Remove(6));
+    RoaringBitmap expected(dense.lower_bound(3'000'000), dense.end());
+    expected.Add(5);
+    ASSERT(dense_bitmap == expected);
+}
+
+void TestWordBitmaps() {
+    SearchServer search_server("and with"s);
+    search_server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    search_server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    search_server.EnableWordBitmaps();
+    search_server.AddDocument(3, "nasty rat with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    search_server.AddDocument(4, "big dog"s, DocumentStatus::ACTUAL, {1, 2});
+
+    ASSERT(search_server.FindTopDocuments("funny rat -nasty"s).size() == 1u);
+    ASSERT_EQUAL(search_server.FindTopDocuments("funny rat -nasty"s)[0].id, 2);
+    ASSERT_EQUAL(search_server.FindTopDocuments("funny rat dog -nasty -curly"s).size(), 1u);
+    ASSERT_EQUAL(search_server.FindTopDocuments("funny rat dog -nasty -curly"s)[0].id, 4);
+
+    search_server.RemoveDocument(4);
+    search_server.RemoveDocument(execution::par, 2);
+    ASSERT(search_server.FindTopDocuments("funny rat dog -nasty"s).empty());
+    ASSERT_EQUAL(search_server.FindTopDocuments("funny rat dog -curly"s).size(), 1u);
+}
+
+void TestRequiredWords() {
+    SearchServer search_server("and with"s);
+    search_server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    search_server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    search_server.AddDocument(3, "nasty rat with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    search_server.AddDocument(4, "curly dog"s, DocumentStatus::BANNED, {1, 2});
+
+    const auto check = [&search_server]() {
+        const auto documents = search_server.FindTopDocuments("+curly +hair funny"s);
+        ASSERT_EQUAL(documents.size(), 2u);
+        ASSERT_EQUAL_HINT(documents[0].id, 2, "Optional words still affect relevance"s);
+        ASSERT_EQUAL(documents[1].id, 3);
+
+        ASSERT(search_server.FindTopDocuments("+curly +cat"s).empty());
+        ASSERT_EQUAL(search_server.FindTopDocuments("+curly -funny"s).size(), 1u);
+        ASSERT_EQUAL(search_server.FindTopDocuments("+curly"s, DocumentStatus::BANNED).size(), 1u);
+        ASSERT_EQUAL(search_server.FindTopDocuments(execution::par, "+curly +hair +curly curly"s).size(), 2u);
+
+        const auto relevance = search_server.FindTopDocuments("curly rat"s);
+        const auto required_relevance = search_server.FindTopDocuments("+curly +rat"s);
+        ASSERT_EQUAL(required_relevance.size(), 1u);
+        ASSERT_EQUAL(required_relevance[0].id, 3);
+        ASSERT(abs(required_relevance[0].relevance - relevance[0].relevance) < EPSILON);
+    };
+    check();
+    search_server.EnableWordBitmaps();
+    check();
+
+    const string match_query = "+curly pet nasty"s;
+    {
+        const auto [words, status] = search_server.MatchDocument(match_query, 2);
+        ASSERT_EQUAL(words, vector<string_view>({"curly"sv, "pet"sv}));
+    }
+    {
+        const auto [words, status] = search_server.MatchDocument(execution::par, match_query, 2);
+        ASSERT_EQUAL(words, vector<string_view>({"curly"sv, "pet"sv}));
+    }
+    {
+        const auto [words, status] = search_server.MatchDocument(execution::par, match_query, 1);
+        ASSERT(words.empty());
+    }
+    try {
+        search_server.FindTopDocuments("+-curly"s);
+        ASSERT_HINT(false, "Required minus word must be rejected"s);
+    } catch (const invalid_argument &) {
+    }
+
+    // сильно различающиеся по размеру массивы пересекаются экспоненциальным поиском
+    vector<int> rare_values = {3, 500, 1001, 3999, 4001};
+    vector<int> frequent_values;
+    for (int value = 1; value < 4000; value += 2) {
+        frequent_values.push_back(value);
+    }
+    const RoaringBitmap intersection = RoaringBitmap(rare_values.begin(), rare_values.end())
+                                       & RoaringBitmap(frequent_values.begin(), frequent_values.end());
+    ASSERT_EQUAL(intersection.ToVector(), vector<uint32_t>({3, 1001, 3999}));
+}
+
+void TestBooleanQuery() {
+    SearchServer search_server("and with"s);
+    search_server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    search_server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    search_server.AddDocument(3, "nasty rat with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    search_server.AddDocument(4, "curly dog"s, DocumentStatus::ACTUAL, {1, 2});
+    search_server.AddDocument(5, "curly cat"s, DocumentStatus::BANNED, {1, 2});
+
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocumentsByBooleanQuery("(pet OR dog) AND curly"s)),
+                 vector<int>({2, 4}));
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocumentsByBooleanQuery("(pet OR dog) curly -hair"s)),
+                 vector<int>({4}));
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocumentsByBooleanQuery("curly NOT (hair OR dog)"s)), vector<int>());
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocumentsByBooleanQuery("curly NOT (hair OR dog)"s,
+                                                                           DocumentStatus::BANNED)),
+                 vector<int>({5}));
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocumentsByBooleanQuery("rat OR dog -(funny OR curly)"s)),
+                 vector<int>({1, 3}));
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocumentsByBooleanQuery("nasty AND and AND rat"s)),
+                 vector<int>({1, 3}));
+    ASSERT(search_server.FindTopDocumentsByBooleanQuery("curly AND unknown"s).empty());
+    ASSERT(search_server.FindTopDocumentsByBooleanQuery("and OR with"s).empty());
+
+    // дизъюнкция слов ранжируется так же, как обычный запрос
+    const auto boolean_result = search_server.FindTopDocumentsByBooleanQuery("nasty OR curly OR pet"s);
+    const auto plain_result = search_server.FindTopDocuments("nasty curly pet"s);
+    ASSERT_EQUAL(boolean_result.size(), plain_result.size());
+    for (size_t i = 0; i < plain_result.size(); ++i) {
+        ASSERT_EQUAL(boolean_result[i].id, plain_result[i].id);
+        ASSERT(abs(boolean_result[i].relevance - plain_result[i].relevance) < EPSILON);
+    }
+
+    for (const string &bad_query: {"(curly"s, "curly)"s, "curly OR"s, "-curly"s, "curly OR -dog"s, "--curly"s, ""s}) {
+        try {
+            search_server.FindTopDocumentsByBooleanQuery(bad_query);
+            ASSERT_HINT(false, "Query \""s + bad_query + "\" must be rejected"s);
+        } catch (const invalid_argument &) {
+        }
+    }
+}
+
+void TestPhraseQueries() {
+    SearchServer search_server("and with"s);
+    search_server.AddDocument(1, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(2, "hair is curly"s, DocumentStatus::ACTUAL, {2});
+    search_server.AddDocument(3, "curly black dog hair"s, DocumentStatus::ACTUAL, {3});
+
+    try {
+        search_server.FindTopDocuments("\"curly hair\""s);
+        ASSERT_HINT(false, "Phrase query without positional index must be rejected"s);
+    } catch (const invalid_argument &) {
+    }
+    // фраза из одного слова работает как обязательное слово
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("\"dog\" curly"s)), vector<int>({3}));
+
+    search_server.EnablePositionalIndex();
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("\"curly hair\""s)), vector<int>({1}));
+    // стоп-слова не занимают позиций
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("\"pet with curly\""s)), vector<int>({1}));
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("\"curly hair\"~1"s)), vector<int>({1}));
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("\"curly hair\"~2"s)), vector<int>({1, 3}));
+    ASSERT(search_server.FindTopDocuments("\"hair curly\""s).empty());
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("funny \"curly hair\"~2 -pet"s)), vector<int>({3}));
+
+    search_server.AddDocument(4, "very curly hair"s, DocumentStatus::ACTUAL, {4});
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("\"curly hair\""s)), vector<int>({1, 4}));
+    {
+        const string match_query = "\"curly hair\" dog"s;
+        const auto [words, status] = search_server.MatchDocument(match_query, 3);
+        ASSERT(words.empty());
+        const auto [par_words, par_status] = search_server.MatchDocument(execution::par, match_query, 4);
+        ASSERT_EQUAL(par_words.size(), 2u);
+    }
+    search_server.RemoveDocument(1);
+    search_server.RemoveDocument(execution::par, 4);
+    ASSERT(search_server.FindTopDocuments("\"curly hair\""s).empty());
+
+    for (const string &bad_query: {"\"curly hair"s, "\"curly -hair\""s, "\"curly hair\"~"s, "\"curly hair\"dog"s}) {
+        try {
+            search_server.FindTopDocuments(bad_query);
+            ASSERT_HINT(false, "Query \""s + bad_query + "\" must be rejected"s);
+        } catch (const invalid_argument &) {
+        }
+    }
+}
+
+void TestPrefixQueries() {
+    SearchServer search_server("and with"s);
+    search_server.AddDocument(1, "cat with collar"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(2, "catalog of dogs"s, DocumentStatus::ACTUAL, {2});
+    search_server.AddDocument(3, "category dog"s, DocumentStatus::ACTUAL, {3});
+    search_server.AddDocument(4, "scattered dog"s, DocumentStatus::ACTUAL, {4});
+
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("cat*"s)), vector<int>({1, 2, 3}));
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("cata*"s)), vector<int>({2}));
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("dog* -cat*"s)), vector<int>({4}));
+    // префикс может совпадать со стоп-словом
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("with*"s)), vector<int>());
+    ASSERT(search_server.FindTopDocuments("cow*"s).empty());
+    ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocumentsByBooleanQuery("cat* AND dog"s)), vector<int>({3}));
+    {
+        const string match_query = "cat* dog"s;
+        const auto [words, status] = search_server.MatchDocument(match_query, 3);
+        ASSERT_EQUAL(words, vector<string_view>({"category"sv, "dog"sv}));
+        const auto [par_words, par_status] = search_server.MatchDocument(execution::par, match_query, 3);
+        ASSERT_EQUAL(par_words, vector<string_view>({"category"sv, "dog"sv}));
+    }
+    for (const string &bad_query: {"*"s, "+cat*"s, "-*"s}) {
+        try {
+            search_server.FindTopDocuments(bad_query);
+            ASSERT_HINT(false, "Query \""s + bad_query + "\" must be rejected"s);
+        } catch (const invalid_argument &) {
+        }
+    }
+
+    // при превышении лимита остаются самые частые слова, при равной частоте — первые по алфавиту
+    SearchServer capped_server(""s);
+    for (int i = 0; i < static_cast<int>(MAX_PREFIX_EXPANSIONS) + 10; ++i) {
+        capped_server.AddDocument(i, "x"s + to_string(100 + i), DocumentStatus::ACTUAL, {i});
+    }
+    const int last_id = static_cast<int>(MAX_PREFIX_EXPANSIONS) + 9;
+    capped_server.AddDocument(last_id + 1, "x"s + to_string(100 + last_id), DocumentStatus::ACTUAL, {1});
+    const string capped_query = "x*"s;
+    ASSERT_EQUAL(get<0>(capped_server.MatchDocument(capped_query, 0)).size(), 1u);
+    ASSERT_EQUAL(get<0>(capped_server.MatchDocument(capped_query, last_id)).size(), 1u);
+    ASSERT(get<0>(capped_server.MatchDocument(capped_query, last_id - 1)).empty());
+    // исключение префикса не ограничено
+    ASSERT(get<0>(capped_server.MatchDocument("x100 -x*"s, 0)).empty());
+}
+
+void TestFuzzyQueries() {
+    {
+        const LevenshteinAutomaton automaton("kitten"sv, 2);
+        ASSERT_EQUAL(automaton.GetDistance("kitten"sv), 0);
+        ASSERT_EQUAL(automaton.GetDistance("sitten"sv), 1);
+        ASSERT_EQUAL(automaton.GetDistance("sittin"sv), 2);
+        ASSERT_EQUAL(automaton.GetDistance("sitting"sv), 3);
+        ASSERT_EQUAL(automaton.GetDistance("kiten"sv), 1);
+        ASSERT_EQUAL(automaton.GetDistance("kitxten"sv), 1);
+        ASSERT_EQUAL(automaton.GetDistance("k"sv), 3);
+    }
+
+    for (const bool use_trigram_index: {false, true}) {
+        SearchServer search_server("and with"s);
+        if (use_trigram_index) {
+            search_server.EnableTrigramIndex();
+        }
+        search_server.AddDocument(1, "curly cat"s, DocumentStatus::ACTUAL, {1});
+        search_server.AddDocument(2, "fluffy kitten"s, DocumentStatus::ACTUAL, {2});
+        search_server.AddDocument(3, "curled dog"s, DocumentStatus::ACTUAL, {3});
+        search_server.AddDocument(4, "kitchen"s, DocumentStatus::ACTUAL, {4});
+
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("curyl~"s)), vector<int>());
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("curyl~2"s)), vector<int>({1}));
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("kiten~"s)), vector<int>({2}));
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("kitten~2"s)), vector<int>({2, 4}));
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("kitten~2 -kitchen~"s)), vector<int>({2}));
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("cat~"s)), vector<int>({1}));
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocumentsByBooleanQuery("curly~2 AND dgo~2"s)),
+                     vector<int>({3}));
+        {
+            const string match_query = "fluffi~ kitchn~"s;
+            const auto [words, status] = search_server.MatchDocument(match_query, 2);
+            ASSERT_EQUAL(words, vector<string_view>({"fluffy"sv}));
+        }
+
+        search_server.RemoveDocument(2);
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("kitten~2"s)), vector<int>({4}));
+        search_server.AddDocument(5, "kittens"s, DocumentStatus::ACTUAL, {5});
+        ASSERT_EQUAL(GetSortedIds(search_server.FindTopDocuments("kitten~"s)), vector<int>({5}));
+
+        for (const string &bad_query: {"cat~3"s, "+cat~"s, "cat*~"s, "~"s, "\"curly cat~\""s}) {
+            try {
+                search_server.FindTopDocuments(bad_query);
+                ASSERT_HINT(false, "Query \""s + bad_query + "\" must be rejected"s);
+            } catch (const invalid_argument &) {
+            }
+        }
+    }
+
+    // кандидаты из триграмм совпадают с полным обходом словаря
+    SearchServer plain_server(""s);
+    SearchServer trigram_server(""s);
+    trigram_server.EnableTrigramIndex();
+    const vector<string> vocabulary = {"search"s, "serch"s, "searcher"s, "research"s, "seats"s, "starch"s, "each"s,
+                                       "sear"s, "searches"s, "march"s};
+    for (int i = 0; i < static_cast<int>(vocabulary.size()); ++i) {
+        plain_server.AddDocument(i, vocabulary[i], DocumentStatus::ACTUAL, {i});
+        trigram_server.AddDocument(i, vocabulary[i], DocumentStatus::ACTUAL, {i});
+    }
+    for (const string &query: {"search~"s, "search~2"s, "serach~2"s, "searcher~"s, "starch~2"s}) {
+        for (int i = 0; i < static_cast<int>(vocabulary.size()); ++i) {
+            ASSERT_EQUAL(get<0>(plain_server.MatchDocument(query, i)), get<0>(trigram_server.MatchDocument(query, i)));
+        }
+    }
+}
+
+void TestImpactLists() {
+    SearchServer plain_server("and with"s);
+    SearchServer impact_server("and with"s);
+    impact_server.EnableImpactLists(100);
+
+    const vector<string> vocabulary = {"cat"s, "dog"s, "curly"s, "funny"s, "pet"s, "rat"s, "nasty"s, "hair"s,
+                                       "with"s, "parrot"s, "fluffy"s, "tail"s};
+    TestRandom next_random(42);
+    const int document_count = 2000;
+    for (int id = 0; id < document_count; ++id) {
+        string text;
+        const int word_count = 1 + static_cast<int>(next_random() % 6);
+        for (int i = 0; i < word_count; ++i) {
+            // слова в начале словаря встречаются чаще
+            const size_t word_index = min(next_random() % vocabulary.size(), next_random() % vocabulary.size());
+            text += vocabulary[word_index] + " "s;
+        }
+        text += "unique"s + to_string(id);
+        const auto status = id % 7 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        plain_server.AddDocument(id, text, status, {id});
+        impact_server.AddDocument(id, text, status, {id});
+    }
+
+    const auto check_same_results = [&plain_server, &impact_server](const string &query, DocumentStatus status) {
+        const auto expected = plain_server.FindTopDocuments(query, status);
+        const auto actual = impact_server.FindTopDocuments(query, status);
+        ASSERT_EQUAL_HINT(actual.size(), expected.size(), query);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQUAL_HINT(actual[i].id, expected[i].id, query);
+            ASSERT_HINT(abs(actual[i].relevance - expected[i].relevance) < EPSILON, query);
+        }
+    };
+    const vector<string> queries = {"cat"s, "dog"s, "cat dog"s, "cat -dog"s, "curly funny pet"s, "tail"s,
+                                    "cat unique5"s, "fluffy tail"s, "cat* -d*"s, "with"s};
+    for (const string &query: queries) {
+        check_same_results(query, DocumentStatus::ACTUAL);
+        check_same_results(query, DocumentStatus::BANNED);
+    }
+
+    // списки поддерживаются при удалении и добавлении документов
+    for (int id = 0; id < document_count; id += 3) {
+        plain_server.RemoveDocument(id);
+        impact_server.RemoveDocument(id);
+    }
+    for (int id = 1; id < document_count; id += 3) {
+        plain_server.RemoveDocument(execution::par, id);
+        impact_server.RemoveDocument(execution::par, id);
+    }
+    plain_server.AddDocument(document_count, "cat cat cat"s, DocumentStatus::ACTUAL, {-5});
+    impact_server.AddDocument(document_count, "cat cat cat"s, DocumentStatus::ACTUAL, {-5});
+    for (const string &query: queries) {
+        check_same_results(query, DocumentStatus::ACTUAL);
+        check_same_results(query, DocumentStatus::BANNED);
+    }
+    ASSERT_EQUAL(impact_server.FindTopDocuments("cat"s).front().id, document_count);
+}
+
+void TestQuantizedImpacts() {
+    SearchServer exact_server("and with"s);
+    SearchServer quantized_server("and with"s);
+    quantized_server.EnableQuantizedImpacts();
+
+    vector<string> vocabulary;
+    for (int i = 0; i < 500; ++i) {
+        vocabulary.push_back("word"s + to_string(i));
+    }
+    TestRandom next_random(7);
+    const int document_count = 20000;
+    size_t posting_count = 0;
+    for (int id = 0; id < document_count; ++id) {
+        string text;
+        const int word_count = 1 + static_cast<int>(next_random() % 20);
+        for (int i = 0; i < word_count; ++i) {
+            const size_t word_index = min(next_random() % vocabulary.size(), next_random() % vocabulary.size());
+            text += vocabulary[word_index] + " "s;
+        }
+        exact_server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        quantized_server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        posting_count += exact_server.GetWordFrequencies(id).size();
+    }
+
+    vector<string> queries;
+    for (int i = 0; i < 200; ++i) {
+        queries.push_back(vocabulary[next_random() % vocabulary.size()] + " "s + vocabulary[next_random() % 50] + " "s
+                          + vocabulary[next_random() % 10] + " -"s + vocabulary[next_random() % vocabulary.size()]);
+    }
+    // порядок совпадает с точным с точностью до погрешности квантования
+    const auto check_same_ranking = [&]() {
+        for (const string &query: queries) {
+            const auto expected = exact_server.FindTopDocuments(query);
+            const auto actual = quantized_server.FindTopDocuments(query);
+            ASSERT_EQUAL_HINT(actual.size(), expected.size(), query);
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_HINT(abs(actual[i].relevance - expected[i].relevance) < 1e-4, query);
+            }
+        }
+    };
+    check_same_ranking();
+
+    // в длинный документ слово попадает с меньшим TF, в короткий — с большим, что требует смены масштаба
+    for (int id = 0; id < document_count; id += 5) {
+        exact_server.RemoveDocument(id);
+        quantized_server.RemoveDocument(id);
+    }
+    exact_server.AddDocument(document_count, "word499"s, DocumentStatus::ACTUAL, {0});
+    quantized_server.AddDocument(document_count, "word499"s, DocumentStatus::ACTUAL, {0});
+    check_same_ranking();
+    ASSERT_EQUAL(quantized_server.FindTopDocuments("word499"s).front().id, document_count);
+
+    // новые документы занимают освободившиеся слоты, удалённые не должны влиять на их оценку
+    for (int id = 0; id < document_count; id += 10) {
+        const string text = vocabulary[next_random() % 10] + " "s + vocabulary[next_random() % vocabulary.size()];
+        exact_server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        quantized_server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+    }
+    check_same_ranking();
+
+    // обязательные слова и булевы запросы идут по точным TF квантованных списков
+    for (int i = 0; i < 50; ++i) {
+        const string first_word = vocabulary[next_random() % 10];
+        const string second_word = vocabulary[next_random() % 50];
+        for (const auto &[query, is_boolean]: {pair{"+"s + first_word + " "s + second_word, false},
+                                               pair{first_word + " OR "s + second_word, true}}) {
+            const auto expected = is_boolean ? exact_server.FindTopDocumentsByBooleanQuery(query)
+                                             : exact_server.FindTopDocuments(query);
+            const auto actual = is_boolean ? quantized_server.FindTopDocumentsByBooleanQuery(query)
+                                           : quantized_server.FindTopDocuments(query);
+            ASSERT_EQUAL_HINT(actual.size(), expected.size(), query);
+            for (size_t j = 0; j < expected.size(); ++j) {
+                ASSERT_EQUAL_HINT(actual[j].id, expected[j].id, query);
+                ASSERT_EQUAL_HINT(actual[j].relevance, expected[j].relevance, query);
+            }
+        }
+    }
+
+    {
+        // шаг растёт вместе с наибольшим TF, вклады каждый раз пересчитываются из точных TF
+        QuantizedPostingList postings;
+        vector<double> term_freqs;
+        for (int i = 0; i < 14; ++i) {
+            term_freqs.push_back(1e-4 * (1 << i) + 3e-6 * i);
+            postings.Add(i, static_cast<uint32_t>(i + 1), term_freqs.back());
+        }
+        vector<float> scores(term_freqs.size() + 1, 0.0f);
+        postings.Accumulate(1.0f, scores);
+        // наибольший TF около 0.82, шаг 1 / 65535
+        const double half_step = 0.5 / QuantizedPostingList::MAX_IMPACT;
+        for (int i = 0; i < 14; ++i) {
+            ASSERT_HINT(abs(scores[i + 1] - term_freqs[i]) <= half_step + 1e-7, to_string(i));
+            ASSERT_EQUAL(*postings.FindTermFreq(i), term_freqs[i]);
+        }
+    }
+
+    posting_count = 0;
+    for (const int id: exact_server) {
+        posting_count += exact_server.GetWordFrequencies(id).size();
+    }
+    const size_t map_memory_usage =
+            posting_count * (3 * sizeof(void *) + 2 * sizeof(int) + sizeof(int) + sizeof(double));
+    const size_t quantized_memory_usage = quantized_server.GetQuantizedIndexMemoryUsage();
+    cerr << "Memory for "s << posting_count << " postings: std::map<int, double> ~"s << map_memory_usage
+         << " bytes, quantized "s << quantized_memory_usage << " bytes"s << endl;
+    // квантованные списки вместе со слотами документов заменяют std::map, а не дополняют его
+    ASSERT(quantized_memory_usage < map_memory_usage);
+    {
+        LOG_DURATION("Exact scoring of 200 queries"s);
+        for (const string &query: queries) {
+            exact_server.FindTopDocuments(query);
+        }
+    }
+    {
+        LOG_DURATION("Quantized scoring of 200 queries"s);
+        for (const string &query: queries) {
+            quantized_server.FindTopDocuments(query);
+        }
+    }
+}
+
+void TestSimdKernels() {
+    TestRandom next_random(3);
+    // длины не кратны ширине векторов, чтобы проверить и хвосты
+    const size_t slot_count = 1003;
+    vector<uint32_t> slots(slot_count);
+    iota(slots.begin(), slots.end(), 0u);
+    for (size_t i = slots.size() - 1; i > 0; --i) {
+        swap(slots[i], slots[next_random() % (i + 1)]);
+    }
+    slots.resize(517);
+    vector<uint16_t> impacts(slots.size());
+    for (uint16_t &impact: impacts) {
+        impact = static_cast<uint16_t>(next_random());
+    }
+    vector<uint8_t> statuses(slot_count);
+    for (uint8_t &status: statuses) {
+        status = static_cast<uint8_t>(next_random() % 4);
+    }
+
+    const auto run_kernels = [&]() {
+        vector<float> scores(slot_count, 0.0f);
+        ScatterAccumulate(slots.data(), impacts.data(), slots.size(), 0.5f, scores.data());
+        ScatterAccumulate(slots.data() + 100, impacts.data(), 211, 0.25f, scores.data());
+        ScatterAssign(slots.data() + 300, 33, -numeric_limits<float>::infinity(), scores.data());
+        MaskByStatus(statuses.data(), 1, statuses.size(), scores.data());
+        vector<uint32_t> candidates(scores.size());
+        candidates.resize(GatherCandidates(scores.data(), scores.size(), 0.0f, candidates.data()));
+        return make_pair(scores, candidates);
+    };
+
+    const SimdLevel supported_level = GetSupportedSimdLevel();
+    SetSimdLevel(SimdLevel::SCALAR);
+    const auto [expected_scores, expected_candidates] = run_kernels();
+    ASSERT(!expected_candidates.empty());
+    for (const SimdLevel level: {SimdLevel::AVX2, SimdLevel::AVX512}) {
+        SetSimdLevel(level);
+        const auto [scores, candidates] = run_kernels();
+        ASSERT_EQUAL(candidates, expected_candidates);
+        for (size_t i = 0; i < scores.size(); ++i) {
+            ASSERT(scores[i] == expected_scores[i] || abs(scores[i] - expected_scores[i]) < 1e-3f);
+        }
+    }
+    SetSimdLevel(supported_level);
+    ASSERT(GetSimdLevel() == supported_level);
+
+    // отбор по статусу маской даёт то же, что произвольный предикат
+    SearchServer search_server(""s);
+    search_server.EnableQuantizedImpacts();
+    for (int id = 0; id < 500; ++id) {
+        const auto status = static_cast<DocumentStatus>(id % 3);
+        search_server.AddDocument(id, "cat"s + to_string(id % 7) + " dog"s + to_string(id % 11), status, {id});
+    }
+    for (const string &query: {"cat1 dog2"s, "cat3 -dog4"s, "cat1 cat2 cat3 cat4 cat5 cat6 cat0"s}) {
+        for (const DocumentStatus status: {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED}) {
+            const auto masked = search_server.FindTopDocuments(query, status);
+            const auto filtered = search_server.FindTopDocuments(query, [status](int, DocumentStatus document_status, int) {
+                return document_status == status;
+            });
+            ASSERT_EQUAL(masked.size(), filtered.size());
+            ASSERT(!masked.empty());
+            for (size_t i = 0; i < masked.size(); ++i) {
+                ASSERT_EQUAL(masked[i].id, filtered[i].id);
+            }
+        }
+    }
+}
+
+void TestCompressedPostings() {
+    TestRandom next_random(11);
+
+    // блоки с разными разностями, включая огромные, и неполный хвост
+    map<int, double> document_freqs;
+    int document_id = 0;
+    for (int i = 0; i < 1000; ++i) {
+        document_id += i % 300 == 299 ? 100'000'000 : 1 + static_cast<int>(next_random() % (i < 500 ? 3 : 5000));
+        document_freqs[document_id] = 1.0 / (1 + next_random() % 40);
+    }
+    const CompressedPostingList compressed(document_freqs);
+    ASSERT_EQUAL(compressed.GetSize(), document_freqs.size());
+    ASSERT_EQUAL(compressed.GetLastDocument(), document_freqs.rbegin()->first);
+    {
+        auto posting = compressed.GetIterator();
+        for (const auto &[expected_id, expected_freq]: document_freqs) {
+            ASSERT_EQUAL(posting.GetDocument(), expected_id);
+            ASSERT_EQUAL(posting.GetTermFreq(), expected_freq);
+            posting.Next();
+        }
+        ASSERT_EQUAL(posting.GetDocument(), CompressedPostingList::END);
+    }
+    {
+        auto posting = compressed.GetIterator();
+        for (int target = 0; target < document_id + 10; target += 1 + static_cast<int>(next_random() % 1000) * 1000) {
+            posting.Advance(target);
+            const auto expected_it = document_freqs.lower_bound(target);
+            ASSERT_EQUAL(posting.GetDocument(), expected_it == document_freqs.end() ? CompressedPostingList::END
+                                                                                      : expected_it->first);
+        }
+    }
+    CompressedPostingList appended;
+    for (const auto &[id, term_freq]: document_freqs) {
+        appended.Append(id, term_freq);
+    }
+    ASSERT_EQUAL(appended.GetSize(), compressed.GetSize());
+
+    // вставки и удаления в любом месте списка, в том числе повторное добавление удалённых документов
+    {
+        CompressedPostingList changed(document_freqs);
+        map<int, double> expected = document_freqs;
+        const int max_document_id = document_freqs.rbegin()->first;
+        for (int i = 0; i < 5000; ++i) {
+            if (next_random() % 2 == 0 && !expected.empty()) {
+                auto document_it = expected.lower_bound(static_cast<int>(next_random() % 3000)
+                                                        * (max_document_id / 3000));
+                if (document_it == expected.end()) {
+                    document_it = expected.begin();
+                }
+                changed.Remove(document_it->first);
+                expected.erase(document_it);
+            } else {
+                const int id = static_cast<int>(next_random() % 20000) * (max_document_id / 20000 + 1);
+                if (expected.count(id) > 0) {
+                    continue;
+                }
+                const double term_freq = 1.0 / (1 + next_random() % 40);
+                changed.Add(id, term_freq);
+                expected[id] = term_freq;
+            }
+            if (i % 500 == 0) {
+                ASSERT_EQUAL(changed.GetSize(), expected.size());
+                auto posting = changed.GetIterator();
+                for (const auto &[expected_id, expected_freq]: expected) {
+                    ASSERT_EQUAL(posting.GetDocument(), expected_id);
+                    ASSERT_EQUAL(posting.GetTermFreq(), expected_freq);
+                    posting.Next();
+                }
+                ASSERT_EQUAL(posting.GetDocument(), CompressedPostingList::END);
+            }
+        }
+        ASSERT_EQUAL(changed.GetSize(), expected.size());
+        auto posting = changed.GetIterator();
+        for (int target = 0; target < max_document_id + 10; target += 1 + static_cast<int>(next_random() % 100'000)) {
+            posting.Advance(target);
+            const auto expected_it = expected.lower_bound(target);
+            ASSERT_EQUAL(posting.GetDocument(), expected_it == expected.end() ? CompressedPostingList::END
+                                                                              : expected_it->first);
+            const auto term_freq = changed.FindTermFreq(target);
+            ASSERT_EQUAL(term_freq.has_value(), expected.count(target) > 0);
+        }
+        for (const auto &[id, term_freq]: expected) {
+            ASSERT_EQUAL(changed.FindTermFreq(id).value_or(-1.0), term_freq);
+        }
+    }
+
+    // поиск по сжатым спискам совпадает с обычным
+    SearchServer plain_server("and with"s);
+    SearchServer compressed_server("and with"s);
+    compressed_server.EnableCompressedPostings();
+    vector<string> vocabulary;
+    for (int i = 0; i < 200; ++i) {
+        vocabulary.push_back("word"s + to_string(i));
+    }
+    const int document_count = 20000;
+    size_t posting_count = 0;
+    for (int id = 0; id < document_count; ++id) {
+        string text;
+        const int word_count = 1 + static_cast<int>(next_random() % 20);
+        for (int i = 0; i < word_count; ++i) {
+            text += vocabulary[min(next_random() % vocabulary.size(), next_random() % vocabulary.size())] + " "s;
+        }
+        plain_server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        compressed_server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        posting_count += plain_server.GetWordFrequencies(id).size();
+    }
+    vector<string> queries;
+    for (int i = 0; i < 100; ++i) {
+        queries.push_back(vocabulary[next_random() % 20] + " "s + vocabulary[next_random() % vocabulary.size()]
+                          + " +"s + vocabulary[next_random() % 10] + " -"s + vocabulary[next_random() % 200]);
+        queries.push_back(vocabulary[next_random() % 50] + " "s + vocabulary[next_random() % 5]);
+    }
+    const auto check_same_results = [&]() {
+        for (const string &query: queries) {
+            const auto expected = plain_server.FindTopDocuments(query);
+            for (const auto &actual: {compressed_server.FindTopDocuments(query),
+                                      compressed_server.FindTopDocuments(execution::par, query)}) {
+                ASSERT_EQUAL_HINT(actual.size(), expected.size(), query);
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    ASSERT_EQUAL_HINT(actual[i].id, expected[i].id, query);
+                    ASSERT_EQUAL_HINT(actual[i].relevance, expected[i].relevance, query);
+                }
+            }
+        }
+        for (size_t word = 0; word < 20; ++word) {
+            const string query = "("s + vocabulary[word] + " OR "s + vocabulary[word + 20] + ") AND NOT "s
+                                 + vocabulary[word + 1];
+            const auto expected = plain_server.FindTopDocumentsByBooleanQuery(query);
+            const auto actual = compressed_server.FindTopDocumentsByBooleanQuery(query);
+            ASSERT_HINT(!expected.empty(), query);
+            ASSERT_EQUAL_HINT(actual.size(), expected.size(), query);
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_EQUAL_HINT(actual[i].id, expected[i].id, query);
+            }
+        }
+    };
+    check_same_results();
+    for (int id = 0; id < document_count; id += 7) {
+        plain_server.RemoveDocument(id);
+        if (id % 2 == 0) {
+            compressed_server.RemoveDocument(id);
+        } else {
+            compressed_server.RemoveDocument(execution::par, id);
+        }
+    }
+    plain_server.AddDocument(0, "word1 word2"s, DocumentStatus::ACTUAL, {1});
+    compressed_server.AddDocument(0, "word1 word2"s, DocumentStatus::ACTUAL, {1});
+    check_same_results();
+    // без перестроек: удалённые из блоков документы отмечаются, а не вырезаются
+    for (int id = 1; id < document_count; id += 7) {
+        plain_server.RemoveDocument(id);
+        compressed_server.RemoveDocument(id);
+    }
+    for (int id = 7; id < document_count; id += 49) {
+        plain_server.AddDocument(id, "word3 word4 word3"s, DocumentStatus::ACTUAL, {id});
+        compressed_server.AddDocument(id, "word3 word4 word3"s, DocumentStatus::ACTUAL, {id});
+    }
+    check_same_results();
+    posting_count = 0;
+    for (const int id: plain_server) {
+        posting_count += plain_server.GetWordFrequencies(id).size();
+    }
+
+    const size_t map_memory = posting_count * (3 * sizeof(void *) + 2 * sizeof(int) + sizeof(int) + sizeof(double));
+    cerr << "Memory for "s << posting_count << " postings: std::map<int, double> ~"s << map_memory
+         << " bytes, compressed "s << compressed_server.GetCompressedPostingsMemoryUsage() << " bytes"s << endl;
+    ASSERT(compressed_server.GetCompressedPostingsMemoryUsage() * 4 <= map_memory);
+
+    const int rounds = 2000;
+    double checksum = 0.0;
+    {
+        LOG_DURATION("Decoding "s + to_string(document_freqs.size() * rounds) + " compressed postings"s);
+        for (int round = 0; round < rounds; ++round) {
+            for (auto posting = compressed.GetIterator(); posting.GetDocument() != CompressedPostingList::END;
+                 posting.Next()) {
+                checksum += posting.GetTermFreq();
+            }
+        }
+    }
+    {
+        LOG_DURATION("Iterating "s + to_string(document_freqs.size() * rounds) + " std::map postings"s);
+        for (int round = 0; round < rounds; ++round) {
+            for (const auto &[id, term_freq]: document_freqs) {
+                checksum -= term_freq;
+            }
+        }
+    }
+    ASSERT(abs(checksum) < 1e-3);
+}
+
+void TestDocumentFilter() {
+    const DocumentFilter filter = DocumentFilter().AddStatus(DocumentStatus::ACTUAL).AddStatus(DocumentStatus::BANNED)
+            .SetRatingRange(5, 10).SetDocumentIdRange(100, 200);
+    ASSERT(filter(150, DocumentStatus::ACTUAL, 5));
+    ASSERT(filter(100, DocumentStatus::BANNED, 10));
+    ASSERT(!filter(150, DocumentStatus::IRRELEVANT, 7));
+    ASSERT(!filter(150, DocumentStatus::ACTUAL, 11));
+    ASSERT(!filter(201, DocumentStatus::ACTUAL, 7));
+    ASSERT(DocumentFilter()(0, DocumentStatus::REMOVED, -100));
+
+    for (const string &index_kind: {"map"s, "compressed"s, "bitmaps"s}) {
+        SearchServer search_server("and with"s);
+        if (index_kind == "compressed"s) {
+            search_server.EnableCompressedPostings();
+        } else if (index_kind == "bitmaps"s) {
+            search_server.EnableWordBitmaps();
+        }
+        // рейтинг растёт с id, поэтому блоки id с неподходящим рейтингом пропускаются целиком
+        const int document_count = 20000;
+        for (int id = 0; id < document_count; ++id) {
+            const auto status = id % 10 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+            search_server.AddDocument(id, "cat dog"s + to_string(id % 13), status, {id / 10});
+        }
+        search_server.RemoveDocument(10'005);
+
+        const vector<DocumentFilter> filters = {
+                DocumentFilter().SetRatingRange(1000, 1010),
+                DocumentFilter().AddStatus(DocumentStatus::BANNED).SetRatingRange(500, 1500),
+                DocumentFilter().AddStatus(DocumentStatus::ACTUAL).SetDocumentIdRange(9'990, 10'020),
+                DocumentFilter().AddStatus(DocumentStatus::IRRELEVANT),
+                DocumentFilter(),
+        };
+        for (const DocumentFilter &document_filter: filters) {
+            for (const string &query: {"cat"s, "dog3 -dog4"s, "cat dog7"s, "+dog1 cat"s, "+cat +dog2"s}) {
+                const auto expected = search_server.FindTopDocuments(
+                        query, [&document_filter](int document_id, DocumentStatus status, int rating) {
+                            return document_filter(document_id, status, rating);
+                        });
+                for (const auto &actual: {search_server.FindTopDocuments(query, document_filter),
+                                          search_server.FindTopDocuments(execution::par, query, document_filter)}) {
+                    ASSERT_EQUAL_HINT(actual.size(), expected.size(), query + " "s + index_kind);
+                    for (size_t i = 0; i < expected.size(); ++i) {
+                        ASSERT_EQUAL_HINT(actual[i].id, expected[i].id, query + " "s + index_kind);
+                    }
+                }
+            }
+        }
+
+        // фильтр просматривает лишь блоки с подходящим рейтингом и укладывается в бюджет
+        const DocumentFilter narrow_filter = DocumentFilter().SetRatingRange(1000, 1010);
+        const QueryBudget budget = QueryBudget::WithMaxPostings(2000);
+        bool is_partial = false;
+        const auto filtered = search_server.FindTopDocuments(execution::seq, "cat"s, narrow_filter, budget, is_partial);
+        ASSERT(!is_partial);
+        ASSERT_EQUAL(filtered.size(), static_cast<size_t>(MAX_RESULT_DOCUMENT_COUNT));
+        search_server.FindTopDocuments(execution::seq, "cat"s, [&narrow_filter](int document_id, DocumentStatus status,
+                                                                              int rating) {
+            return narrow_filter(document_id, status, rating);
+        }, budget, is_partial);
+        ASSERT(is_partial);
+        // то же в параллельном поиске и в пересечении обязательных слов
+        for (const string &query: {"cat dog1"s, "+cat +dog1"s}) {
+            is_partial = false;
+            ASSERT_HINT(!search_server.FindTopDocuments(execution::par, query, narrow_filter, budget, is_partial)
+                    .empty(), query + " "s + index_kind);
+            ASSERT_HINT(!is_partial, query + " "s + index_kind);
+        }
+    }
+}
+
+void TestAllocationFreeQueries() {
+    {
+        // запрос, не поместившийся в буфер, увеличивает его для следующих
+        ScratchArena arena(16);
+        {
+            const ScratchArena::Scope scratch(arena);
+            std::pmr::vector<int> values(1000, 0, scratch.GetResource());
+        }
+        ASSERT(arena.GetCapacity() >= 1000 * sizeof(int));
+    }
+    {
+        // буфер сверх предела не сохраняется, арена возвращается к начальному размеру
+        ScratchArena arena(16, 8 * 1024);
+        {
+            const ScratchArena::Scope scratch(arena);
+            std::pmr::vector<int> values(1000, 0, scratch.GetResource());
+        }
+        const size_t grown_capacity = arena.GetCapacity();
+        ASSERT(grown_capacity >= 1000 * sizeof(int) && grown_capacity <= 8 * 1024);
+        {
+            const ScratchArena::Scope scratch(arena);
+            std::pmr::vector<int> values(100000, 0, scratch.GetResource());
+        }
+        ASSERT_EQUAL(arena.GetCapacity(), 16u);
+        {
+            const ScratchArena::Scope scratch(arena);
+            std::pmr::vector<int> values(1000, 0, scratch.GetResource());
+        }
+        ASSERT_EQUAL(arena.GetCapacity(), grown_capacity);
+    }
+
+    SearchServer search_server("and with"s);
+    for (int id = 0; id < 2000; ++id) {
+        const auto status = id % 10 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        search_server.AddDocument(id, "cat dog"s + to_string(id % 13) + (id % 3 == 0 ? " curly"s : " fluffy"s),
+                                  status, {id % 50});
+    }
+    const vector<string_view> queries = {"cat dog3"sv, "fluffy -dog4 -dog5"sv, "+curly dog7 -dog8"sv, "cat* dog1"sv,
+                                         "missing words"sv};
+    vector<Document> result;
+    const auto run_queries = [&search_server, &queries, &result]() {
+        for (const string_view query: queries) {
+            search_server.FindTopDocuments(query, result);
+            search_server.FindTopDocuments(query, DocumentStatus::BANNED, result);
+            search_server.FindTopDocuments(query, [](int document_id, DocumentStatus status, int rating) {
+                return rating > 25;
+            }, result);
+        }
+    };
+    // первые запросы доводят арену потока и буфер выдачи до нужного размера
+    run_queries();
+    const size_t allocations_before = heap_allocation_count;
+    for (int i = 0; i < 100; ++i) {
+        run_queries();
+    }
+    const size_t allocations = heap_allocation_count - allocations_before;
+    ASSERT_EQUAL(allocations, 0u);
+
+    for (const string_view query: queries) {
+        const auto expected = search_server.FindTopDocuments(query, DocumentStatus::BANNED);
+        search_server.FindTopDocuments(query, DocumentStatus::BANNED, result);
+        ASSERT_EQUAL_HINT(result.size(), expected.size(), string(query));
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQUAL_HINT(result[i].id, expected[i].id, string(query));
+            ASSERT_EQUAL_HINT(result[i].relevance, expected[i].relevance, string(query));
+        }
+    }
+}
+
+void TestMatchDocuments() {
+    SearchServer search_server("and with"s);
+    search_server.EnablePositionalIndex();
+    for (int id = 0; id < 300; ++id) {
+        search_server.AddDocument(id, "cat dog"s + to_string(id % 7) + (id % 3 == 0 ? " curly hair"s : " hair fluffy"s)
+                                      + (id % 5 == 0 ? " with collar"s : ""s), DocumentStatus::ACTUAL, {id});
+    }
+    search_server.AddDocument(1000, "and with"s, DocumentStatus::BANNED, {1});
+
+    vector<int> document_ids;
+    for (int id = 299; id >= 0; id -= 3) {
+        document_ids.push_back(id);
+    }
+    document_ids.push_back(1000);
+    document_ids.push_back(7);
+
+    for (const string &query: {"cat dog3 collar"s, "fluffy -dog4 hair"s, "+curly dog2 -collar"s, "dog* +hair"s,
+                               "\"curly hair\" cat"s, "missing"s}) {
+        const auto results = search_server.MatchDocuments(query, document_ids);
+        const auto parallel_results = search_server.MatchDocuments(execution::par, query, document_ids);
+        ASSERT_EQUAL(results.size(), document_ids.size());
+        ASSERT_EQUAL(parallel_results.size(), document_ids.size());
+        for (size_t i = 0; i < document_ids.size(); ++i) {
+            const auto [expected_words, expected_status] = search_server.MatchDocument(query, document_ids[i]);
+            const auto &[words, status] = results[i];
+            ASSERT_EQUAL_HINT(words, expected_words, query);
+            ASSERT_HINT(status == expected_status, query);
+            ASSERT_EQUAL_HINT(get<0>(parallel_results[i]), expected_words, query);
+        }
+    }
+
+    try {
+        search_server.MatchDocuments(execution::par, "cat"s, {1, 2, 555});
+        ASSERT_HINT(false, "Unknown document id must be rejected"s);
+    } catch (const out_of_range &) {
+    }
+}
+
+void TestSearchCursorPagination() {
+    SearchServer search_server("and with"s);
+    // у многих документов совпадают релевантность и рейтинг, порядок между ними задаёт id
+    for (int id = 0; id < 500; ++id) {
+        const auto status = id % 10 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        search_server.AddDocument(id, "cat dog"s + to_string(id % 7) + (id % 4 == 0 ? " curly"s : ""s), status,
+                                  {id % 5});
+    }
+
+    for (const string &query: {"curly dog3"s, "cat -dog2"s, "+curly dog1"s}) {
+        const auto first_page = search_server.FindTopDocumentsPage(query, SearchCursor(), MAX_RESULT_DOCUMENT_COUNT);
+        const auto top_documents = search_server.FindTopDocuments(query);
+        ASSERT_EQUAL_HINT(first_page.documents.size(), top_documents.size(), query);
+        for (size_t i = 0; i < top_documents.size(); ++i) {
+            ASSERT_EQUAL_HINT(first_page.documents[i].relevance, top_documents[i].relevance, query);
+            ASSERT_EQUAL_HINT(first_page.documents[i].rating, top_documents[i].rating, query);
+        }
+
+        // полная выдача в точном порядке: каждый найденный документ отдельным запросом, затем сортировка
+        vector<Document> expected_documents;
+        for (const int document_id: search_server) {
+            const auto single = search_server.FindTopDocuments(
+                    query, [document_id](int id, DocumentStatus status, int) {
+                        return id == document_id && status == DocumentStatus::ACTUAL;
+                    });
+            expected_documents.insert(expected_documents.end(), single.begin(), single.end());
+        }
+        sort(expected_documents.begin(), expected_documents.end(), IsRankedBefore);
+
+        vector<Document> all_documents;
+        SearchCursor cursor;
+        for (int page_count = 0;; ++page_count) {
+            ASSERT_HINT(page_count <= 500, query);
+            // курсор передаётся клиенту токеном и возвращается обратно
+            const auto page = search_server.FindTopDocumentsPage(query, SearchCursor::FromToken(cursor.ToToken()),
+                                                                 7);
+            all_documents.insert(all_documents.end(), page.documents.begin(), page.documents.end());
+            if (!page.next_cursor) {
+                break;
+            }
+            ASSERT_EQUAL_HINT(page.documents.size(), 7u, query);
+            cursor = *page.next_cursor;
+        }
+        // страницы без пропусков и повторов складываются в ту же выдачу, включая порядок равных документов
+        ASSERT_EQUAL_HINT(all_documents.size(), expected_documents.size(), query);
+        for (size_t i = 0; i < expected_documents.size(); ++i) {
+            ASSERT_EQUAL_HINT(all_documents[i].id, expected_documents[i].id, query);
+            ASSERT_EQUAL_HINT(all_documents[i].relevance, expected_documents[i].relevance, query);
+            ASSERT_EQUAL_HINT(all_documents[i].rating, expected_documents[i].rating, query);
+        }
+    }
+
+    {
+        // релевантности различаются меньше чем на EPSILON: сравнение с допуском дало бы цикл 1 < 2 < 3 < 1
+        const Document first{1, 0.5, 5};
+        const Document second{2, 0.5 + 0.6 * EPSILON, 3};
+        const Document third{3, 0.5 + 1.2 * EPSILON, 1};
+        ASSERT(IsRankedBefore(third, second) && IsRankedBefore(second, first) && IsRankedBefore(third, first));
+        ASSERT(!IsRankedBefore(first, second) && !IsRankedBefore(second, third) && !IsRankedBefore(first, third));
+        const SearchCursor cursor = SearchCursor::After(second);
+        ASSERT(cursor.Admits(first) && !cursor.Admits(second) && !cursor.Admits(third));
+    }
+
+    const auto banned_page = search_server.FindTopDocumentsPage("cat"s, DocumentStatus::BANNED, SearchCursor(), 100);
+    ASSERT_EQUAL(banned_page.documents.size(), 50u);
+    ASSERT(!banned_page.next_cursor);
+
+    ASSERT(SearchCursor::FromToken(""s).IsStart());
+    for (const string &token: {"cursor"s, "0x1p-2:3"s, "0x1p-2:3:4:5"s, "0x1p-2:3:-4"s}) {
+        try {
+            SearchCursor::FromToken(token);
+            ASSERT_HINT(false, token);
+        } catch (const invalid_argument &) {
+        }
+    }
+}
+
+void TestDuplicateDetector() {
+    SearchServer search_server("and with"s);
+    search_server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(2, "rat nasty with pet funny funny"s, DocumentStatus::ACTUAL, {1});
+    ASSERT(ComputeTermSetFingerprint(search_server.GetWordFrequencies(1))
+           == ComputeTermSetFingerprint(search_server.GetWordFrequencies(2)));
+    search_server.AddDocument(3, "funny pet and nasty cat"s, DocumentStatus::ACTUAL, {1});
+    ASSERT(ComputeTermSetFingerprint(search_server.GetWordFrequencies(1))
+           != ComputeTermSetFingerprint(search_server.GetWordFrequencies(3)));
+    ASSERT_EQUAL(ComputeJaccardSimilarity(search_server.GetWordFrequencies(1), search_server.GetWordFrequencies(3)),
+                 3.0 / 5.0);
+
+    ASSERT_EQUAL(DuplicateDetector(0.8).GetRowsPerBand(), 8);
+    ASSERT_EQUAL(DuplicateDetector(0.8).GetBandCount(), 16);
+
+    TestRandom next_random(42);
+    vector<vector<string>> documents;
+    for (int i = 0; i < 300; ++i) {
+        vector<string> words;
+        for (int j = 0; j < 20; ++j) {
+            words.push_back("w"s + to_string(next_random() % 3000));
+        }
+        documents.push_back(words);
+    }
+    // почти дубликаты: в копии первых документов заменено одно слово
+    for (int i = 0; i < 100; ++i) {
+        vector<string> words = documents[i];
+        words[next_random() % words.size()] = "changed"s + to_string(i);
+        reverse(words.begin(), words.end());
+        documents.push_back(words);
+    }
+    SearchServer corpus;
+    for (size_t id = 0; id < documents.size(); ++id) {
+        string text;
+        for (const string &word: documents[id]) {
+            text += word + " "s;
+        }
+        text.pop_back();
+        corpus.AddDocument(static_cast<int>(id), text, DocumentStatus::ACTUAL, {1});
+    }
+
+    for (const double min_similarity: {1.0, 0.8, 0.5}) {
+        set<int> expected;
+        for (int id = 0; id < static_cast<int>(documents.size()); ++id) {
+            for (int other_id = 0; other_id < id; ++other_id) {
+                if (ComputeJaccardSimilarity(corpus.GetWordFrequencies(other_id), corpus.GetWordFrequencies(id))
+                    >= min_similarity) {
+                    expected.insert(id);
+                    break;
+                }
+            }
+        }
+        const auto duplicates = DuplicateDetector(min_similarity).FindDuplicates(corpus);
+        ASSERT_EQUAL(set<int>(duplicates.begin(), duplicates.end()), expected);
+    }
+    ASSERT_EQUAL(DuplicateDetector(0.8).FindDuplicates(corpus).size(), 100u);
+
+    {
+        // общее надмножество не делает похожими два несвязанных документа
+        SearchServer chain_server;
+        chain_server.AddDocument(1, "a b c d"s, DocumentStatus::ACTUAL, {1});
+        chain_server.AddDocument(2, "e f g h"s, DocumentStatus::ACTUAL, {1});
+        chain_server.AddDocument(3, "a b c d e f g h"s, DocumentStatus::ACTUAL, {1});
+        const DuplicateDetector detector(0.5);
+        ASSERT_EQUAL(detector.FindDuplicates(chain_server), vector<int>{3});
+        ASSERT(detector.FindDuplicateGroups(chain_server) == (vector<vector<int>>{{1, 3}}));
+        RemoveDuplicates(chain_server, 0.5);
+        ASSERT_EQUAL(vector<int>(chain_server.begin(), chain_server.end()), (vector<int>{1, 2}));
+    }
+    {
+        // частое слово собирает половину документов в одну корзину, число сравнений в ней ограничено
+        SearchServer hot_server;
+        const int document_count = 5000;
+        for (int id = 0; id < document_count; ++id) {
+            hot_server.AddDocument(id, "common w"s + to_string(id), DocumentStatus::ACTUAL, {1});
+        }
+        hot_server.AddDocument(document_count, "w4000 common"s, DocumentStatus::ACTUAL, {1});
+        const DuplicateDetector detector(0.5, 2, 1);
+        ASSERT_EQUAL(detector.FindDuplicates(hot_server), vector<int>{document_count});
+    }
+}
+
+void TestDuplicateDetectionOnInsert() {
+    {
+        SearchServer search_server("and with"s);
+        search_server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {7, 2, 7});
+        search_server.AddDocument(5, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+        search_server.AddDocument(6, "funny pet and curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+        // уже имеющиеся дубликаты удаляются при включении
+        search_server.EnableDuplicateDetection(DuplicatePolicy::REJECT);
+        ASSERT_EQUAL(search_server.GetDocumentCount(), 2);
+
+        try {
+            search_server.AddDocument(7, "rat nasty funny funny pet"s, DocumentStatus::ACTUAL, {1});
+            ASSERT_HINT(false, "Duplicate with a greater id must be rejected"s);
+        } catch (const invalid_argument &) {
+        }
+        ASSERT_EQUAL(search_server.GetDocumentCount(), 2);
+        ASSERT(search_server.FindTopDocuments("rat"s).size() == 1u);
+        // документ с меньшим id вытесняет прежний
+        search_server.AddDocument(3, "curly hair with funny pet"s, DocumentStatus::ACTUAL, {1});
+        ASSERT_EQUAL(vector<int>(search_server.begin(), search_server.end()), (vector<int>{1, 3}));
+        // после удаления оригинала его набор слов снова свободен
+        search_server.RemoveDocument(1);
+        search_server.AddDocument(7, "rat nasty funny funny pet"s, DocumentStatus::ACTUAL, {1});
+        ASSERT_EQUAL(search_server.GetDocumentCount(), 2);
+    }
+    {
+        SearchServer search_server("and with"s);
+        search_server.EnableDuplicateDetection(DuplicatePolicy::FLAG);
+        search_server.AddDocument(4, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {1});
+        search_server.AddDocument(8, "nasty rat funny pet"s, DocumentStatus::ACTUAL, {1});
+        search_server.AddDocument(2, "pet rat funny nasty"s, DocumentStatus::ACTUAL, {1});
+        search_server.AddDocument(9, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1});
+        ASSERT_EQUAL(search_server.GetDocumentCount(), 4);
+        ASSERT_EQUAL(search_server.GetDuplicates(), (vector<int>{4, 8}));
+        ASSERT(!search_server.IsDuplicate(2));
+        ASSERT(!search_server.IsDuplicate(9));
+        search_server.RemoveDocument(2);
+        ASSERT_EQUAL(search_server.GetDuplicates(), (vector<int>{8}));
+        ASSERT(!search_server.IsDuplicate(4));
+    }
+    {
+        // включение на сервере, где дубликаты уже есть
+        const auto fill_server = [](SearchServer &search_server) {
+            search_server.AddDocument(1, "cat dog"s, DocumentStatus::ACTUAL, {1});
+            search_server.AddDocument(2, "dog cat"s, DocumentStatus::ACTUAL, {1});
+            search_server.AddDocument(3, "bird"s, DocumentStatus::ACTUAL, {1});
+            search_server.AddDocument(4, "dog dog cat"s, DocumentStatus::ACTUAL, {1});
+        };
+        SearchServer flag_server("and with"s);
+        fill_server(flag_server);
+        flag_server.EnableDuplicateDetection(DuplicatePolicy::FLAG);
+        ASSERT_EQUAL(flag_server.GetDocumentCount(), 4);
+        ASSERT_EQUAL(flag_server.GetDuplicates(), (vector<int>{2, 4}));
+        ASSERT(!flag_server.IsDuplicate(1));
+        ASSERT(!flag_server.IsDuplicate(3));
+
+        SearchServer reject_server("and with"s);
+        fill_server(reject_server);
+        reject_server.EnableDuplicateDetection(DuplicatePolicy::REJECT);
+        ASSERT_EQUAL(vector<int>(reject_server.begin(), reject_server.end()), (vector<int>{1, 3}));
+        ASSERT(reject_server.GetDuplicates().empty());
+
+        // FLAG, затем REJECT: отпечатки уже есть, удаляются помеченные
+        flag_server.EnableDuplicateDetection(DuplicatePolicy::REJECT);
+        ASSERT_EQUAL(vector<int>(flag_server.begin(), flag_server.end()), (vector<int>{1, 3}));
+    }
+    {
+        // с обычным удалением дубликатов совпадают как набор удаляемых документов, так и оставшиеся
+        SearchServer expected_server("and with"s);
+        SearchServer search_server("and with"s);
+        search_server.EnableDuplicateDetection(DuplicatePolicy::REJECT);
+        TestRandom next_random(7);
+        for (int id = 0; id < 60; ++id) {
+            const int first = next_random() % 6;
+            const int second = next_random() % 6;
+            const string text = "word"s + to_string(first) + " and word"s + to_string(second) + " word"s
+                                + to_string(first);
+            expected_server.AddDocument(id, text, DocumentStatus::ACTUAL, {1});
+            try {
+                search_server.AddDocument(id, text, DocumentStatus::ACTUAL, {1});
+            } catch (const invalid_argument &) {
+            }
+        }
+        RemoveDuplicates(expected_server);
+        ASSERT_EQUAL(vector<int>(search_server.begin(), search_server.end()),
+                     vector<int>(expected_server.begin(), expected_server.end()));
+    }
+}
+
+void TestConcurrentRequestQueue() {
+    SearchServer search_server("and in at"s);
+    search_server.AddDocument(1, "curly cat curly tail"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    search_server.AddDocument(2, "curly dog and fancy collar"s, DocumentStatus::ACTUAL, {1, 2, 3});
+    {
+        // в счётном окне те же ответы, что у RequestQueue
+        ConcurrentRequestQueue request_queue(search_server, 4);
+        ASSERT_EQUAL(request_queue.GetCapacity(), 4u);
+        for (const string_view query: {"empty"sv, "curly"sv, "empty"sv, "empty"sv, "dog"sv, "empty"sv}) {
+            request_queue.AddFindRequest(query);
+        }
+        ASSERT_EQUAL(request_queue.GetNoResultRequests(), 3);
+        ASSERT_EQUAL(request_queue.GetTotalRequests(), 6u);
+    }
+    {
+        // ёмкость не округляется: при 1440, как у RequestQueue, ответы совпадают на каждом шаге
+        ConcurrentRequestQueue request_queue(search_server, ConcurrentRequestQueue::DEFAULT_CAPACITY);
+        RequestQueue reference_queue(search_server);
+        ASSERT_EQUAL(request_queue.GetCapacity(), 1440u);
+        TestRandom next_random(11);
+        for (int i = 0; i < 4000; ++i) {
+            // длинные серии пустых и непустых запросов, чтобы вытеснение меняло счётчик
+            const string query = (next_random() % 1000 < static_cast<uint32_t>(i % 1000 < 500 ? 800 : 200))
+                                 ? "empty"s : "curly"s;
+            request_queue.AddFindRequest(query);
+            reference_queue.AddFindRequest(query);
+            ASSERT_EQUAL_HINT(request_queue.GetNoResultRequests(), reference_queue.GetNoResultRequests(),
+                              "Request "s + to_string(i));
+        }
+    }
+    {
+        using namespace std::chrono;
+        ConcurrentRequestQueue request_queue(search_server, 16);
+        const auto start = ConcurrentRequestQueue::Clock::now();
+        for (int minute = 0; minute < 10; ++minute) {
+            request_queue.RecordRequest(minute % 3 == 0 ? 0 : 5, start + minutes(minute));
+        }
+        const auto now = start + minutes(9);
+        const RequestStatistics last_minutes = request_queue.GetStatistics(minutes(4), now);
+        ASSERT_EQUAL(last_minutes.requests, 5u);
+        ASSERT_EQUAL(last_minutes.no_result_requests, 2u);
+        const RequestStatistics all = request_queue.GetStatistics(hours(1), now);
+        ASSERT_EQUAL(all.requests, 10u);
+        ASSERT_EQUAL(all.no_result_requests, 4u);
+        // запросы из будущего не учитываются
+        ASSERT_EQUAL(request_queue.GetStatistics(hours(1), start + minutes(2)).requests, 3u);
+    }
+    {
+        ConcurrentRequestQueue request_queue(search_server, 4096);
+        const int thread_count = 4;
+        const int requests_per_thread = 500;
+        vector<thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&request_queue, t] {
+                for (int i = 0; i < requests_per_thread; ++i) {
+                    request_queue.AddFindRequest((i + t) % 2 == 0 ? "curly"sv : "parrot"sv);
+                }
+            });
+        }
+        for (thread &worker: threads) {
+            worker.join();
+        }
+        ASSERT_EQUAL(request_queue.GetTotalRequests(), static_cast<uint64_t>(thread_count * requests_per_thread));
+        ASSERT_EQUAL(request_queue.GetNoResultRequests(), thread_count * requests_per_thread / 2);
+        const RequestStatistics statistics = request_queue.GetStatistics(std::chrono::hours(1));
+        ASSERT_EQUAL(statistics.requests, static_cast<uint64_t>(thread_count * requests_per_thread));
+        ASSERT_EQUAL(statistics.no_result_requests, static_cast<uint64_t>(thread_count * requests_per_thread / 2));
+    }
+}
+
+void TestQueryAnalytics() {
+    using namespace std::chrono;
+    {
+        AtomicHistogram histogram;
+        for (uint64_t value = 1; value <= 1000; ++value) {
+            histogram.Record(value);
+        }
+        const HistogramSnapshot snapshot = histogram.GetSnapshot();
+        ASSERT_EQUAL(snapshot.GetTotalCount(), 1000u);
+        ASSERT_EQUAL(snapshot.GetSum(), 500500u);
+        ASSERT_EQUAL(snapshot.GetValueAtPercentile(1.0), 10u);
+        for (const double percentile: {50.0, 90.0, 99.0, 99.9}) {
+            const double exact = percentile * 10.0;
+            const double value = static_cast<double>(snapshot.GetValueAtPercentile(percentile));
+            ASSERT_HINT(exact <= value && value <= exact * (1.0 + 1.0 / 16), "Percentile "s + to_string(percentile));
+        }
+        ASSERT(snapshot.GetMaxValue() >= 1000u && snapshot.GetMaxValue() <= 1000u + 1000u / 16);
+    }
+    {
+        QueryAnalytics analytics(minutes(1), 4);
+        const auto start = QueryAnalytics::Clock::now();
+        TestRandom next_random(3);
+        for (int i = 0; i < 400; ++i) {
+            const auto time = start + seconds(next_random() % 60);
+            if (i % 8 == 0) {
+                analytics.RecordQuery("curly cat"sv, 3, microseconds(100), time);
+            } else if (i % 8 == 1) {
+                analytics.RecordQuery("fancy parrot"sv, 0, microseconds(300), time);
+            } else {
+                analytics.RecordQuery("rare query "s + to_string(i), 1, microseconds(200), time);
+            }
+        }
+        const QueryAnalyticsReport report = analytics.GetReport(minutes(1), start + seconds(59), 2);
+        ASSERT_EQUAL(report.queries, 400u);
+        ASSERT_EQUAL(report.zero_result_queries, 50u);
+        ASSERT_EQUAL(report.result_counts.GetValueAtPercentile(10.0), 0u);
+        ASSERT_EQUAL(report.result_counts.GetMaxValue(), 3u);
+        const uint64_t median_latency = report.latency_ns.GetValueAtPercentile(50.0);
+        ASSERT(200000u <= median_latency && median_latency <= 200000u + 200000u / 16);
+        ASSERT_EQUAL(report.top_queries.size(), 2u);
+        ASSERT_EQUAL(report.top_queries[0].query, "curly cat"s);
+        ASSERT(report.top_queries[0].count >= 50u);
+        ASSERT_EQUAL(report.top_queries[1].query, "fancy parrot"s);
+        ASSERT_EQUAL(report.top_zero_result_queries.size(), 1u);
+        ASSERT_EQUAL(report.top_zero_result_queries[0].query, "fancy parrot"s);
+        ASSERT_EQUAL(report.top_zero_result_queries[0].count, 50u);
+
+        // окно за 10-ю минуту вытесняет самое старое, отчёт за последние две минуты видит только его
+        analytics.RecordQuery("curly cat"sv, 3, microseconds(100), start + minutes(10));
+        const QueryAnalyticsReport recent = analytics.GetReport(minutes(2), start + minutes(10));
+        ASSERT_EQUAL(recent.queries, 1u);
+        ASSERT_EQUAL(recent.top_queries[0].count, 1u);
+        // слишком старые запросы отбрасываются
+        analytics.RecordQuery("curly cat"sv, 3, microseconds(100), start + minutes(2));
+        ASSERT_EQUAL(analytics.GetDroppedQueries(), 1u);
+    }
+    {
+        QueryAnalytics analytics(hours(1));
+        const int thread_count = 4;
+        const int queries_per_thread = 1000;
+        vector<thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&analytics, t] {
+                for (int i = 0; i < queries_per_thread; ++i) {
+                    analytics.RecordQuery(i % 2 == 0 ? "curly cat"s : "query "s + to_string(t * queries_per_thread + i),
+                                          i % 2, microseconds(i));
+                }
+            });
+        }
+        for (thread &worker: threads) {
+            worker.join();
+        }
+        const QueryAnalyticsReport report = analytics.GetReport(hours(1));
+        ASSERT_EQUAL(report.queries, static_cast<uint64_t>(thread_count * queries_per_thread));
+        ASSERT_EQUAL(report.latency_ns.GetTotalCount(), static_cast<uint64_t>(thread_count * queries_per_thread));
+        ASSERT_EQUAL(report.top_queries[0].query, "curly cat"s);
+        // оценка Count-Min не меньше точной частоты
+        ASSERT(report.top_queries[0].count >= static_cast<uint64_t>(thread_count * queries_per_thread / 2));
+    }
+    {
+        SearchServer search_server("and in at"s);
+        search_server.AddDocument(1, "curly cat curly tail"s, DocumentStatus::ACTUAL, {7, 2, 7});
+        QueryAnalytics analytics;
+        RequestQueue request_queue(search_server);
+        request_queue.EnableAnalytics(analytics);
+        request_queue.AddFindRequest("curly"s);
+        request_queue.AddFindRequest("parrot"s);
+        const QueryAnalyticsReport report = analytics.GetReport(minutes(1));
+        ASSERT_EQUAL(report.queries, 2u);
+        ASSERT_EQUAL(report.zero_result_queries, 1u);
+        ASSERT_EQUAL(report.top_zero_result_queries[0].query, "parrot"s);
+    }
+}
+
+void TestMetricsRegistry() {
+    const MetricsSnapshot before = MetricsRegistry::Instance().GetSnapshot();
+    {
+        SearchServer search_server("and in at"s);
+        search_server.AddDocument(1, "curly cat curly tail"s, DocumentStatus::ACTUAL, {7, 2, 7});
+        search_server.AddDocument(2, "curly dog and fancy collar"s, DocumentStatus::ACTUAL, {1, 2, 3});
+        search_server.FindTopDocuments("curly -dog"s);
+        thread([&search_server] {
+            search_server.FindTopDocuments(execution::par, "fancy cat"s);
+        }).join();
+        search_server.RemoveDocument(execution::par, 2);
+        search_server.RemoveDocument(5);
+    }
+    const MetricsSnapshot after = MetricsRegistry::Instance().GetSnapshot();
+    const auto get_added_count = [&before, &after](MetricStage stage) {
+        return after.GetStageDurations(stage).GetTotalCount() - before.GetStageDurations(stage).GetTotalCount();
+    };
+#ifdef SEARCH_SERVER_METRICS
+    ASSERT_EQUAL(get_added_count(MetricStage::ADD_DOCUMENT), 2u);
+    ASSERT_EQUAL(get_added_count(MetricStage::REMOVE_DOCUMENT), 1u);
+    for (const MetricStage stage: {MetricStage::QUERY_PARSE, MetricStage::QUERY_LOOKUP, MetricStage::QUERY_SCORE,
+                                   MetricStage::QUERY_SORT, MetricStage::QUERY_TOTAL}) {
+        ASSERT_EQUAL_HINT(get_added_count(stage), 2u, string(GetMetricStageName(stage)));
+    }
+    ASSERT_EQUAL(after.GetCounter(MetricCounter::QUERIES) - before.GetCounter(MetricCounter::QUERIES), 2u);
+    ASSERT_EQUAL(after.GetCounter(MetricCounter::ADDED_DOCUMENTS) - before.GetCounter(MetricCounter::ADDED_DOCUMENTS),
+                 2u);
+    const HistogramSnapshot &total = after.GetStageDurations(MetricStage::QUERY_TOTAL);
+    ASSERT(total.GetSum() >= after.GetStageDurations(MetricStage::QUERY_PARSE).GetSum());
+#else
+    ASSERT_EQUAL(get_added_count(MetricStage::QUERY_TOTAL), 0u);
+#endif
+
+    ostringstream prometheus;
+    WritePrometheusText(prometheus, after);
+    const string prometheus_text = prometheus.str();
+    ASSERT(prometheus_text.find("# TYPE search_server_stage_duration_seconds histogram\n"s) != string::npos);
+    ASSERT(prometheus_text.find("search_server_stage_duration_seconds_bucket{stage=\"query_parse\",le=\"+Inf\"} "s
+                                + to_string(after.GetStageDurations(MetricStage::QUERY_PARSE).GetTotalCount()))
+           != string::npos);
+    ASSERT(prometheus_text.find("search_server_removed_documents_total "s) != string::npos);
+
+    ostringstream json;
+    WriteJson(json, after);
+    ASSERT(json.str().find("\"add_document\":{\"count\":"s
+                           + to_string(after.GetStageDurations(MetricStage::ADD_DOCUMENT).GetTotalCount()))
+           != string::npos);
+
+    const string path = (filesystem::temp_directory_path() / "search_server_metrics.json").string();
+    {
+        MetricsFileExporter exporter(path, MetricsFormat::JSON, chrono::hours(1));
+    }
+    ifstream exported(path);
+    string exported_json;
+    getline(exported, exported_json);
+    ASSERT_EQUAL(exported_json.substr(0, 11), "{\"stages\":{"s);
+    filesystem::remove(path);
+}
+
+void TestChromeTracing() {
+    SearchServer search_server("and in at"s);
+    search_server.AddDocument(1, "curly cat curly tail"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    search_server.AddDocument(2, "curly dog and fancy collar"s, DocumentStatus::ACTUAL, {1, 2, 3});
+    search_server.AddDocument(3, "big cat fancy collar "s, DocumentStatus::ACTUAL, {1, 2, 8});
+    const vector<string> queries = {"curly cat"s, "fancy collar"s, "big dog"s, "curly -dog"s};
+
+    Tracer &tracer = Tracer::Instance();
+    tracer.Start();
+    ProcessQueries(search_server, queries);
+    search_server.RemoveDocument(3);
+    tracer.Stop();
+    // после остановки события не пишутся
+    search_server.FindTopDocuments("curly"s);
+
+    ostringstream trace;
+    tracer.WriteChromeTrace(trace);
+    const string trace_json = trace.str();
+    const auto count_events = [&trace_json](const string &name) {
+        const string pattern = "{\"name\":\""s + name + "\",\"cat\":\"search_server\",\"ph\":\"X\""s;
+        size_t count = 0;
+        for (size_t position = trace_json.find(pattern); position != string::npos;
+             position = trace_json.find(pattern, position + 1)) {
+            ++count;
+        }
+        return count;
+    };
+    ASSERT_EQUAL(trace_json.substr(0, 39), "{\"displayTimeUnit\":\"ns\",\"traceEvents\":["s);
+#ifdef SEARCH_SERVER_TRACING
+    ASSERT_EQUAL(count_events("ProcessQueries"s), 1u);
+    ASSERT_EQUAL(count_events("ProcessQueries query"s), queries.size());
+    ASSERT_EQUAL(count_events("FindTopDocuments"s), queries.size());
+    ASSERT_EQUAL(count_events("ParseQuery"s), queries.size());
+    ASSERT_EQUAL(count_events("Sort"s), queries.size());
+    // по событию на каждое плюс-слово запроса
+    ASSERT_EQUAL(count_events("FindAllDocuments word"s), 7u);
+    ASSERT_EQUAL(count_events("RemoveDocument"s), 1u);
+    ASSERT(trace_json.find("\"ph\":\"M\""s) != string::npos);
+#else
+    ASSERT_EQUAL(count_events("FindTopDocuments"s), 0u);
+#endif
+}
+
+void TestFindTopDocumentsWithStats() {
+    const auto fill_server = [](SearchServer &search_server) {
+        search_server.AddDocument(1, "curly cat curly tail"s, DocumentStatus::ACTUAL, {7, 2, 7});
+        search_server.AddDocument(2, "curly dog and fancy collar"s, DocumentStatus::ACTUAL, {1, 2, 3});
+        search_server.AddDocument(3, "big cat fancy collar"s, DocumentStatus::BANNED, {1, 2, 8});
+        search_server.AddDocument(4, "curly parrot"s, DocumentStatus::ACTUAL, {5});
+    };
+    SearchServer search_server("and in at"s);
+    fill_server(search_server);
+    {
+        QueryStats stats;
+        const auto documents = search_server.FindTopDocumentsWithStats("curly cat -dog"s, stats);
+        ASSERT_EQUAL(documents.size(), 2u);
+        ASSERT(stats.strategy == QueryStrategy::EXHAUSTIVE);
+        ASSERT_EQUAL(stats.plus_words, 2u);
+        ASSERT_EQUAL(stats.minus_words, 1u);
+        // curly: 1, 2, 4; cat: 1, 3
+        ASSERT_EQUAL(stats.scanned_postings, 5u);
+        ASSERT_EQUAL(stats.excluded_postings, 1u);
+        ASSERT_EQUAL(stats.predicate_rejections, 1u);
+        ASSERT_EQUAL(stats.candidates, 2u);
+        ASSERT_EQUAL(stats.results, 2u);
+        ASSERT(!stats.is_partial);
+        ASSERT(stats.total_time >= stats.parse_time + stats.lookup_time + stats.score_time);
+
+        QueryStats parallel_stats;
+        const auto parallel_documents = search_server.FindTopDocumentsWithStats(
+                execution::par, "curly cat -dog"s, DocumentStatusPredicate{DocumentStatus::ACTUAL}, parallel_stats);
+        ASSERT_EQUAL(parallel_documents.size(), documents.size());
+        ASSERT_EQUAL(parallel_stats.scanned_postings, 5u);
+        ASSERT_EQUAL(parallel_stats.predicate_rejections, 1u);
+
+        ostringstream log;
+        log << stats;
+        ASSERT(log.str().find("strategy=exhaustive plus_words=2 required_words=0 minus_words=1 scanned_postings=5 "s)
+               == 0);
+    }
+    {
+        QueryStats stats;
+        const auto documents = search_server.FindTopDocumentsWithStats(
+                "+collar fancy"s, [](int, DocumentStatus, int rating) { return rating > 2; }, stats);
+        ASSERT_EQUAL(documents.size(), 1u);
+        ASSERT(stats.strategy == QueryStrategy::REQUIRED_WORDS);
+        ASSERT_EQUAL(stats.required_words, 1u);
+        ASSERT_EQUAL(stats.predicate_rejections, 1u);
+        ASSERT_EQUAL(stats.candidates, 1u);
+    }
+    {
+        SearchServer impact_server("and in at"s);
+        impact_server.EnableImpactLists(1);
+        fill_server(impact_server);
+        QueryStats stats;
+        const auto documents = impact_server.FindTopDocumentsWithStats("curly cat"s, DocumentStatus::ACTUAL, stats);
+        ASSERT(stats.strategy == QueryStrategy::IMPACTS);
+        ASSERT_EQUAL(documents.size(), 3u);
+        ASSERT_EQUAL(stats.results, 3u);
+        ASSERT_EQUAL(stats.predicate_rejections + stats.candidates, 4u);
+    }
+}
+
+void TestCorpusGenerator() {
+    CorpusOptions options;
+    options.vocabulary_size = 1000;
+    options.seed = 7;
+    CorpusGenerator generator(options);
+    CorpusGenerator same_generator(options);
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_EQUAL(generator.GenerateDocument(), same_generator.GenerateDocument());
+        ASSERT_EQUAL(generator.GenerateQuery(), same_generator.GenerateQuery());
+    }
+    options.seed = 8;
+    ASSERT(CorpusGenerator(options).GenerateDocument() != generator.GenerateDocument());
+
+    set<string> words;
+    for (size_t rank = 0; rank < options.vocabulary_size; ++rank) {
+        words.insert(generator.GetWord(rank));
+    }
+    ASSERT_EQUAL(words.size(), options.vocabulary_size);
+    ASSERT_EQUAL(generator.GetMostFrequentWords(3), (vector<string>{"a"s, "b"s, "c"s}));
+
+    // при показателе 1 слово ранга r встречается в r + 1 раз реже самого частого
+    vector<int> rank_counts(options.vocabulary_size, 0);
+    const int sample_count = 200000;
+    for (int i = 0; i < sample_count; ++i) {
+        ++rank_counts[generator.GenerateWordRank()];
+    }
+    for (const size_t rank: {1u, 3u, 9u}) {
+        const double ratio = static_cast<double>(rank_counts[0]) / rank_counts[rank];
+        ASSERT_HINT(abs(ratio - static_cast<double>(rank + 1)) < 0.15 * static_cast<double>(rank + 1),
+                    "Rank "s + to_string(rank) + " ratio "s + to_string(ratio));
+    }
+
+    SearchServer search_server(generator.GetMostFrequentWords(10));
+    for (int id = 0; id < 100; ++id) {
+        search_server.AddDocument(id, generator.GenerateDocument(), generator.GenerateStatus(),
+                                  generator.GenerateRatings());
+    }
+    for (int i = 0; i < 100; ++i) {
+        const string query = generator.GenerateQuery();
+        ASSERT_HINT(query.front() != '-', query);
+        search_server.FindTopDocuments(query);
+    }
+}
+
+void TestQueryLog() {
+    {
+        SearchServer search_server("and in at"s);
+        search_server.AddDocument(1, "curly cat curly tail"s, DocumentStatus::ACTUAL, {7, 2, 7});
+        ostringstream log;
+        RequestQueue request_queue(search_server);
+        request_queue.EnableQueryLog(log);
+        request_queue.AddFindRequest("curly dog"s);
+        request_queue.AddFindRequest("big -cat"s, DocumentStatus::BANNED);
+
+        istringstream input(log.str());
+        const vector<LoggedQuery> queries = ReadQueryLog(input);
+        ASSERT_EQUAL(queries.size(), 2u);
+        ASSERT_EQUAL(queries[0].raw_query, "curly dog"s);
+        ASSERT_EQUAL(queries[1].raw_query, "big -cat"s);
+        ASSERT(queries[0].offset <= queries[1].offset);
+    }
+    {
+        istringstream input("# recorded log\n\n0\tcurly cat\n1500\tfancy collar\r\nbig dog\n"s);
+        const vector<LoggedQuery> queries = ReadQueryLog(input);
+        ASSERT_EQUAL(queries.size(), 3u);
+        ASSERT_EQUAL(queries[1].raw_query, "fancy collar"s);
+        ASSERT_EQUAL(queries[1].offset.count(), 1500);
+        // строка без смещения наследует предыдущее
+        ASSERT_EQUAL(queries[2].raw_query, "big dog"s);
+        ASSERT_EQUAL(queries[2].offset.count(), 1500);
+
+        ostringstream output;
+        for (const LoggedQuery &query: queries) {
+            WriteQueryLogEntry(output, query);
+        }
+        ASSERT_EQUAL(output.str(), "0\tcurly cat\n1500\tfancy collar\n1500\tbig dog\n"s);
+    }
+    for (const string &bad_log: {"12x\tcurly cat\n"s, "-5\tcurly cat\n"s, "\tcurly cat\n"s}) {
+        istringstream input(bad_log);
+        try {
+            ReadQueryLog(input);
+            ASSERT_HINT(false, "Invalid offset must be rejected: "s + bad_log);
+        } catch (const invalid_argument &) {
+        }
+    }
+}
+
 void TestSearchServer() {
     RUN_TEST(TestAddDocument);
     RUN_TEST(TestExcludeStopWordsFromAddedDocumentContent);
@@ -898,6 +2681,32 @@ void TestSearchServer() {
     RUN_TEST(TestProcessQueries);
     RUN_TEST(TestProcessQueriesJoined);
     RUN_TEST(TestFindTopDocumentParallel);
+    RUN_TEST(TestFindTopDocumentsWithBudget);
+    RUN_TEST(TestMinusWordsExcludedInBothPolicies);
+    RUN_TEST(TestRoaringBitmap);
+    RUN_TEST(TestWordBitmaps);
+    RUN_TEST(TestRequiredWords);
+    RUN_TEST(TestBooleanQuery);
+    RUN_TEST(TestPhraseQueries);
+    RUN_TEST(TestPrefixQueries);
+    RUN_TEST(TestFuzzyQueries);
+    RUN_TEST(TestImpactLists);
+    RUN_TEST(TestQuantizedImpacts);
+    RUN_TEST(TestSimdKernels);
+    RUN_TEST(TestCompressedPostings);
+    RUN_TEST(TestDocumentFilter);
+    RUN_TEST(TestAllocationFreeQueries);
+    RUN_TEST(TestMatchDocuments);
+    RUN_TEST(TestSearchCursorPagination);
+    RUN_TEST(TestDuplicateDetector);
+    RUN_TEST(TestDuplicateDetectionOnInsert);
+    RUN_TEST(TestConcurrentRequestQueue);
+    RUN_TEST(TestQueryAnalytics);
+    RUN_TEST(TestMetricsRegistry);
+    RUN_TEST(TestChromeTracing);
+    RUN_TEST(TestFindTopDocumentsWithStats);
+    RUN_TEST(TestCorpusGenerator);
+    RUN_TEST(TestQueryLog);
 }
 
 // --------- Окончание модульных тестов поисковой системы -----------
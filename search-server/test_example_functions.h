@@ -1,17 +1,37 @@
 #pragma once
 
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory_resource>
+#include <new>
+#include <numeric>
 #include <set>
+#include <thread>
 #include <utility>
 #include <vector>
 
 
+#include "concurrent_request_queue.h"
+#include "corpus_generator.h"
 #include "document.h"
+#include "duplicate_detector.h"
+#include "metrics.h"
 #include "process_queries.h"
+#include "query_analytics.h"
+#include "query_log.h"
+#include "query_stats.h"
 #include "remove_duplicates.h"
+#include "request_queue.h"
 #include "search_server.h"
 #include "log_duration.h"
+#include "roaring_bitmap.h"
+#include "scratch_arena.h"
+#include "simd_kernels.h"
+#include "tracing.h"
 
 
 template<typename First, typename Second>
@@ -121,6 +141,32 @@ void TestRemoveDuplicate();
 void TestProcessQueries();
 void TestProcessQueriesJoined();
 void TestFindTopDocumentParallel();
+void TestFindTopDocumentsWithBudget();
+void TestMinusWordsExcludedInBothPolicies();
+void TestRoaringBitmap();
+void TestWordBitmaps();
+void TestRequiredWords();
+void TestBooleanQuery();
+void TestPhraseQueries();
+void TestPrefixQueries();
+void TestFuzzyQueries();
+void TestImpactLists();
+void TestQuantizedImpacts();
+void TestSimdKernels();
+void TestCompressedPostings();
+void TestDocumentFilter();
+void TestAllocationFreeQueries();
+void TestMatchDocuments();
+void TestSearchCursorPagination();
+void TestDuplicateDetector();
+void TestDuplicateDetectionOnInsert();
+void TestConcurrentRequestQueue();
+void TestQueryAnalytics();
+void TestMetricsRegistry();
+void TestChromeTracing();
+void TestFindTopDocumentsWithStats();
+void TestCorpusGenerator();
+void TestQueryLog();
 
 void TestSearchServer();
 
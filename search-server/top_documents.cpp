@@ -0,0 +1,42 @@
+#include "top_documents.h"
+
+#include <algorithm>
+
+TopDocuments::TopDocuments(size_t count)
+        : count_(count) {
+}
+
+void TopDocuments::Add(const Document &document) {
+    if (count_ == 0) {
+        return;
+    }
+    if (documents_.size() < count_) {
+        documents_.push(document);
+    } else if (IsRankedHigher(document, documents_.top())) {
+        documents_.pop();
+        documents_.push(document);
+    }
+}
+
+bool TopDocuments::IsFull() const {
+    return documents_.size() == count_;
+}
+
+const Document &TopDocuments::GetWorst() const {
+    return documents_.top();
+}
+
+size_t TopDocuments::GetSize() const {
+    return documents_.size();
+}
+
+std::vector<Document> TopDocuments::Extract() {
+    std::vector<Document> result;
+    result.reserve(documents_.size());
+    while (!documents_.empty()) {
+        result.push_back(documents_.top());
+        documents_.pop();
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <queue>
+#include <vector>
+
+#include "document.h"
+
+// Отбирает k лучших документов без хранения остальных: O(n log k) вместо сортировки всех найденных
+class TopDocuments {
+public:
+    explicit TopDocuments(size_t count);
+
+    void Add(const Document &document);
+
+    bool IsFull() const;
+
+    // Худший из отобранных документов, определён для непустого набора
+    const Document &GetWorst() const;
+
+    size_t GetSize() const;
+
+    // Отобранные документы в порядке выдачи, набор после вызова пуст
+    std::vector<Document> Extract();
+
+private:
+    struct RankedLower {
+        bool operator()(const Document &lhs, const Document &rhs) const {
+            return IsRankedHigher(lhs, rhs);
+        }
+    };
+
+    size_t count_;
+    // На вершине худший документ
+    std::priority_queue<Document, std::vector<Document>, RankedLower> documents_;
+};
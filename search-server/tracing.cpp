@@ -0,0 +1,75 @@
+#include "tracing.h"
+
+#include <algorithm>
+#include <iomanip>
+
+Tracer &Tracer::Instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::Start() {
+    {
+        std::lock_guard guard(mutex_);
+        for (const auto &thread_buffer: thread_buffers_) {
+            thread_buffer->event_count.store(0, std::memory_order_relaxed);
+        }
+    }
+    is_enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Stop() {
+    is_enabled_.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::RecordEvent(const char *name, Clock::time_point start_time, Clock::time_point end_time) {
+    ThreadBuffer &thread_buffer = ForCurrentThread();
+    const uint64_t event_count = thread_buffer.event_count.load(std::memory_order_relaxed);
+    Event &event = thread_buffer.events[event_count % BUFFER_CAPACITY];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start_time - start_time_).count(),
+                         std::memory_order_relaxed);
+    event.duration_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count(),
+                            std::memory_order_relaxed);
+    thread_buffer.event_count.store(event_count + 1, std::memory_order_release);
+}
+
+void Tracer::WriteChromeTrace(std::ostream &output) const {
+    const auto flags = output.flags();
+    const auto precision = output.precision();
+    output << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool is_first = true;
+    std::lock_guard guard(mutex_);
+    for (const auto &thread_buffer: thread_buffers_) {
+        output << (is_first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+               << thread_buffer->thread_id << ",\"args\":{\"name\":\"worker " << thread_buffer->thread_id << "\"}}";
+        is_first = false;
+        const uint64_t event_count = thread_buffer->event_count.load(std::memory_order_acquire);
+        const uint64_t first_event = event_count - std::min<uint64_t>(event_count, BUFFER_CAPACITY);
+        for (uint64_t i = first_event; i < event_count; ++i) {
+            const Event &event = thread_buffer->events[i % BUFFER_CAPACITY];
+            const char *name = event.name.load(std::memory_order_relaxed);
+            if (name == nullptr) {
+                continue;
+            }
+            output << ",{\"name\":\"" << name << "\",\"cat\":\"search_server\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                   << thread_buffer->thread_id
+                   << ",\"ts\":" << static_cast<double>(event.start_ns.load(std::memory_order_relaxed)) / 1000.0
+                   << ",\"dur\":" << static_cast<double>(event.duration_ns.load(std::memory_order_relaxed)) / 1000.0
+                   << '}';
+        }
+    }
+    output << "]}\n";
+    output.flags(flags);
+    output.precision(precision);
+}
+
+Tracer::ThreadBuffer &Tracer::ForCurrentThread() {
+    thread_local ThreadBuffer *thread_buffer = [this] {
+        std::lock_guard guard(mutex_);
+        auto &buffer = thread_buffers_.emplace_back(std::make_unique<ThreadBuffer>());
+        buffer->thread_id = static_cast<int>(thread_buffers_.size());
+        return buffer.get();
+    }();
+    return *thread_buffer;
+}
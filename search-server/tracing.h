@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "log_duration.h"
+
+// Запись интервалов работы потоков для просмотра в chrome://tracing или Perfetto. У каждого потока
+// своё кольцо из BUFFER_CAPACITY событий, которое пишет только он сам; переполненное кольцо затирает
+// самые старые события. Пока трассировка не запущена, замер стоит одной проверки флага
+class Tracer {
+public:
+    using Clock = LogDuration::Clock;
+
+    static constexpr size_t BUFFER_CAPACITY = 1 << 14;
+
+    static Tracer &Instance();
+
+    // Очищает кольца и начинает запись
+    void Start();
+
+    void Stop();
+
+    bool IsEnabled() const {
+        return is_enabled_.load(std::memory_order_relaxed);
+    }
+
+    // name должен жить до выгрузки, обычно это строковый литерал
+    void RecordEvent(const char *name, Clock::time_point start_time, Clock::time_point end_time);
+
+    // Формат Chrome trace event: события "X" с длительностью и имена потоков. Выгружать лучше после Stop:
+    // событие, которое записывается в момент выгрузки, может прочитаться испорченным
+    void WriteChromeTrace(std::ostream &output) const;
+
+private:
+    struct Event {
+        std::atomic<const char *> name{nullptr};
+        std::atomic<int64_t> start_ns{0};
+        std::atomic<int64_t> duration_ns{0};
+    };
+
+    struct ThreadBuffer {
+        int thread_id = 0;
+        std::atomic<uint64_t> event_count{0};
+        std::array<Event, BUFFER_CAPACITY> events;
+    };
+
+    Tracer() = default;
+
+    ThreadBuffer &ForCurrentThread();
+
+    const Clock::time_point start_time_ = Clock::now();
+    std::atomic<bool> is_enabled_{false};
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers_;
+};
+
+// Записывает интервал от создания до разрушения, если трассировка была запущена к моменту создания
+class TraceScope {
+public:
+    explicit TraceScope(const char *name)
+            : name_(Tracer::Instance().IsEnabled() ? name : nullptr) {
+        if (name_ != nullptr) {
+            start_time_ = Tracer::Clock::now();
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    ~TraceScope() {
+        if (name_ != nullptr) {
+            Tracer::Instance().RecordEvent(name_, start_time_, Tracer::Clock::now());
+        }
+    }
+
+private:
+    const char *const name_;
+    Tracer::Clock::time_point start_time_;
+};
+
+// Без SEARCH_SERVER_TRACING замеры не компилируются
+#ifdef SEARCH_SERVER_TRACING
+#define TRACE_SCOPE(name) TraceScope PROFILE_CONCAT(trace_scope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#endif